@@ -1,35 +1,219 @@
-#include "structures.h"
-
-
-
-// RTF library interface
-int rtf_open(char* filename, char* fonts, char* colors);				// Creates new RTF document
-int rtf_close();														// Closes created RTF document
-bool rtf_write_header();												// Writes RTF document header
-void rtf_init();														// Sets global RTF library params
-void rtf_set_fonttable(char* fonts);									// Sets new RTF document font table
-void rtf_set_colortable(char* colors);									// Sets new RTF document color table
-RTF_DOCUMENT_FORMAT* rtf_get_documentformat();							// Gets RTF document formatting properties
-void rtf_set_documentformat(RTF_DOCUMENT_FORMAT* df);					// Sets RTF document formatting properties
-bool rtf_write_documentformat();										// Writes RTF document formatting properties
-RTF_SECTION_FORMAT* rtf_get_sectionformat();							// Gets RTF section formatting properties
-void rtf_set_sectionformat(RTF_SECTION_FORMAT* sf);						// Sets RTF section formatting properties
-bool rtf_write_sectionformat();											// Writes RTF section formatting properties
-int rtf_start_section();												// Starts new RTF section
-RTF_PARAGRAPH_FORMAT* rtf_get_paragraphformat();						// Gets RTF paragraph formatting properties
-void rtf_set_paragraphformat(RTF_PARAGRAPH_FORMAT* pf);					// Sets RTF paragraph formatting properties
-bool rtf_write_paragraphformat();										// Writes RTF paragraph formatting properties
-int rtf_start_paragraph(char* text, bool newPar);						// Starts new RTF paragraph
-int rtf_load_image(char* image, int width, int height);					// Loads image from file
-char* rtf_bin_hex_convert(unsigned char* binary, int size);				// Converts binary data to hex
-void rtf_set_defaultformat();											// Sets default RTF document formatting
-int rtf_start_tablerow();												// Starts new RTF table row
-int rtf_end_tablerow();													// Ends RTF table row
-int rtf_start_tablecell(int rightMargin);								// Starts new RTF table cell
-int rtf_end_tablecell();												// Ends RTF table cell
-RTF_TABLEROW_FORMAT* rtf_get_tablerowformat();							// Gets RTF table row formatting properties
-void rtf_set_tablerowformat(RTF_TABLEROW_FORMAT* rf);					// Sets RTF table row formatting properties
-RTF_TABLECELL_FORMAT* rtf_get_tablecellformat();						// Gets RTF table cell formatting properties
-void rtf_set_tablecellformat(RTF_TABLECELL_FORMAT* cf);					// Sets RTF table cell formatting properties
-char* rtf_get_bordername(int border_type);								// Gets border name
-char* rtf_get_shadingname(int shading_type, bool cell);					// Gets shading name
+#include "structures.h"
+
+
+
+// RTF library interface
+int rtf_open(char* filename, char* fonts, char* colors);				// Creates new RTF document
+int rtf_open_append(char* filename, char* fonts, char* colors);			// Opens existing RTF document for appending
+int rtf_open_deferred(char* filename, char* fonts, char* colors);		// Creates new RTF document with deferred header
+int rtf_close();														// Closes created RTF document
+bool rtf_write_header();												// Writes RTF document header
+void rtf_init();														// Sets global RTF library params
+void rtf_set_fonttable(char* fonts);									// Sets new RTF document font table
+void rtf_set_colortable(char* colors);									// Sets new RTF document color table
+int rtf_add_font(char* name, int family, int charset);					// Adds font to RTF document font table
+int rtf_add_color(int red, int green, int blue);						// Adds color to RTF document color table
+bool rtf_append_colortable(const char* text);							// Appends text to RTF document color table
+int rtf_add_list(RTF_NUMS_FORMAT* nums);								// Adds list to RTF document list table (it can be added before RTF document is opened)
+bool rtf_write_listtable();												// Writes RTF document list and list override tables
+void rtf_set_colorquantization(int palette_size);						// Sets RTF document color quantization (0 disables it, 1-7 is rounded up to 8 colors)
+int rtf_register_table(char* table, RTF_HASH_TABLE* hash, bool fonts);	// Registers font or color table entries
+bool rtf_read_table(char* header, char* name, char* table, int size);	// Reads font or color table from RTF document header
+RTF_DOCUMENT_FORMAT* rtf_get_documentformat();							// Gets RTF document formatting properties
+void rtf_set_documentformat(RTF_DOCUMENT_FORMAT* df);					// Sets RTF document formatting properties
+bool rtf_write_documentformat();										// Writes RTF document formatting properties
+RTF_SECTION_FORMAT* rtf_get_sectionformat();							// Gets RTF section formatting properties
+void rtf_set_sectionformat(RTF_SECTION_FORMAT* sf);						// Sets RTF section formatting properties
+bool rtf_write_sectionformat();											// Writes RTF section formatting properties
+int rtf_start_section();												// Starts new RTF section
+RTF_PARAGRAPH_FORMAT* rtf_get_paragraphformat();						// Gets RTF paragraph formatting properties
+void rtf_set_paragraphformat(RTF_PARAGRAPH_FORMAT* pf);					// Sets RTF paragraph formatting properties
+bool rtf_write_paragraphformat();										// Writes RTF paragraph formatting properties
+int rtf_start_paragraph(char* text, bool newPar);						// Starts new RTF paragraph
+int rtf_start_paragraph_n(const char* text, size_t size, bool newPar);	// Starts new RTF paragraph with escaped text of given length
+int rtf_begin_text(bool newPar);										// Starts new RTF paragraph with text appended in chunks
+int rtf_append_text(const char* text, size_t size);						// Appends text chunk to RTF paragraph
+int rtf_end_text();														// Ends RTF paragraph text appended in chunks
+int rtf_write_text(const char* text, size_t size);						// Writes escaped text to current RTF paragraph
+int rtf_write_paragraphs(const char* const* texts, const size_t* lens, size_t count);	// Writes RTF paragraphs sharing current paragraph formatting
+int rtf_write_list(const char* const* items, const size_t* lens, size_t count, int level);	// Writes RTF list items at list level 1-9 (bulleted or numbered by current format)
+int rtf_begin_paragraph(bool newPar);									// Starts new RTF paragraph with text written in runs
+int rtf_write_run(RTF_CHARACTER_FORMAT* cf, const char* text, size_t size);	// Writes text run with character formatting to RTF paragraph (NULL is paragraph formatting)
+int rtf_end_paragraph();												// Ends RTF paragraph with text written in runs
+bool rtf_diff_characterformat(RTF_CHARACTER_FORMAT* from, RTF_CHARACTER_FORMAT* to, char* words);	// Gets character formatting changes
+int rtf_reserve_toc(size_t size);										// Reserves RTF table of contents region at current position (size is ignored with deferred header)
+int rtf_start_heading(const char* text, size_t size, int level);		// Starts new RTF heading paragraph listed in table of contents
+size_t rtf_toc_copy(char* dest);										// Copies RTF table of contents (NULL destination gets its size)
+void rtf_toc_placeholder(char* dest, size_t size);						// Writes ignored placeholder group of given size
+int rtf_fill_toc();														// Fills reserved RTF table of contents region in place
+int rtf_load_image(char* image, int width, int height);					// Loads image from file
+bool rtf_write_hex(const unsigned char* binary, size_t size);			// Writes binary data as hex to RTF document
+char* rtf_bin_hex_convert(unsigned char* binary, int size);				// Converts binary data to hex (valid until RTF document is closed, NULL if memory budget refuses it)
+void rtf_set_defaultformat();											// Sets default RTF document formatting
+int rtf_start_tablerow();												// Starts new RTF table row
+int rtf_end_tablerow();													// Ends RTF table row
+int rtf_start_tablecell(int rightMargin);								// Starts new RTF table cell
+int rtf_end_tablecell();												// Ends RTF table cell
+RTF_TABLEROW_FORMAT* rtf_get_tablerowformat();							// Gets RTF table row formatting properties
+void rtf_set_tablerowformat(RTF_TABLEROW_FORMAT* rf);					// Sets RTF table row formatting properties
+RTF_TABLECELL_FORMAT* rtf_get_tablecellformat();						// Gets RTF table cell formatting properties
+void rtf_set_tablecellformat(RTF_TABLECELL_FORMAT* cf);					// Sets RTF table cell formatting properties
+const char* rtf_get_bordername(int border_type);						// Gets border name
+const char* rtf_get_shadingname(int shading_type, bool cell);			// Gets shading name
+const char* rtf_get_underlinename(int underline_type);					// Gets underline name
+bool rtf_write_data(const char* data, size_t size);						// Writes raw data to RTF document
+bool rtf_spool_data(const char* data, size_t size);						// Writes data to RTF document body spool
+int rtf_write_deferred();												// Writes deferred RTF document header and spooled body
+int rtf_set_textfile(char* filename, bool append);						// Sets plain text file written with RTF document
+int rtf_close_textfile();												// Closes plain text file written with RTF document
+int rtf_set_analysisfile(char* filename);								// Sets output size analysis report written with RTF document
+int rtf_close_analysisfile();											// Writes output size analysis report of RTF document
+int rtf_set_indexfile(char* filename);									// Sets section index file written with next RTF document
+void rtf_index_count(const char* data, size_t size);					// Counts RTF document bytes written
+void rtf_index_add(int type, ULONGLONG breakStart);						// Adds section index entry at current RTF document offset
+RTF_INDEX_ENTRY* rtf_index_grow();										// Gets next free section index entry (NULL if memory budget refuses it, section index is dropped)
+int rtf_close_indexfile();												// Writes and frees section index
+void rtf_free_index();													// Frees section index
+RTF_INDEX_ENTRY* rtf_read_index(char* indexname, RTF_INDEX_HEADER* header);	// Reads section index file
+int rtf_copy_sections(char* filename, char* indexname, int first, int last, char* outname);	// Copies RTF document sections as new RTF document
+int rtf_set_previous(char* filename, char* indexname);					// Sets previous RTF document for incremental regeneration
+void rtf_free_previous();												// Frees previous RTF document
+int rtf_start_keyed_section(char* key, unsigned int hash, bool* copied);	// Starts new RTF section with content key and hash
+bool rtf_previous_tables();												// Checks if previous RTF document uses same font and color numbers
+bool rtf_copy_previous(int section);									// Copies section content of previous RTF document
+int rtf_checkpoint(char* filename);										// Writes RTF writer checkpoint
+int rtf_resume(char* filename);											// Resumes RTF document from writer checkpoint
+bool rtf_file_seek(FILE* file, ULONGLONG offset);						// Sets file position (buffered data is flushed)
+ULONGLONG rtf_file_tell(FILE* file);									// Gets position of written file
+ULONGLONG rtf_file_size(FILE* file);									// Gets file size (buffered writes are not counted)
+bool rtf_file_truncate(FILE* file, ULONGLONG size);						// Truncates file and sets position to its end
+void rtf_get_stats(RTF_STATS* stats, bool process);						// Gets RTF document or process-wide writer statistics
+void rtf_reset_stats();													// Resets RTF document and process-wide writer statistics
+char* rtf_get_statsname(int call);										// Gets statistics entry point name
+void rtf_stats_call(int call, LARGE_INTEGER* start);					// Counts entry point call and time
+void rtf_stats_add(RTF_STATS* stats, RTF_STATS* add);					// Adds statistics counters
+int rtf_set_tracefile(char* filename);									// Sets trace file and enables tracing (NULL disables it)
+int rtf_write_trace(char* filename);									// Writes recorded trace events as Chrome trace JSON
+void rtf_trace_event(const char* name, LONGLONG start, LONGLONG end, int value);	// Records trace event of calling thread
+void rtf_trace_end(const char* name, LARGE_INTEGER* start, int value);	// Records trace event ending now
+RTF_TRACE_BUFFER* rtf_trace_buffer();									// Gets trace buffer of calling thread
+void rtf_trace_release();												// Releases trace buffer of finished worker thread
+void rtf_trace_section();												// Traces RTF section start
+void rtf_trace_tablerow(bool end);										// Traces RTF table row start or end
+void rtf_trace_endspans(bool sections);									// Ends traced RTF table and section
+void rtf_set_spoollimit(size_t size);									// Sets RTF document body memory spool limit
+void rtf_set_memorybudget(size_t budget);							// Sets writer memory budget (0 is unlimited) and resets high-water marks
+void rtf_get_memoryusage(RTF_MEMORY_USAGE* usage);						// Gets writer memory usage and high-water marks
+char* rtf_get_memoryname(int subsystem);								// Gets memory budget subsystem name
+bool rtf_memory_reserve(int subsystem, size_t size, bool required);		// Charges memory to budget (memory over budget is refused, refused required memory fails RTF document)
+void rtf_memory_release(int subsystem, size_t size);					// Returns memory to budget
+unsigned int rtf_hash(const void* data, size_t size);					// Gets data hash value
+int rtf_hash_find(RTF_HASH_TABLE* hash, char* key);						// Finds hash table entry value
+bool rtf_hash_insert(RTF_HASH_TABLE* hash, char* key, int value);		// Inserts hash table entry
+void rtf_hash_clear(RTF_HASH_TABLE* hash);								// Clears hash table
+void* rtf_arena_alloc(RTF_ARENA* arena, size_t size);					// Allocates memory from arena (NULL if memory budget refuses new block)
+void rtf_arena_mark(RTF_ARENA* arena, RTF_ARENA_MARK* mark);			// Marks arena position
+void rtf_arena_release(RTF_ARENA* arena, RTF_ARENA_MARK* mark);			// Releases arena memory allocated after mark
+void rtf_arena_reset(RTF_ARENA* arena);									// Releases all arena memory (blocks are reused)
+bool rtf_escape_plain(unsigned char c);									// Checks if text character needs no escaping
+int rtf_escape_char(unsigned char c, int field_type, char* dest);		// Escapes single text character
+size_t rtf_escape_size(const char* text, size_t size, int field_type);	// Gets escaped text size
+size_t rtf_escape_copy(char* dest, const char* text, size_t size, int field_type);	// Copies escaped text
+bool rtf_write_escaped(const char* text, size_t size, int field_type);	// Writes escaped text to RTF document
+
+
+
+// RTF template interface
+int rtf_template_open(char* fonts, char* colors);						// Starts recording new RTF template
+int rtf_template_field(char* name, int field_type);						// Inserts named field into RTF template
+RTF_TEMPLATE* rtf_template_close();										// Ends recording of RTF template
+bool rtf_template_append(const char* data, size_t size);				// Appends constant data to RTF template
+int rtf_template_findfield(RTF_TEMPLATE* tmpl, char* name);				// Gets RTF template field index
+char* rtf_template_render_buffer(RTF_TEMPLATE* tmpl, char** values, size_t* size);	// Renders RTF template instance to memory
+int rtf_template_render(RTF_TEMPLATE* tmpl, char** values, char* filename);	// Renders RTF template instance to file
+int rtf_template_export(RTF_TEMPLATE* tmpl, char* name, char* filename);	// Exports RTF template as specialized C++ header
+void rtf_template_free(RTF_TEMPLATE* tmpl);								// Frees RTF template
+
+
+
+// RTF reader interface
+void rtf_reader_init(RTF_READER* reader, RTF_READER_CALLBACK callback, void* param);	// Initializes RTF reader
+size_t rtf_reader_scan(const char* data, size_t size);					// Finds next RTF special character
+size_t rtf_reader_parse(RTF_READER* reader, const char* data, size_t size, bool last);	// Parses RTF data and reports events
+int rtf_read_file(char* filename, RTF_READER_CALLBACK callback, void* param);	// Reads RTF file and reports events
+bool rtf_reader_headerevent(RTF_READER_EVENT* event, void* param);		// Reports RTF document header events
+size_t rtf_reader_header(const char* data, size_t size);				// Gets RTF document header size
+int rtf_reader_depth(const char* data, size_t size, size_t available, bool escaped, bool* binary);	// Gets RTF group depth change
+size_t rtf_reader_split(const char* data, size_t size, int depth, bool escaped);	// Finds RTF split point at top-level group boundary
+bool rtf_reader_buffer(RTF_READER_EVENT* event, void* param);			// Buffers RTF chunk event
+DWORD WINAPI rtf_reader_prescan(LPVOID param);							// Gets RTF chunk group depth change on worker thread
+DWORD WINAPI rtf_reader_worker(LPVOID param);							// Parses RTF chunk on worker thread
+void rtf_reader_run(LPTHREAD_START_ROUTINE job, RTF_READER_CHUNK* chunks, int count);	// Runs RTF chunk jobs on worker threads
+bool rtf_reader_escaped(const char* data, size_t position);				// Checks if RTF character is escaped by preceding backslashes
+int rtf_read_file_parallel(char* filename, RTF_READER_CALLBACK callback, void* param, int threads);	// Reads RTF file on multiple threads
+
+
+
+// RTF text extractor interface
+void rtf_extract_init(RTF_EXTRACTOR* extractor, FILE* file);			// Initializes RTF text extractor
+bool rtf_extract_event(RTF_READER_EVENT* event, void* param);			// Extracts plain text from RTF reader event
+bool rtf_extract_data(RTF_EXTRACTOR* extractor, const char* data, size_t size, bool last);	// Extracts plain text from streamed RTF data
+void rtf_extract_write(RTF_EXTRACTOR* extractor, const char* text, size_t size);	// Writes plain text
+void rtf_extract_char(RTF_EXTRACTOR* extractor, unsigned int code);		// Writes Unicode character as UTF-8
+bool rtf_extract_flush(RTF_EXTRACTOR* extractor);						// Flushes plain text buffer
+void rtf_extract_free(RTF_EXTRACTOR* extractor);						// Frees RTF text extractor
+int rtf_extract_text(char* filename, char* textname);					// Extracts plain text from RTF file
+
+
+
+// RTF minifier interface
+void rtf_minify_init(RTF_MINIFIER* minifier, FILE* file, bool binaryPictures);	// Initializes RTF minifier
+bool rtf_minify_event(RTF_READER_EVENT* event, void* param);			// Minifies RTF reader event
+int rtf_minify_lookup(RTF_READER_EVENT* event);							// Finds formatting control word
+void rtf_minify_begin(RTF_MINIFIER* minifier);							// Starts pending formatting control words
+bool rtf_minify_extra(RTF_MINIFIER* minifier, RTF_READER_EVENT* event);	// Adds other paragraph control word to pending formatting
+void rtf_minify_flush(RTF_MINIFIER* minifier);							// Writes pending formatting control words
+bool rtf_minify_part(RTF_MINIFIER* minifier, RTF_MINIFY_STATE* from, RTF_MINIFY_STATE* to, bool paragraph, char* words);	// Gets shortest paragraph or character formatting change
+bool rtf_minify_diff(RTF_MINIFY_STATE* from, RTF_MINIFY_STATE* to, int first, int last, char* words);	// Gets formatting property changes
+bool rtf_minify_property(int property, int value, char* words);			// Gets formatting property control word
+void rtf_minify_token(RTF_MINIFIER* minifier, RTF_READER_EVENT* event);	// Writes RTF reader event unchanged
+void rtf_minify_text(RTF_MINIFIER* minifier, const char* text, size_t size);	// Writes RTF text
+void rtf_minify_picture(RTF_MINIFIER* minifier);						// Writes buffered picture data
+void rtf_minify_write(RTF_MINIFIER* minifier, const char* data, size_t size);	// Writes minified RTF data
+bool rtf_minify_close(RTF_MINIFIER* minifier);							// Flushes and frees RTF minifier
+int rtf_minify(char* filename, char* outname, bool binaryPictures);		// Minifies RTF file
+
+
+
+// RTF output size analyzer interface
+void rtf_analyze_init(RTF_ANALYZER* analyzer);							// Initializes RTF output size analyzer
+bool rtf_analyze_event(RTF_READER_EVENT* event, void* param);			// Attributes RTF output bytes to control word families
+bool rtf_analyze_destination(RTF_READER_EVENT* event);					// Checks if control word starts destination group
+void rtf_analyze_name(RTF_READER_EVENT* event, int index, char* name);	// Gets control word family name
+int rtf_analyze_family(RTF_ANALYZER* analyzer, char* name);				// Finds or adds control word family
+void rtf_analyze_count(RTF_ANALYZER* analyzer, size_t offset);			// Attributes bytes up to offset to last token
+void rtf_analyze_data(RTF_ANALYZER* analyzer, const char* data, size_t size, bool last);	// Analyzes streamed RTF data
+int rtf_analyze_compare(const void* a, const void* b);					// Compares control word families by bytes
+bool rtf_analyze_report(RTF_ANALYZER* analyzer, FILE* file);			// Writes output size report ranked by bytes
+void rtf_analyze_free(RTF_ANALYZER* analyzer);							// Frees RTF output size analyzer
+int rtf_analyze_file(char* filename, char* reportname);					// Writes output size report of RTF file (NULL report name writes to standard output)
+
+
+
+// RTF merge interface
+void rtf_merge_init(RTF_MERGER* merger);								// Initializes RTF merge tables
+void rtf_merge_append(RTF_MERGE_BUFFER* buffer, const char* data, size_t size);	// Appends data to RTF merge buffer
+bool rtf_merge_header(RTF_MERGE_DOCUMENT* document);					// Reads RTF document header tables
+void rtf_merge_tables(RTF_MERGER* merger, RTF_MERGE_DOCUMENT* document);	// Registers RTF document tables in merged tables
+void rtf_merge_listkey(char* start, char* end, char* key, const char** names, int* numbers);	// Copies RTF list group to key without line breaks and numbers of named control words
+void rtf_merge_listgroup(RTF_MERGE_BUFFER* buffer, char* key, const char** names, int* numbers);	// Appends RTF list group key with numbers of named control words
+void rtf_merge_lists(RTF_MERGER* merger, RTF_MERGE_DOCUMENT* document);	// Registers RTF document list tables in merged list tables
+bool rtf_merge_event(RTF_READER_EVENT* event, void* param);				// Rewrites RTF reader event of merged document
+void rtf_merge_listtables(RTF_MERGE_DOCUMENT* document);				// Writes merged list tables after header tables of first document
+void rtf_merge_copy(RTF_MERGE_DOCUMENT* document, size_t position);		// Copies RTF document data up to position
+bool rtf_merge_body(RTF_MERGE_DOCUMENT* document);						// Rewrites RTF document with merged font, color and list numbers
+DWORD WINAPI rtf_merge_headerjob(LPVOID param);							// Reads RTF document headers on worker thread
+DWORD WINAPI rtf_merge_bodyjob(LPVOID param);							// Rewrites RTF documents on worker thread
+void rtf_merge_run(LPTHREAD_START_ROUTINE job, RTF_MERGE_DOCUMENT* documents, int count, int threads);	// Runs RTF merge jobs on worker threads
+void rtf_merge_free(RTF_MERGE_DOCUMENT* document);						// Frees RTF merge document data
+int rtf_merge(char** filenames, int count, char* outname, int threads);	// Merges RTF files with unified font, color and list tables
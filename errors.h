@@ -1,10 +1,25 @@
-// RTF library error codes
-#define RTF_OPEN_ERROR				0x0001			// Could not create RTF file
-#define RTF_CLOSE_ERROR				0x0002			// Could not close RTF file
-#define RTF_HEADER_ERROR			0x0003			// Could not write header part to RTF file
-#define RTF_DOCUMENTFORMAT_ERROR	0x0004			// Could not write document formatting properties to RTF file
-#define RTF_SECTIONFORMAT_ERROR		0x0005			// Could not write section formatting properties to RTF file
-#define RTF_PARAGRAPHFORMAT_ERROR	0x0006			// Could not write paragraph formatting properties to RTF file
-#define RTF_IMAGE_ERROR				0x0007			// Could not write image to RTF file
-#define RTF_TABLE_ERROR				0x0008			// Could not write table to RTF file
-#define RTF_SUCCESS					0x1000			// No error
+// RTF library error codes
+#define RTF_OPEN_ERROR				0x0001			// Could not create RTF file
+#define RTF_CLOSE_ERROR				0x0002			// Could not close RTF file
+#define RTF_HEADER_ERROR			0x0003			// Could not write header part to RTF file
+#define RTF_DOCUMENTFORMAT_ERROR	0x0004			// Could not write document formatting properties to RTF file
+#define RTF_SECTIONFORMAT_ERROR		0x0005			// Could not write section formatting properties to RTF file
+#define RTF_PARAGRAPHFORMAT_ERROR	0x0006			// Could not write paragraph formatting properties to RTF file
+#define RTF_IMAGE_ERROR				0x0007			// Could not write image to RTF file
+#define RTF_TABLE_ERROR				0x0008			// Could not write table to RTF file
+#define RTF_TEMPLATE_ERROR			0x0009			// Could not record or render RTF template
+#define RTF_APPEND_ERROR			0x000A			// Could not append to RTF file (not valid RTF document)
+#define RTF_FONTTABLE_ERROR			0x000B			// RTF file font table does not contain all fonts
+#define RTF_COLORTABLE_ERROR		0x000C			// RTF file color table does not contain all colors
+#define RTF_READER_ERROR			0x000D			// Could not read RTF file
+#define RTF_TEXTFILE_ERROR			0x000E			// Could not write plain text file
+#define RTF_MINIFY_ERROR			0x000F			// Could not write minified RTF file
+#define RTF_MERGE_ERROR				0x0010			// Could not merge RTF files (not valid RTF document)
+#define RTF_INDEX_ERROR				0x0011			// Could not write or read section index file
+#define RTF_CHECKPOINT_ERROR		0x0012			// Could not write or resume RTF writer checkpoint
+#define RTF_TRACE_ERROR				0x0013			// Could not write trace file
+#define RTF_ANALYSIS_ERROR			0x0014			// Could not write output size analysis report
+#define RTF_TEXT_ERROR				0x0015			// Could not write text to RTF file
+#define RTF_MEMORY_ERROR			0x0016			// Memory budget refused memory
+#define RTF_TOC_ERROR				0x0017			// Could not reserve or write table of contents
+#define RTF_SUCCESS					0x1000			// No error
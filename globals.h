@@ -1,126 +1,289 @@
-#include <stdio.h>
-#include <stdlib.h>
-#include <string.h>
-#include <windows.h>
-#include <fcntl.h>
-#include <sys/stat.h>
-#include <io.h>
-#include <olectl.h>
-
-
-
-// Paragraph break defs
-#define RTF_PARAGRAPHBREAK_NONE				0
-#define RTF_PARAGRAPHBREAK_PAGE				1
-#define RTF_PARAGRAPHBREAK_COLUMN			2
-#define RTF_PARAGRAPHBREAK_LINE				3
-
-// Paragraph align defs
-#define RTF_PARAGRAPHALIGN_LEFT				0
-#define RTF_PARAGRAPHALIGN_CENTER			1
-#define RTF_PARAGRAPHALIGN_RIGHT			2
-#define RTF_PARAGRAPHALIGN_JUSTIFY			3
-
-// Paragraph tab kind defs
-#define RTF_PARAGRAPHTABKIND_NONE			0
-#define RTF_PARAGRAPHTABKIND_CENTER			1
-#define RTF_PARAGRAPHTABKIND_RIGHT			2
-#define RTF_PARAGRAPHTABKIND_DECIMAL		3
-
-// Paragraph tab lead defs
-#define RTF_PARAGRAPHTABLEAD_NONE			0
-#define RTF_PARAGRAPHTABLEAD_DOT			1
-#define RTF_PARAGRAPHTABLEAD_MDOT			2
-#define RTF_PARAGRAPHTABLEAD_HYPH			3
-#define RTF_PARAGRAPHTABLEAD_UNDERLINE		4
-#define RTF_PARAGRAPHTABLEAD_THICKLINE		5
-#define RTF_PARAGRAPHTABLEAD_EQUAL			6
-
-// Paragraph border kind defs
-#define RTF_PARAGRAPHBORDERKIND_NONE		0
-#define RTF_PARAGRAPHBORDERKIND_TOP			1
-#define RTF_PARAGRAPHBORDERKIND_BOTTOM		2
-#define RTF_PARAGRAPHBORDERKIND_LEFT		3
-#define RTF_PARAGRAPHBORDERKIND_RIGHT		4
-#define RTF_PARAGRAPHBORDERKIND_BOX			5
-
-// Paragraph border type defs
-#define RTF_PARAGRAPHBORDERTYPE_STHICK		0
-#define RTF_PARAGRAPHBORDERTYPE_DTHICK		1
-#define RTF_PARAGRAPHBORDERTYPE_SHADOW		2
-#define RTF_PARAGRAPHBORDERTYPE_DOUBLE		3
-#define RTF_PARAGRAPHBORDERTYPE_DOT			4
-#define RTF_PARAGRAPHBORDERTYPE_DASH		5
-#define RTF_PARAGRAPHBORDERTYPE_HAIRLINE	6
-#define RTF_PARAGRAPHBORDERTYPE_INSET		7
-#define RTF_PARAGRAPHBORDERTYPE_SDASH		8
-#define RTF_PARAGRAPHBORDERTYPE_DOTDASH		9
-#define RTF_PARAGRAPHBORDERTYPE_DOTDOTDASH	10
-#define RTF_PARAGRAPHBORDERTYPE_OUTSET		11
-#define RTF_PARAGRAPHBORDERTYPE_TRIPLE		12
-#define RTF_PARAGRAPHBORDERTYPE_WAVY		13
-#define RTF_PARAGRAPHBORDERTYPE_DWAVY		14
-#define RTF_PARAGRAPHBORDERTYPE_STRIPED		15
-#define RTF_PARAGRAPHBORDERTYPE_EMBOSS		16
-#define RTF_PARAGRAPHBORDERTYPE_ENGRAVE		17
-
-// Paragraph shading type defs
-#define RTF_PARAGRAPHSHADINGTYPE_FILL		0
-#define RTF_PARAGRAPHSHADINGTYPE_HORIZ		1
-#define RTF_PARAGRAPHSHADINGTYPE_VERT		2
-#define RTF_PARAGRAPHSHADINGTYPE_FDIAG		3
-#define RTF_PARAGRAPHSHADINGTYPE_BDIAG		4
-#define RTF_PARAGRAPHSHADINGTYPE_CROSS		5
-#define RTF_PARAGRAPHSHADINGTYPE_CROSSD		6
-#define RTF_PARAGRAPHSHADINGTYPE_DHORIZ		7
-#define RTF_PARAGRAPHSHADINGTYPE_DVERT		8
-#define RTF_PARAGRAPHSHADINGTYPE_DFDIAG		9
-#define RTF_PARAGRAPHSHADINGTYPE_DBDIAG		10
-#define RTF_PARAGRAPHSHADINGTYPE_DCROSS		11
-#define RTF_PARAGRAPHSHADINGTYPE_DCROSSD	12
-
-// Section break defs
-#define RTF_SECTIONBREAK_CONTINUOUS			0
-#define RTF_SECTIONBREAK_COLUMN				1
-#define RTF_SECTIONBREAK_PAGE				2
-#define RTF_SECTIONBREAK_EVENPAGE			3
-#define RTF_SECTIONBREAK_ODDPAGE			4
-
-// Table row text align defs
-#define RTF_ROWTEXTALIGN_LEFT				0
-#define RTF_ROWTEXTALIGN_CENTER				1
-#define RTF_ROWTEXTALIGN_RIGHT				2
-
-// Table cell text vertical align defs
-#define RTF_CELLTEXTALIGN_TOP				0
-#define RTF_CELLTEXTALIGN_CENTER			1
-#define RTF_CELLTEXTALIGN_BOTTOM			2
-
-// Table cell text direction defs
-#define RTF_CELLTEXTDIRECTION_LRTB			0
-#define RTF_CELLTEXTDIRECTION_RLTB			1
-#define RTF_CELLTEXTDIRECTION_LRBT			2
-#define RTF_CELLTEXTDIRECTION_LRTBV			3
-#define RTF_CELLTEXTDIRECTION_RLTBV			4
-
-// Table cell shading type defs
-#define RTF_CELLSHADINGTYPE_FILL			0
-#define RTF_CELLSHADINGTYPE_HORIZ			1
-#define RTF_CELLSHADINGTYPE_VERT			2
-#define RTF_CELLSHADINGTYPE_FDIAG			3
-#define RTF_CELLSHADINGTYPE_BDIAG			4
-#define RTF_CELLSHADINGTYPE_CROSS			5
-#define RTF_CELLSHADINGTYPE_CROSSD			6
-#define RTF_CELLSHADINGTYPE_DHORIZ			7
-#define RTF_CELLSHADINGTYPE_DVERT			8
-#define RTF_CELLSHADINGTYPE_DFDIAG			9
-#define RTF_CELLSHADINGTYPE_DBDIAG			10
-#define RTF_CELLSHADINGTYPE_DCROSS			11
-#define RTF_CELLSHADINGTYPE_DCROSSD			12
-
-// Document view kind defs
-#define RTF_DOCUMENTVIEWKIND_NONE			0
-#define RTF_DOCUMENTVIEWKIND_PAGE			1
-#define RTF_DOCUMENTVIEWKIND_OUTLINE		2
-#define RTF_DOCUMENTVIEWKIND_MASTER			3
-#define RTF_DOCUMENTVIEWKIND_NORMAL			4
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <windows.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <io.h>
+#include <olectl.h>
+
+
+
+// Paragraph break defs
+#define RTF_PARAGRAPHBREAK_NONE				0
+#define RTF_PARAGRAPHBREAK_PAGE				1
+#define RTF_PARAGRAPHBREAK_COLUMN			2
+#define RTF_PARAGRAPHBREAK_LINE				3
+
+// Paragraph align defs
+#define RTF_PARAGRAPHALIGN_LEFT				0
+#define RTF_PARAGRAPHALIGN_CENTER			1
+#define RTF_PARAGRAPHALIGN_RIGHT			2
+#define RTF_PARAGRAPHALIGN_JUSTIFY			3
+
+// Paragraph tab kind defs
+#define RTF_PARAGRAPHTABKIND_NONE			0
+#define RTF_PARAGRAPHTABKIND_CENTER			1
+#define RTF_PARAGRAPHTABKIND_RIGHT			2
+#define RTF_PARAGRAPHTABKIND_DECIMAL		3
+
+// Paragraph tab lead defs
+#define RTF_PARAGRAPHTABLEAD_NONE			0
+#define RTF_PARAGRAPHTABLEAD_DOT			1
+#define RTF_PARAGRAPHTABLEAD_MDOT			2
+#define RTF_PARAGRAPHTABLEAD_HYPH			3
+#define RTF_PARAGRAPHTABLEAD_UNDERLINE		4
+#define RTF_PARAGRAPHTABLEAD_THICKLINE		5
+#define RTF_PARAGRAPHTABLEAD_EQUAL			6
+
+// Paragraph border kind defs
+#define RTF_PARAGRAPHBORDERKIND_NONE		0
+#define RTF_PARAGRAPHBORDERKIND_TOP			1
+#define RTF_PARAGRAPHBORDERKIND_BOTTOM		2
+#define RTF_PARAGRAPHBORDERKIND_LEFT		3
+#define RTF_PARAGRAPHBORDERKIND_RIGHT		4
+#define RTF_PARAGRAPHBORDERKIND_BOX			5
+
+// Paragraph border type defs
+#define RTF_PARAGRAPHBORDERTYPE_STHICK		0
+#define RTF_PARAGRAPHBORDERTYPE_DTHICK		1
+#define RTF_PARAGRAPHBORDERTYPE_SHADOW		2
+#define RTF_PARAGRAPHBORDERTYPE_DOUBLE		3
+#define RTF_PARAGRAPHBORDERTYPE_DOT			4
+#define RTF_PARAGRAPHBORDERTYPE_DASH		5
+#define RTF_PARAGRAPHBORDERTYPE_HAIRLINE	6
+#define RTF_PARAGRAPHBORDERTYPE_INSET		7
+#define RTF_PARAGRAPHBORDERTYPE_SDASH		8
+#define RTF_PARAGRAPHBORDERTYPE_DOTDASH		9
+#define RTF_PARAGRAPHBORDERTYPE_DOTDOTDASH	10
+#define RTF_PARAGRAPHBORDERTYPE_OUTSET		11
+#define RTF_PARAGRAPHBORDERTYPE_TRIPLE		12
+#define RTF_PARAGRAPHBORDERTYPE_WAVY		13
+#define RTF_PARAGRAPHBORDERTYPE_DWAVY		14
+#define RTF_PARAGRAPHBORDERTYPE_STRIPED		15
+#define RTF_PARAGRAPHBORDERTYPE_EMBOSS		16
+#define RTF_PARAGRAPHBORDERTYPE_ENGRAVE		17
+
+// Paragraph shading type defs
+#define RTF_PARAGRAPHSHADINGTYPE_FILL		0
+#define RTF_PARAGRAPHSHADINGTYPE_HORIZ		1
+#define RTF_PARAGRAPHSHADINGTYPE_VERT		2
+#define RTF_PARAGRAPHSHADINGTYPE_FDIAG		3
+#define RTF_PARAGRAPHSHADINGTYPE_BDIAG		4
+#define RTF_PARAGRAPHSHADINGTYPE_CROSS		5
+#define RTF_PARAGRAPHSHADINGTYPE_CROSSD		6
+#define RTF_PARAGRAPHSHADINGTYPE_DHORIZ		7
+#define RTF_PARAGRAPHSHADINGTYPE_DVERT		8
+#define RTF_PARAGRAPHSHADINGTYPE_DFDIAG		9
+#define RTF_PARAGRAPHSHADINGTYPE_DBDIAG		10
+#define RTF_PARAGRAPHSHADINGTYPE_DCROSS		11
+#define RTF_PARAGRAPHSHADINGTYPE_DCROSSD	12
+
+// Section break defs
+#define RTF_SECTIONBREAK_CONTINUOUS			0
+#define RTF_SECTIONBREAK_COLUMN				1
+#define RTF_SECTIONBREAK_PAGE				2
+#define RTF_SECTIONBREAK_EVENPAGE			3
+#define RTF_SECTIONBREAK_ODDPAGE			4
+
+// Table row text align defs
+#define RTF_ROWTEXTALIGN_LEFT				0
+#define RTF_ROWTEXTALIGN_CENTER				1
+#define RTF_ROWTEXTALIGN_RIGHT				2
+
+// Table cell text vertical align defs
+#define RTF_CELLTEXTALIGN_TOP				0
+#define RTF_CELLTEXTALIGN_CENTER			1
+#define RTF_CELLTEXTALIGN_BOTTOM			2
+
+// Table cell text direction defs
+#define RTF_CELLTEXTDIRECTION_LRTB			0
+#define RTF_CELLTEXTDIRECTION_RLTB			1
+#define RTF_CELLTEXTDIRECTION_LRBT			2
+#define RTF_CELLTEXTDIRECTION_LRTBV			3
+#define RTF_CELLTEXTDIRECTION_RLTBV			4
+
+// Table cell shading type defs
+#define RTF_CELLSHADINGTYPE_FILL			0
+#define RTF_CELLSHADINGTYPE_HORIZ			1
+#define RTF_CELLSHADINGTYPE_VERT			2
+#define RTF_CELLSHADINGTYPE_FDIAG			3
+#define RTF_CELLSHADINGTYPE_BDIAG			4
+#define RTF_CELLSHADINGTYPE_CROSS			5
+#define RTF_CELLSHADINGTYPE_CROSSD			6
+#define RTF_CELLSHADINGTYPE_DHORIZ			7
+#define RTF_CELLSHADINGTYPE_DVERT			8
+#define RTF_CELLSHADINGTYPE_DFDIAG			9
+#define RTF_CELLSHADINGTYPE_DBDIAG			10
+#define RTF_CELLSHADINGTYPE_DCROSS			11
+#define RTF_CELLSHADINGTYPE_DCROSSD			12
+
+// Document view kind defs
+#define RTF_DOCUMENTVIEWKIND_NONE			0
+#define RTF_DOCUMENTVIEWKIND_PAGE			1
+#define RTF_DOCUMENTVIEWKIND_OUTLINE		2
+#define RTF_DOCUMENTVIEWKIND_MASTER			3
+#define RTF_DOCUMENTVIEWKIND_NORMAL			4
+
+// Template field type defs
+#define RTF_FIELDTYPE_TEXT					0
+#define RTF_FIELDTYPE_PARAGRAPHS			1
+#define RTF_FIELDTYPE_RAW					2
+
+// Font family defs
+#define RTF_FONTFAMILY_NIL					0
+#define RTF_FONTFAMILY_ROMAN				1
+#define RTF_FONTFAMILY_SWISS				2
+#define RTF_FONTFAMILY_MODERN				3
+#define RTF_FONTFAMILY_SCRIPT				4
+#define RTF_FONTFAMILY_DECOR				5
+#define RTF_FONTFAMILY_TECH					6
+#define RTF_FONTFAMILY_BIDI					7
+
+// Escaped text writer defs
+#define RTF_ESCAPE_BUFFERSIZE				256
+#define RTF_BATCH_BUFFERSIZE				1048576
+
+// Arena defs
+#define RTF_ARENA_BLOCKSIZE					65536
+#define RTF_ARENA_ALIGNMENT					8
+
+// List table defs
+#define RTF_LIST_MAXCOUNT					64
+#define RTF_LIST_LEVELS						9
+#define RTF_LIST_BULLETLEVEL				11
+
+// Table of contents defs
+#define RTF_TOC_LEVELINDENT					360
+
+// Memory budget defs
+#define RTF_MEMORY_SUBSYSTEMS				6
+#define RTF_MEMORY_HEXCHUNK					4096
+
+// Memory budget subsystem defs
+#define RTF_MEMORY_ARENA					0
+#define RTF_MEMORY_SPOOL					1
+#define RTF_MEMORY_TABLES					2
+#define RTF_MEMORY_CACHE					3
+#define RTF_MEMORY_INDEX					4
+#define RTF_MEMORY_IMAGE					5
+
+// Reader event type defs
+#define RTF_READEREVENT_GROUPOPEN			0
+#define RTF_READEREVENT_GROUPCLOSE			1
+#define RTF_READEREVENT_CONTROLWORD			2
+#define RTF_READEREVENT_CONTROLSYMBOL		3
+#define RTF_READEREVENT_TEXT				4
+#define RTF_READEREVENT_HEXCHAR				5
+#define RTF_READEREVENT_BINARY				6
+
+// Parallel reader defs
+#define RTF_READER_CHUNKSIZE				8388608
+#define RTF_READER_MAXTHREADS				64
+
+// Text extractor defs
+#define RTF_EXTRACTOR_BUFFERSIZE			65536
+#define RTF_EXTRACTOR_MAXDEPTH				256
+
+// Minifier defs
+#define RTF_MINIFY_BUFFERSIZE				65536
+#define RTF_MINIFY_EXTRASIZE				256
+#define RTF_MINIFY_PARAGRAPHPROPERTIES		9
+#define RTF_MINIFY_PROPERTIES				30
+
+// Output size analyzer defs
+#define RTF_ANALYZE_BUFFERSIZE				65536
+#define RTF_ANALYZE_NAMESIZE				32
+#define RTF_ANALYZE_UNKNOWN					0x7FFFFFFF
+
+// Merge defs
+#define RTF_MERGE_HEADERSIZE				65536
+#define RTF_MERGE_BATCHSIZE					16
+#define RTF_MERGE_MAXFONTNUMBER				65535
+#define RTF_MERGE_MAXLISTNUMBER				65535
+
+// Merge control word kind defs
+#define RTF_MERGEWORD_FONT					0
+#define RTF_MERGEWORD_COLOR					1
+#define RTF_MERGEWORD_PLAIN					2
+#define RTF_MERGEWORD_LIST					3
+#define RTF_MERGEWORD_STYLE					4
+
+// Section index entry type defs
+#define RTF_INDEXENTRY_SECTION				0
+#define RTF_INDEXENTRY_TABLEROW				1
+
+// Minifier control word value defs
+#define RTF_MINIFYVALUE_PARAMETER			-1
+#define RTF_MINIFYVALUE_TOGGLE				-2
+
+// Minifier property defs
+#define RTF_MINIFYPROPERTY_PLAIN			-3
+#define RTF_MINIFYPROPERTY_PARD				-2
+#define RTF_MINIFYPROPERTY_NONE				-1
+#define RTF_MINIFYPROPERTY_ALIGN			0
+#define RTF_MINIFYPROPERTY_FI				1
+#define RTF_MINIFYPROPERTY_LI				2
+#define RTF_MINIFYPROPERTY_RI				3
+#define RTF_MINIFYPROPERTY_SB				4
+#define RTF_MINIFYPROPERTY_SA				5
+#define RTF_MINIFYPROPERTY_SL				6
+#define RTF_MINIFYPROPERTY_SLMULT			7
+#define RTF_MINIFYPROPERTY_INTBL			8
+#define RTF_MINIFYPROPERTY_FONT				9
+#define RTF_MINIFYPROPERTY_SIZE				10
+#define RTF_MINIFYPROPERTY_COLOR			11
+#define RTF_MINIFYPROPERTY_BACKCOLOR		12
+#define RTF_MINIFYPROPERTY_BOLD				13
+#define RTF_MINIFYPROPERTY_ITALIC			14
+#define RTF_MINIFYPROPERTY_CAPS				15
+#define RTF_MINIFYPROPERTY_SCAPS			16
+#define RTF_MINIFYPROPERTY_STRIKE			17
+#define RTF_MINIFYPROPERTY_STRIKED			18
+#define RTF_MINIFYPROPERTY_OUTLINE			19
+#define RTF_MINIFYPROPERTY_SHADOW			20
+#define RTF_MINIFYPROPERTY_EMBOSS			21
+#define RTF_MINIFYPROPERTY_ENGRAVE			22
+#define RTF_MINIFYPROPERTY_HIDDEN			23
+#define RTF_MINIFYPROPERTY_ANIMTEXT			24
+#define RTF_MINIFYPROPERTY_EXPANDTW			25
+#define RTF_MINIFYPROPERTY_KERNING			26
+#define RTF_MINIFYPROPERTY_CHARSCALEX		27
+#define RTF_MINIFYPROPERTY_UNDERLINE		28
+#define RTF_MINIFYPROPERTY_SCRIPT			29
+
+// Statistics defs
+#define RTF_STATS_CALLS						7
+
+// Statistics entry point defs
+#define RTF_STATSCALL_OPEN					0
+#define RTF_STATSCALL_CLOSE					1
+#define RTF_STATSCALL_SECTION				2
+#define RTF_STATSCALL_PARAGRAPH				3
+#define RTF_STATSCALL_IMAGE					4
+#define RTF_STATSCALL_TABLEROW				5
+#define RTF_STATSCALL_TABLECELL				6
+
+// Statistics counters (define RTF_NO_STATS to compile them out)
+#ifndef RTF_NO_STATS
+#define RTF_STATS_ADD(counter, value)		( rtfStats.counter += (value) )
+#define RTF_STATS_START()					LARGE_INTEGER statsStart; QueryPerformanceCounter(&statsStart)
+#define RTF_STATS_END(call)					rtf_stats_call( call, &statsStart )
+#else
+#define RTF_STATS_ADD(counter, value)		((void)0)
+#define RTF_STATS_START()					((void)0)
+#define RTF_STATS_END(call)					((void)0)
+#endif
+
+// Trace defs
+#define RTF_TRACE_BUFFERSIZE				16384
+#define RTF_TRACE_MAXBUFFERS				256
+
+// Tracing (define RTF_NO_TRACE to compile it out)
+#ifndef RTF_NO_TRACE
+#define RTF_TRACE_START(start)				LARGE_INTEGER start; QueryPerformanceCounter(&start)
+#define RTF_TRACE(call)						( rtfTraceEnabled ? (void)(call) : (void)0 )
+#else
+#define RTF_TRACE_START(start)				((void)0)
+#define RTF_TRACE(call)						((void)0)
+#endif
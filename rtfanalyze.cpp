@@ -0,0 +1,426 @@
+#include "errors.h"
+#include "globals.h"
+#include "rtflib.h"
+
+
+
+// RTF output size analyzer global params
+const char* rtfAnalyzeDestinations[] = {
+	"fonttbl", "colortbl", "stylesheet", "info", "pict", "fldinst", "listtable", "listoverridetable",
+	"generator", "object", "objdata", "themedata", "rsidtbl", NULL };
+const char* rtfAnalyzePrefixes[] = {
+	"clbrdr", "trbrdr", "brdr", "clpad", "trpadd", NULL };
+extern RTF_MINIFY_WORD rtfMinifyWords[];			// Formatting control words (rtfminify.cpp)
+extern RTF_HASH_TABLE rtfMinifyHash;				// Formatting control word index (rtfminify.cpp)
+
+
+
+// Initializes RTF output size analyzer
+void rtf_analyze_init(RTF_ANALYZER* analyzer)
+{
+	// Index formatting control words (shared with minifier)
+	if ( rtfMinifyHash.entryCount == 0 )
+	{
+		for ( int i=0; rtfMinifyWords[i].wordName != NULL; i++ )
+			rtf_hash_insert( &rtfMinifyHash, (char*)rtfMinifyWords[i].wordName, i );
+	}
+
+	rtf_reader_init( &analyzer->analyzerReader, rtf_analyze_event, analyzer );
+	memset( &analyzer->familyHash, 0, sizeof(RTF_HASH_TABLE) );
+	analyzer->analyzeFamilies = NULL;
+	analyzer->familyCount = 0;
+	analyzer->familyCapacity = 0;
+	analyzer->defaultFont = 0;
+	analyzer->groupStart = false;
+	analyzer->ignorableStart = false;
+	analyzer->tokenFamily = -1;
+	analyzer->tokenType = -1;
+	analyzer->tokenRedundant = false;
+	analyzer->tokenOffset = 0;
+	analyzer->totalSize = 0;
+	analyzer->pendingData = NULL;
+	analyzer->pendingSize = 0;
+	analyzer->pendingCapacity = 0;
+
+	// Formatting state of document start is unknown
+	analyzer->stateCapacity = 64;
+	analyzer->groupStates = new RTF_ANALYZE_STATE[analyzer->stateCapacity];
+	for ( int i=0; i<RTF_MINIFY_PROPERTIES; i++ )
+		analyzer->groupStates[0].propertyValues[i] = RTF_ANALYZE_UNKNOWN;
+	analyzer->groupStates[0].dataFamily = -1;
+}
+
+
+// Attributes RTF output bytes to control word families
+bool rtf_analyze_event(RTF_READER_EVENT* event, void* param)
+{
+	RTF_ANALYZER* analyzer = (RTF_ANALYZER*)param;
+	int depth = ( event->groupDepth > 0 ? event->groupDepth : 0 );
+
+	// Text run split at line break or block end continues last token
+	if ( event->eventType == RTF_READEREVENT_TEXT && analyzer->tokenType == RTF_READEREVENT_TEXT && analyzer->tokenFamily >= 0 )
+		return true;
+
+	// Previous token ends at this event (bytes include delimiters and line breaks)
+	rtf_analyze_count( analyzer, event->eventOffset );
+	bool groupStart = analyzer->groupStart;
+	bool ignorableStart = analyzer->ignorableStart;
+	analyzer->groupStart = false;
+	analyzer->ignorableStart = false;
+
+	// Group starts with formatting state of enclosing group
+	if ( event->eventType == RTF_READEREVENT_GROUPOPEN )
+	{
+		if ( depth >= analyzer->stateCapacity )
+		{
+			RTF_ANALYZE_STATE* states = new RTF_ANALYZE_STATE[2*analyzer->stateCapacity];
+			memcpy( states, analyzer->groupStates, analyzer->stateCapacity*sizeof(RTF_ANALYZE_STATE) );
+			delete []analyzer->groupStates;
+			analyzer->groupStates = states;
+			analyzer->stateCapacity *= 2;
+		}
+		if ( depth > 0 )
+			analyzer->groupStates[depth] = analyzer->groupStates[depth-1];
+		analyzer->groupStart = true;
+	}
+	if ( depth >= analyzer->stateCapacity )
+		depth = analyzer->stateCapacity - 1;
+	RTF_ANALYZE_STATE* state = &analyzer->groupStates[depth];
+
+	int family = -1;
+	bool redundant = false;
+	if ( event->eventType == RTF_READEREVENT_GROUPOPEN || event->eventType == RTF_READEREVENT_GROUPCLOSE )
+	{
+		// Group braces
+		family = rtf_analyze_family( analyzer, "{ }" );
+	}
+	else if ( event->eventType == RTF_READEREVENT_CONTROLWORD )
+	{
+		char name[RTF_ANALYZE_NAMESIZE];
+		int index = rtf_minify_lookup( event );
+
+		// Destination group data is counted separately from document text
+		if ( groupStart && index < 0 && ( ignorableStart || rtf_analyze_destination( event ) ) )
+		{
+			size_t size = ( event->eventSize < RTF_ANALYZE_NAMESIZE-7 ? event->eventSize : RTF_ANALYZE_NAMESIZE-7 );
+			name[0] = '\\';
+			memcpy( name+1, event->eventData, size );
+			strcpy( name+1+size, " data" );
+			state->dataFamily = rtf_analyze_family( analyzer, name );
+		}
+		rtf_analyze_name( event, index, name );
+		family = rtf_analyze_family( analyzer, name );
+
+		// Formatting inside destination groups (font table, style sheet) is not document formatting
+		if ( index >= 0 && state->dataFamily < 0 )
+		{
+			RTF_MINIFY_WORD* word = &rtfMinifyWords[index];
+			if ( word->wordProperty == RTF_MINIFYPROPERTY_PARD )
+			{
+				// Reset paragraph formatting
+				for ( int i=0; i<RTF_MINIFY_PARAGRAPHPROPERTIES; i++ )
+					state->propertyValues[i] = 0;
+			}
+			else if ( word->wordProperty == RTF_MINIFYPROPERTY_PLAIN )
+			{
+				// Reset character formatting (colors are automatic)
+				for ( int i=RTF_MINIFY_PARAGRAPHPROPERTIES; i<RTF_MINIFY_PROPERTIES; i++ )
+					state->propertyValues[i] = 0;
+				state->propertyValues[RTF_MINIFYPROPERTY_FONT] = analyzer->defaultFont;
+				state->propertyValues[RTF_MINIFYPROPERTY_SIZE] = 24;
+				state->propertyValues[RTF_MINIFYPROPERTY_COLOR] = -1;
+				state->propertyValues[RTF_MINIFYPROPERTY_BACKCOLOR] = -1;
+				state->propertyValues[RTF_MINIFYPROPERTY_CHARSCALEX] = 100;
+			}
+			else if ( word->wordProperty >= 0 )
+			{
+				// Set formatting property (re-emission of unchanged value is redundant)
+				int value = word->wordValue;
+				if ( value == RTF_MINIFYVALUE_PARAMETER )
+					value = ( event->hasParameter ? event->eventParameter : word->wordDefault );
+				else if ( value == RTF_MINIFYVALUE_TOGGLE )
+					value = ( !event->hasParameter || event->eventParameter != 0 ? 1 : 0 );
+				else if ( event->hasParameter && event->eventParameter == 0 )
+					value = 0;
+				redundant = ( state->propertyValues[word->wordProperty] == value );
+				state->propertyValues[word->wordProperty] = value;
+			}
+		}
+
+		// Default font is used by \plain
+		if ( event->eventSize == 4 && strncmp( event->eventData, "deff", 4 ) == 0 )
+			analyzer->defaultFont = event->eventParameter;
+	}
+	else if ( event->eventType == RTF_READEREVENT_CONTROLSYMBOL && event->eventData[0] == '*' )
+	{
+		// Ignorable destination group is named by next control word
+		family = rtf_analyze_family( analyzer, "\\*" );
+		analyzer->groupStart = groupStart;
+		analyzer->ignorableStart = groupStart;
+	}
+	else if ( state->dataFamily >= 0 )
+	{
+		// Destination group data (picture data, font names)
+		family = state->dataFamily;
+	}
+	else if ( event->eventType == RTF_READEREVENT_BINARY )
+	{
+		// Binary data outside destination groups
+		family = rtf_analyze_family( analyzer, "\\bin data" );
+	}
+	else
+	{
+		// Text, escaped and hexadecimal characters
+		family = rtf_analyze_family( analyzer, "text" );
+	}
+
+	// Token bytes are known at next event
+	analyzer->tokenFamily = family;
+	analyzer->tokenType = event->eventType;
+	analyzer->tokenRedundant = redundant;
+	analyzer->tokenOffset = event->eventOffset;
+
+	return true;
+}
+
+
+// Checks if control word starts destination group
+bool rtf_analyze_destination(RTF_READER_EVENT* event)
+{
+	for ( int i=0; rtfAnalyzeDestinations[i] != NULL; i++ )
+	{
+		if ( strlen( rtfAnalyzeDestinations[i] ) == event->eventSize && strncmp( event->eventData, rtfAnalyzeDestinations[i], event->eventSize ) == 0 )
+			return true;
+	}
+	return false;
+}
+
+
+// Gets control word family name
+void rtf_analyze_name(RTF_READER_EVENT* event, int index, char* name)
+{
+	// Control word name without parameter
+	size_t size = ( event->eventSize < RTF_ANALYZE_NAMESIZE-3 ? event->eventSize : RTF_ANALYZE_NAMESIZE-3 );
+	name[0] = '\\';
+	memcpy( name+1, event->eventData, size );
+	name[1+size] = '\0';
+
+	// Border and padding control words are counted as one family
+	for ( int i=0; rtfAnalyzePrefixes[i] != NULL; i++ )
+	{
+		size_t length = strlen( rtfAnalyzePrefixes[i] );
+		if ( size > length && strncmp( event->eventData, rtfAnalyzePrefixes[i], length ) == 0 )
+		{
+			strcpy( name+1+length, "*" );
+			return;
+		}
+	}
+
+	// Toggle off is counted separately (\b0)
+	if ( index >= 0 && rtfMinifyWords[index].wordValue == RTF_MINIFYVALUE_TOGGLE && event->hasParameter && event->eventParameter == 0 )
+		strcpy( name+1+size, "0" );
+}
+
+
+// Finds or adds control word family
+int rtf_analyze_family(RTF_ANALYZER* analyzer, char* name)
+{
+	int index = rtf_hash_find( &analyzer->familyHash, name );
+	if ( index >= 0 )
+		return index;
+
+	// Add family
+	if ( analyzer->familyCount == analyzer->familyCapacity )
+	{
+		int capacity = ( analyzer->familyCapacity == 0 ? 64 : 2*analyzer->familyCapacity );
+		RTF_ANALYZE_FAMILY* families = new RTF_ANALYZE_FAMILY[capacity];
+		if ( analyzer->familyCount > 0 )
+			memcpy( families, analyzer->analyzeFamilies, analyzer->familyCount*sizeof(RTF_ANALYZE_FAMILY) );
+		delete []analyzer->analyzeFamilies;
+		analyzer->analyzeFamilies = families;
+		analyzer->familyCapacity = capacity;
+	}
+	index = analyzer->familyCount++;
+	RTF_ANALYZE_FAMILY* family = &analyzer->analyzeFamilies[index];
+	memset( family, 0, sizeof(RTF_ANALYZE_FAMILY) );
+	strcpy( family->familyName, name );
+	rtf_hash_insert( &analyzer->familyHash, name, index );
+	return index;
+}
+
+
+// Attributes bytes up to offset to last token
+void rtf_analyze_count(RTF_ANALYZER* analyzer, size_t offset)
+{
+	if ( analyzer->tokenFamily < 0 )
+		return;
+
+	RTF_ANALYZE_FAMILY* family = &analyzer->analyzeFamilies[analyzer->tokenFamily];
+	ULONGLONG size = offset - analyzer->tokenOffset;
+	family->familyBytes += size;
+	family->familyCount++;
+	if ( analyzer->tokenRedundant )
+	{
+		family->redundantBytes += size;
+		family->redundantCount++;
+	}
+	analyzer->tokenFamily = -1;
+}
+
+
+// Analyzes streamed RTF data
+void rtf_analyze_data(RTF_ANALYZER* analyzer, const char* data, size_t size, bool last)
+{
+	analyzer->totalSize += size;
+
+	// Parse data directly if there is no incomplete token
+	if ( analyzer->pendingSize == 0 )
+	{
+		size_t parsed = rtf_reader_parse( &analyzer->analyzerReader, data, size, last );
+		data += parsed;
+		size -= parsed;
+	}
+	else
+	{
+		// Complete pending token with new data
+		if ( analyzer->pendingSize + size > analyzer->pendingCapacity )
+		{
+			size_t capacity = 2*( analyzer->pendingSize + size );
+			char* pending = new char[capacity];
+			memcpy( pending, analyzer->pendingData, analyzer->pendingSize );
+			delete []analyzer->pendingData;
+			analyzer->pendingData = pending;
+			analyzer->pendingCapacity = capacity;
+		}
+		memcpy( analyzer->pendingData + analyzer->pendingSize, data, size );
+		analyzer->pendingSize += size;
+		size_t parsed = rtf_reader_parse( &analyzer->analyzerReader, analyzer->pendingData, analyzer->pendingSize, last );
+		data = analyzer->pendingData + parsed;
+		size = analyzer->pendingSize - parsed;
+	}
+
+	// Keep incomplete token
+	if ( size > analyzer->pendingCapacity )
+	{
+		char* pending = new char[2*size];
+		delete []analyzer->pendingData;
+		analyzer->pendingData = pending;
+		analyzer->pendingCapacity = 2*size;
+	}
+	if ( size > 0 )
+		memmove( analyzer->pendingData, data, size );
+	analyzer->pendingSize = size;
+
+	// Last token ends at data end
+	if ( last )
+		rtf_analyze_count( analyzer, (size_t)analyzer->totalSize );
+}
+
+
+// Compares control word families by bytes
+int rtf_analyze_compare(const void* a, const void* b)
+{
+	const RTF_ANALYZE_FAMILY* first = (const RTF_ANALYZE_FAMILY*)a;
+	const RTF_ANALYZE_FAMILY* second = (const RTF_ANALYZE_FAMILY*)b;
+	if ( first->familyBytes != second->familyBytes )
+		return ( first->familyBytes > second->familyBytes ? -1 : 1 );
+	return strcmp( first->familyName, second->familyName );
+}
+
+
+// Writes output size report ranked by bytes
+bool rtf_analyze_report(RTF_ANALYZER* analyzer, FILE* file)
+{
+	// Rank families by bytes
+	RTF_ANALYZE_FAMILY* families = new RTF_ANALYZE_FAMILY[analyzer->familyCount+1];
+	if ( analyzer->familyCount > 0 )
+		memcpy( families, analyzer->analyzeFamilies, analyzer->familyCount*sizeof(RTF_ANALYZE_FAMILY) );
+	qsort( families, analyzer->familyCount, sizeof(RTF_ANALYZE_FAMILY), rtf_analyze_compare );
+
+	// Redundant formatting totals
+	ULONGLONG redundantBytes = 0;
+	ULONGLONG redundantCount = 0;
+	int i;
+	for ( i=0; i<analyzer->familyCount; i++ )
+	{
+		redundantBytes += families[i].redundantBytes;
+		redundantCount += families[i].redundantCount;
+	}
+
+	// Write report (bytes of each token include its delimiter and following line breaks, counters are printed as doubles)
+	double total = ( analyzer->totalSize > 0 ? (double)(LONGLONG)analyzer->totalSize : 1.0 );
+	fprintf( file, "Total bytes: %.0f\n", (double)(LONGLONG)analyzer->totalSize );
+	fprintf( file, "Redundant bytes: %.0f (%.2f%%) in %.0f re-emissions of unchanged formatting values\n\n",
+		(double)(LONGLONG)redundantBytes, 100.0*(double)(LONGLONG)redundantBytes/total, (double)(LONGLONG)redundantCount );
+	fprintf( file, "%5s  %-24s %12s %14s %8s %10s %14s\n", "rank", "family", "count", "bytes", "share", "redundant", "redundant bytes" );
+	for ( i=0; i<analyzer->familyCount; i++ )
+	{
+		RTF_ANALYZE_FAMILY* family = &families[i];
+		fprintf( file, "%5d  %-24s %12.0f %14.0f %7.2f%% %10.0f %14.0f\n", i+1, family->familyName, (double)(LONGLONG)family->familyCount,
+			(double)(LONGLONG)family->familyBytes, 100.0*(double)(LONGLONG)family->familyBytes/total, (double)(LONGLONG)family->redundantCount,
+			(double)(LONGLONG)family->redundantBytes );
+	}
+	delete []families;
+
+	return !ferror(file);
+}
+
+
+// Frees RTF output size analyzer
+void rtf_analyze_free(RTF_ANALYZER* analyzer)
+{
+	rtf_hash_clear( &analyzer->familyHash );
+	delete []analyzer->familyHash.tableEntries;
+	analyzer->familyHash.tableEntries = NULL;
+	delete []analyzer->analyzeFamilies;
+	analyzer->analyzeFamilies = NULL;
+	delete []analyzer->groupStates;
+	analyzer->groupStates = NULL;
+	delete []analyzer->pendingData;
+	analyzer->pendingData = NULL;
+}
+
+
+// Writes output size report of RTF file (NULL report name writes to standard output)
+int rtf_analyze_file(char* filename, char* reportname)
+{
+	// Set error flag
+	int error = RTF_SUCCESS;
+
+	// Open RTF file
+	FILE* file = fopen( filename, "rb" );
+	if ( file == NULL )
+		return RTF_READER_ERROR;
+
+	// Analyze RTF file in blocks
+	RTF_ANALYZER analyzer;
+	rtf_analyze_init( &analyzer );
+	char* buffer = new char[RTF_ANALYZE_BUFFERSIZE];
+	size_t size;
+	while ( ( size = fread( buffer, 1, RTF_ANALYZE_BUFFERSIZE, file ) ) > 0 )
+		rtf_analyze_data( &analyzer, buffer, size, false );
+	if ( ferror(file) )
+		error = RTF_READER_ERROR;
+	rtf_analyze_data( &analyzer, NULL, 0, true );
+	delete []buffer;
+	fclose(file);
+
+	// Write report
+	if ( error == RTF_SUCCESS )
+	{
+		FILE* report = ( reportname != NULL ? fopen( reportname, "w" ) : stdout );
+		if ( report == NULL )
+			error = RTF_ANALYSIS_ERROR;
+		else
+		{
+			if ( !rtf_analyze_report( &analyzer, report ) )
+				error = RTF_ANALYSIS_ERROR;
+			if ( report != stdout && fclose(report) )
+				error = RTF_ANALYSIS_ERROR;
+		}
+	}
+	rtf_analyze_free( &analyzer );
+
+	// Return error flag
+	return error;
+}
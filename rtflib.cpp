@@ -1,1523 +1,4991 @@
-#include "errors.h"
-#include "globals.h"
-#include "rtflib.h"
-
-
-
-RTF_DOCUMENT_FORMAT rtfDocFormat;					// RTF document formatting params
-RTF_SECTION_FORMAT rtfSecFormat;					// RTF section formatting params
-RTF_PARAGRAPH_FORMAT rtfParFormat;					// RTF paragraph formatting params
-RTF_TABLEROW_FORMAT rtfRowFormat;					// RTF table row formatting params
-RTF_TABLECELL_FORMAT rtfCellFormat;					// RTF table cell formatting params
-
-
-
-// RTF library global params
-FILE* rtfFile = NULL;
-char rtfFontTable[4096] = "";
-char rtfColorTable[4096] = "";
-IPicture* rtfPicture = NULL;
-
-
-
-// Creates new RTF document
-int rtf_open( char* filename, char* fonts, char* colors )
-{
-	// Set error flag
-	int error = RTF_SUCCESS;
-
-	// Initialize global params
-	rtf_init();
-
-	// Set RTF document font table
-	if ( fonts != NULL )
-	{
-		if ( strcmp( fonts, "" ) != 0 )
-			rtf_set_fonttable(fonts);
-	}
-
-	// Set RTF document color table
-	if ( colors != NULL )
-	{
-		if ( strcmp( colors, "" ) != 0 )
-			rtf_set_colortable(colors);
-	}
-
-	// Create RTF document
-	rtfFile = fopen( filename, "w" );
-
-	if ( rtfFile != NULL )
-	{
-		// Write RTF document header
-		if ( !rtf_write_header() )
-			error = RTF_HEADER_ERROR;
-
-		// Write RTF document formatting properties
-		if ( !rtf_write_documentformat() )
-			error = RTF_DOCUMENTFORMAT_ERROR;
-
-		// Create first RTF document section with default formatting
-		rtf_write_sectionformat();
-	}
-	else
-		error = RTF_OPEN_ERROR;
-
-	// Return error flag
-	return error;
-}
-
-
-// Closes created RTF document
-int rtf_close()
-{
-	// Set error flag
-	int error = RTF_SUCCESS;
-
-	// Free IPicture object
-	if ( rtfPicture != NULL )
-	{
-		rtfPicture->Release();
-		rtfPicture = NULL;
-	}
-
-	// Write RTF document end part
-	char rtfText[1024];
-	strcpy( rtfText, "\n\\par}" );
-	fwrite( rtfText, 1, strlen(rtfText), rtfFile );
-
-	// Close RTF document
-	if ( fclose(rtfFile) )
-		error = RTF_CLOSE_ERROR;
-
-	// Return error flag
-	return error;
-}
-
-
-// Writes RTF document header
-bool rtf_write_header()
-{
-	// Set error flag
-	bool result = true;
-
-	// Standard RTF document header
-	char rtfText[1024];
-	strcpy( rtfText, "{\\rtf1\\ansi\\ansicpg1252\\deff0{\\fonttbl" );
-	strcat( rtfText, rtfFontTable );
-	strcat( rtfText, "}{\\colortbl" );
-	strcat( rtfText, rtfColorTable );
-	strcat( rtfText, "}{\\*\\generator rtflib ver. 1.0;}" );
-	strcat( rtfText, "\n{\\info{\\author rtflib ver. 1.0}{\\company ETC Company LTD.}}" );
-
-	// Writes standard RTF document header part
-	if ( fwrite( rtfText, 1, strlen(rtfText), rtfFile ) < strlen(rtfText) )
-		result = false;
-
-	// Return error flag
-	return result;
-}
-
-
-// Sets global RTF library params
-void rtf_init()
-{
-	// Set RTF document default font table
-	strcpy( rtfFontTable, "" );
-	strcat( rtfFontTable, "{\\f0\\froman\\fcharset0\\cpg1252 Times New Roman}" );
-	strcat( rtfFontTable, "{\\f1\\fswiss\\fcharset0\\cpg1252 Arial}" );
-	strcat( rtfFontTable, "{\\f2\\fmodern\\fcharset0\\cpg1252 Courier New}" );
-	strcat( rtfFontTable, "{\\f3\\fscript\\fcharset0\\cpg1252 Cursive}" );
-	strcat( rtfFontTable, "{\\f4\\fdecor\\fcharset0\\cpg1252 Old English}" );
-	strcat( rtfFontTable, "{\\f5\\ftech\\fcharset0\\cpg1252 Symbol}" );
-	strcat( rtfFontTable, "{\\f6\\fbidi\\fcharset0\\cpg1252 Miriam}" );
-
-	// Set RTF document default color table
-	strcpy( rtfColorTable, "" );
-	strcat( rtfColorTable, "\\red0\\green0\\blue0;" );
-	strcat( rtfColorTable, "\\red255\\green0\\blue0;" );
-	strcat( rtfColorTable, "\\red0\\green255\\blue0;" );
-	strcat( rtfColorTable, "\\red0\\green0\\blue255;" );
-	strcat( rtfColorTable, "\\red255\\green255\\blue0;" );
-	strcat( rtfColorTable, "\\red255\\green0\\blue255;" );
-	strcat( rtfColorTable, "\\red0\\green255\\blue255;" );
-	strcat( rtfColorTable, "\\red255\\green255\\blue255;" );
-	strcat( rtfColorTable, "\\red128\\green0\\blue0;" );
-	strcat( rtfColorTable, "\\red0\\green128\\blue0;" );
-	strcat( rtfColorTable, "\\red0\\green0\\blue128;" );
-	strcat( rtfColorTable, "\\red128\\green128\\blue0;" );
-	strcat( rtfColorTable, "\\red128\\green0\\blue128;" );
-	strcat( rtfColorTable, "\\red0\\green128\\blue128;" );
-	strcat( rtfColorTable, "\\red128\\green128\\blue128;" );
-
-	// Set default formatting
-	rtf_set_defaultformat();
-}
-
-
-// Sets default RTF document formatting
-void rtf_set_defaultformat()
-{
-	// Set default RTF document formatting properties
-	RTF_DOCUMENT_FORMAT df = {RTF_DOCUMENTVIEWKIND_PAGE, 100, 12240, 15840, 1800, 1800, 1440, 1440, false, 0, false};
-	rtf_set_documentformat(&df);
-
-	// Set default RTF section formatting properties
-	RTF_SECTION_FORMAT sf = {RTF_SECTIONBREAK_CONTINUOUS, false, true, 12240, 15840, 1800, 1800, 1440, 1440, 0, 720, 720, false, 720, 720, false, 1, 720, false};
-	rtf_set_sectionformat(&sf);
-
-	// Set default RTF paragraph formatting properties
-	RTF_PARAGRAPH_FORMAT pf = {RTF_PARAGRAPHBREAK_NONE, false, true, RTF_PARAGRAPHALIGN_LEFT, 0, 0, 0, 0, 0, 0, "", false, false, false, false, false, false};
-	pf.BORDERS.borderColor = 0;
-	pf.BORDERS.borderKind = RTF_PARAGRAPHBORDERKIND_NONE;
-	pf.BORDERS.borderSpace = 0;
-	pf.BORDERS.borderType = RTF_PARAGRAPHBORDERTYPE_STHICK;
-	pf.BORDERS.borderWidth = 0;
-	pf.CHARACTER.animatedCharacter = false;
-	pf.CHARACTER.backgroundColor = 0;
-	pf.CHARACTER.boldCharacter = false;
-	pf.CHARACTER.capitalCharacter = false;
-	pf.CHARACTER.doublestrikeCharacter = false;
-	pf.CHARACTER.embossCharacter = false;
-	pf.CHARACTER.engraveCharacter = false;
-	pf.CHARACTER.expandCharacter = 0;
-	pf.CHARACTER.fontNumber = 0;
-	pf.CHARACTER.fontSize = 24;
-	pf.CHARACTER.foregroundColor = 0;
-	pf.CHARACTER.italicCharacter = false;
-	pf.CHARACTER.kerningCharacter = 0;
-	pf.CHARACTER.outlineCharacter = false;
-	pf.CHARACTER.scaleCharacter = 100;
-	pf.CHARACTER.shadowCharacter = false;
-	pf.CHARACTER.smallcapitalCharacter = false;
-	pf.CHARACTER.strikeCharacter = false;
-	pf.CHARACTER.subscriptCharacter = false;
-	pf.CHARACTER.superscriptCharacter = false;
-	pf.CHARACTER.underlineCharacter = 0;
-	pf.NUMS.numsChar = char(0x95);
-	pf.NUMS.numsLevel = 11;
-	pf.NUMS.numsSpace = 360;
-	pf.SHADING.shadingBkColor = 0;
-	pf.SHADING.shadingFillColor = 0;
-	pf.SHADING.shadingIntensity = 0;
-	pf.SHADING.shadingType = RTF_PARAGRAPHSHADINGTYPE_FILL;
-	pf.TABS.tabKind = RTF_PARAGRAPHTABKIND_NONE;
-	pf.TABS.tabLead = RTF_PARAGRAPHTABLEAD_NONE;
-	pf.TABS.tabPosition = 0;
-	rtf_set_paragraphformat(&pf);
-
-	// Set default RTF table row formatting properties
-	RTF_TABLEROW_FORMAT rf = {RTF_ROWTEXTALIGN_LEFT, 0, 0, 0, 0, 0, 0};
-	rtf_set_tablerowformat(&rf);
-
-	// Set default RTF table cell formatting properties
-	RTF_TABLECELL_FORMAT cf = {RTF_CELLTEXTALIGN_CENTER, 0, 0, 0, 0, RTF_CELLTEXTDIRECTION_LRTB, false};
-	cf.SHADING.shadingBkColor = 0;
-	cf.SHADING.shadingFillColor = 0;
-	cf.SHADING.shadingIntensity = 0;
-	cf.SHADING.shadingType = RTF_PARAGRAPHSHADINGTYPE_FILL;
-	cf.borderBottom.border = false;
-	cf.borderBottom.BORDERS.borderColor = 0;
-	cf.borderBottom.BORDERS.borderKind = RTF_PARAGRAPHBORDERKIND_NONE;
-	cf.borderBottom.BORDERS.borderSpace = 0;
-	cf.borderBottom.BORDERS.borderType = RTF_PARAGRAPHBORDERTYPE_STHICK;
-	cf.borderBottom.BORDERS.borderWidth = 5;
-	cf.borderLeft.border = false;
-	cf.borderLeft.BORDERS.borderColor = 0;
-	cf.borderLeft.BORDERS.borderKind = RTF_PARAGRAPHBORDERKIND_NONE;
-	cf.borderLeft.BORDERS.borderSpace = 0;
-	cf.borderLeft.BORDERS.borderType = RTF_PARAGRAPHBORDERTYPE_STHICK;
-	cf.borderLeft.BORDERS.borderWidth = 5;
-	cf.borderRight.border = false;
-	cf.borderRight.BORDERS.borderColor = 0;
-	cf.borderRight.BORDERS.borderKind = RTF_PARAGRAPHBORDERKIND_NONE;
-	cf.borderRight.BORDERS.borderSpace = 0;
-	cf.borderRight.BORDERS.borderType = RTF_PARAGRAPHBORDERTYPE_STHICK;
-	cf.borderRight.BORDERS.borderWidth = 5;
-	cf.borderTop.border = false;
-	cf.borderTop.BORDERS.borderColor = 0;
-	cf.borderTop.BORDERS.borderKind = RTF_PARAGRAPHBORDERKIND_NONE;
-	cf.borderTop.BORDERS.borderSpace = 0;
-	cf.borderTop.BORDERS.borderType = RTF_PARAGRAPHBORDERTYPE_STHICK;
-	cf.borderTop.BORDERS.borderWidth = 5;
-	rtf_set_tablecellformat(&cf);
-}
-
-
-// Sets new RTF document font table
-void rtf_set_fonttable( char* fonts )
-{
-	// Clear old font table
-	strcpy( rtfFontTable, "" );
-
-	// Set separator list
-	char separator[] = ";";
-
-	// Create new RTF document font table
-	int font_number = 0;
-	char font_table_entry[1024];
-	char* token = strtok( fonts, separator );
- 	while ( token != NULL )
-	{
-		// Format font table entry
-		sprintf( font_table_entry, "{\\f%d\\fnil\\fcharset0\\cpg1252 %s}", font_number, token );
-		strcat( rtfFontTable, font_table_entry );
-
-		// Get next font
-		token = strtok( NULL, separator );
-		font_number++;
-	}
-}
-
-
-// Sets new RTF document color table
-void rtf_set_colortable(char* colors)
-{
-	// Clear old color table
-	strcpy( rtfColorTable, "" );
-
-	// Set separator list
-	char separator[] = ";";
-
-	// Create new RTF document color table
-	int color_number = 0;
-	char color_table_entry[1024];
-	char* token = strtok( colors, separator );
- 	while ( token != NULL )
-	{
-		// Red
-		sprintf( color_table_entry, "\\red%s", token );
-		strcat( rtfColorTable, color_table_entry );
-
-		// Green
-		token = strtok( NULL, separator );
-		if ( token != NULL )
-		{
-			sprintf( color_table_entry, "\\green%s", token );
-			strcat( rtfColorTable, color_table_entry );
-		}
-
-		// Blue
-		token = strtok( NULL, separator );
-		if ( token != NULL )
-		{
-			sprintf( color_table_entry, "\\blue%s;", token );
-			strcat( rtfColorTable, color_table_entry );
-		}
-
-		// Get next color
-		token = strtok( NULL, separator );
-		color_number++;
-	}
-}
-
-
-// Sets RTF document formatting properties
-void rtf_set_documentformat(RTF_DOCUMENT_FORMAT* df)
-{
-	// Set new RTF document formatting properties
-	memcpy( &rtfDocFormat, df, sizeof(RTF_DOCUMENT_FORMAT) );
-}
-
-
-// Writes RTF document formatting properties
-bool rtf_write_documentformat()
-{
-	// Set error flag
-	bool result = true;
-
-	// RTF document text
-	char rtfText[1024];
-	strcpy( rtfText, "" );
-
-	sprintf( rtfText, "\\viewkind%d\\viewscale%d\\paperw%d\\paperh%d\\margl%d\\margr%d\\margt%d\\margb%d\\gutter%d", 
-		rtfDocFormat.viewKind, rtfDocFormat.viewScale, rtfDocFormat.paperWidth, rtfDocFormat.paperHeight,
-		rtfDocFormat.marginLeft, rtfDocFormat.marginRight, rtfDocFormat.marginTop, rtfDocFormat.marginBottom, rtfDocFormat.gutterWidth );
-
-	if ( rtfDocFormat.facingPages )
-		strcat( rtfText, "\\facingp" );
-	if ( rtfDocFormat.readOnly )
-		strcat( rtfText, "\\annotprot" );
-
-	// Writes RTF document formatting properties
-	if ( fwrite( rtfText, 1, strlen(rtfText), rtfFile ) < strlen(rtfText) )
-		result = false;
-
-	// Return error flag
-	return result;
-}
-
-
-// Sets RTF section formatting properties
-void rtf_set_sectionformat(RTF_SECTION_FORMAT* sf)
-{
-	// Set new RTF section formatting properties
-	memcpy( &rtfSecFormat, sf, sizeof(RTF_SECTION_FORMAT) );
-}
-
-
-// Writes RTF section formatting properties
-bool rtf_write_sectionformat()
-{
-	// Set error flag
-	bool result = true;
-
-	// RTF document text
-	char rtfText[1024];
-	strcpy( rtfText, "" );
-
-	// Format new section
-	char text[1024]="", pgn[100]="";
-	if ( rtfSecFormat.newSection )
-		strcat( text, "\\sect" );
-	if ( rtfSecFormat.defaultSection )
-		strcat( text, "\\sectd" );
-	if ( rtfSecFormat.showPageNumber )
-	{
-		sprintf( pgn, "\\pgnx%d\\pgny%d", rtfSecFormat.pageNumberOffsetX, rtfSecFormat.pageNumberOffsetY );
-		strcat( text, pgn );
-	}
-	
-	// Format section break
-	char sbr[100] = "";
-	switch (rtfSecFormat.sectionBreak)
-	{
-		// Continuous break
-		case RTF_SECTIONBREAK_CONTINUOUS:
-			strcat( sbr, "\\sbknone" );
-			break;
-
-		// Column break
-		case RTF_SECTIONBREAK_COLUMN:
-			strcat( sbr, "\\sbkcol" );
-			break;
-
-		// Page break
-		case RTF_SECTIONBREAK_PAGE:
-			strcat( sbr, "\\sbkpage" );
-			break;
-
-		// Even-page break
-		case RTF_SECTIONBREAK_EVENPAGE:
-			strcat( sbr, "\\sbkeven" );
-			break;
-
-		// Odd-page break
-		case RTF_SECTIONBREAK_ODDPAGE:
-			strcat( sbr, "\\sbkodd" );
-			break;
-	}
-
-	// Format section columns
-	char cols[100] = "";
-	if ( rtfSecFormat.cols == true )
-	{
-		// Format columns
-		sprintf( cols, "\\cols%d\\colsx%d", rtfSecFormat.colsNumber, rtfSecFormat.colsDistance );
-
-		if ( rtfSecFormat.colsLineBetween )
-			strcat( cols, "\\linebetcol" );
-	}
-
-	sprintf( rtfText, "\n%s%s%s\\pgwsxn%d\\pghsxn%d\\marglsxn%d\\margrsxn%d\\margtsxn%d\\margbsxn%d\\guttersxn%d\\headery%d\\footery%d", 
-		text, sbr, cols, rtfSecFormat.pageWidth, rtfSecFormat.pageHeight, rtfSecFormat.pageMarginLeft, rtfSecFormat.pageMarginRight,
-		rtfSecFormat.pageMarginTop, rtfSecFormat.pageMarginBottom, rtfSecFormat.pageGutterWidth, rtfSecFormat.pageHeaderOffset, rtfSecFormat.pageFooterOffset );
-
-	// Writes RTF section formatting properties
-	if ( fwrite( rtfText, 1, strlen(rtfText), rtfFile ) < strlen(rtfText) )
-		result = false;
-
-	// Return error flag
-	return result;
-}
-
-
-// Starts new RTF section
-int rtf_start_section()
-{
-	// Set error flag
-	int error = RTF_SUCCESS;
-
-	// Set new section flag
-	rtfSecFormat.newSection = true;
-
-	// Starts new RTF section
-	if( !rtf_write_sectionformat() )
-		error = RTF_SECTIONFORMAT_ERROR;
-
-	// Return error flag
-	return error;
-}
-
-
-// Sets RTF paragraph formatting properties
-void rtf_set_paragraphformat(RTF_PARAGRAPH_FORMAT* pf)
-{
-	// Set new RTF paragraph formatting properties
-	memcpy( &rtfParFormat, pf, sizeof(RTF_PARAGRAPH_FORMAT) );
-}
-
-
-// Writes RTF paragraph formatting properties
-bool rtf_write_paragraphformat()
-{
-	// Set error flag
-	bool result = true;
-
-	// RTF document text
-	char rtfText[4096];
-	strcpy( rtfText, "" );
-
-	// Format new paragraph
-	char text[1024] = "";
-	if ( rtfParFormat.newParagraph )
-		strcat( text, "\\par" );
-	if ( rtfParFormat.defaultParagraph )
-		strcat( text, "\\pard" );
-	if ( rtfParFormat.tableText == false )
-		strcat( text, "\\plain" );
-	else
-		strcat( text, "\\intbl" );
-	
-	switch (rtfParFormat.paragraphBreak)
-	{
-		// No break
-		case RTF_PARAGRAPHBREAK_NONE:
-			break;
-
-		// Page break;
-		case RTF_PARAGRAPHBREAK_PAGE:
-			strcat( text, "\\page" );
-			break;
-
-		// Column break;
-		case RTF_PARAGRAPHBREAK_COLUMN:
-			strcat( text, "\\column" );
-			break;
-
-		// Line break;
-		case RTF_PARAGRAPHBREAK_LINE:
-			strcat( text, "\\line" );
-			break;
-	}
-
-	// Format aligment
-	switch (rtfParFormat.paragraphAligment)
-	{
-		// Left aligned paragraph
-		case RTF_PARAGRAPHALIGN_LEFT:
-			strcat( text, "\\ql" );
-			break;
-
-		// Center aligned paragraph
-		case RTF_PARAGRAPHALIGN_CENTER:
-			strcat( text, "\\qc" );
-			break;
-
-		// Right aligned paragraph
-		case RTF_PARAGRAPHALIGN_RIGHT:
-			strcat( text, "\\qr" );
-			break;
-
-		// Justified aligned paragraph
-		case RTF_PARAGRAPHALIGN_JUSTIFY:
-			strcat( text, "\\qj" );
-			break;
-	}
-
-	// Format tabs
-	if ( rtfParFormat.paragraphTabs == true )
-	{
-		// Set tab kind
-		switch ( rtfParFormat.TABS.tabKind )
-		{
-			// No tab
-			case RTF_PARAGRAPHTABKIND_NONE:
-				break;
-
-			// Centered tab
-			case RTF_PARAGRAPHTABKIND_CENTER:
-				strcat( text, "\\tqc" );
-				break;
-
-			// Flush-right tab
-			case RTF_PARAGRAPHTABKIND_RIGHT:
-				strcat( text, "\\tqr" );
-				break;
-
-			// Decimal tab
-			case RTF_PARAGRAPHTABKIND_DECIMAL:
-				strcat( text, "\\tqdec" );
-				break;
-		}
-
-		// Set tab leader
-		switch ( rtfParFormat.TABS.tabLead )
-		{
-			// No lead
-			case RTF_PARAGRAPHTABLEAD_NONE:
-				break;
-
-			// Leader dots
-			case RTF_PARAGRAPHTABLEAD_DOT:
-				strcat( text, "\\tldot" );
-				break;
-
-			// Leader middle dots
-			case RTF_PARAGRAPHTABLEAD_MDOT:
-				strcat( text, "\\tlmdot" );
-				break;
-
-			// Leader hyphens
-			case RTF_PARAGRAPHTABLEAD_HYPH:
-				strcat( text, "\\tlhyph" );
-				break;
-
-			// Leader underline
-			case RTF_PARAGRAPHTABLEAD_UNDERLINE:
-				strcat( text, "\\tlul" );
-				break;
-
-			// Leader thick line
-			case RTF_PARAGRAPHTABLEAD_THICKLINE:
-				strcat( text, "\\tlth" );
-				break;
-
-			// Leader equal sign
-			case RTF_PARAGRAPHTABLEAD_EQUAL:
-				strcat( text, "\\tleq" );
-				break;
-		}
-
-		// Set tab position
-		char tb[10];
-		sprintf( tb, "\\tx%d", rtfParFormat.TABS.tabPosition );
-		strcat( text, tb );
-	}
-
-	// Format bullets and numbering
-	if ( rtfParFormat.paragraphNums == true )
-	{
-		char nums[1024];
-		sprintf( nums, "{\\*\\pn\\pnlvl%d\\pnsp%d\\pntxtb %c}", rtfParFormat.NUMS.numsLevel, rtfParFormat.NUMS.numsSpace, rtfParFormat.NUMS.numsChar );
-		strcat( text, nums );
-	}
-
-	// Format paragraph borders
-	if ( rtfParFormat.paragraphBorders == true )
-	{
-		char border[1024] = "";
-
-		// Format paragraph border kind
-		switch (rtfParFormat.BORDERS.borderKind)
-		{
-			// No border
-			case RTF_PARAGRAPHBORDERKIND_NONE:
-				break;
-
-			// Border top
-			case RTF_PARAGRAPHBORDERKIND_TOP:
-				strcat( border, "\\brdrt" );
-				break;
-
-			// Border bottom
-			case RTF_PARAGRAPHBORDERKIND_BOTTOM:
-				strcat( border, "\\brdrb" );
-				break;
-
-			// Border left
-			case RTF_PARAGRAPHBORDERKIND_LEFT:
-				strcat( border, "\\brdrl" );
-				break;
-
-			// Border right
-			case RTF_PARAGRAPHBORDERKIND_RIGHT:
-				strcat( border, "\\brdrr" );
-				break;
-
-			// Border box
-			case RTF_PARAGRAPHBORDERKIND_BOX:
-				strcat( border, "\\box" );
-				break;
-		}
-
-		// Format paragraph border type
-		char *br = rtf_get_bordername(rtfParFormat.BORDERS.borderType);
-		strcat( border, br );
-
-		// Set paragraph border width
-		char brd[100];
-		sprintf( brd, "\\brdrw%d\\brsp%d", rtfParFormat.BORDERS.borderWidth, rtfParFormat.BORDERS.borderSpace );
-		strcat( border, brd );
-		strcat( text, border );
-
-		// Set paragraph border color
-		char brdcol[100];
-		sprintf( brdcol, "\\brdrcf%d", rtfParFormat.BORDERS.borderColor );
-		strcat( text, brdcol );
-	}
-
-	// Format paragraph shading
-	if ( rtfParFormat.paragraphShading == true )
-	{
-		char shading[100];
-		sprintf( shading, "\\shading%d", rtfParFormat.SHADING.shadingIntensity );
-
-		// Format paragraph shading
-		char* sh = rtf_get_shadingname( rtfParFormat.SHADING.shadingType, false );
-		strcat( text, sh );
-
-		// Set paragraph shading color
-		char shcol[100];
-		sprintf( shcol, "\\cfpat%d\\cbpat%d", rtfParFormat.SHADING.shadingFillColor, rtfParFormat.SHADING.shadingBkColor );
-		strcat( text, shcol );
-	}
-
-	// Format paragraph font
-	char font[1024] = "";
-	sprintf( font, "\\animtext%d\\expndtw%d\\kerning%d\\charscalex%d\\f%d\\fs%d\\cf%d", rtfParFormat.CHARACTER.animatedCharacter, 
-		rtfParFormat.CHARACTER.expandCharacter, rtfParFormat.CHARACTER.kerningCharacter, rtfParFormat.CHARACTER.scaleCharacter, 
-		rtfParFormat.CHARACTER.fontNumber, rtfParFormat.CHARACTER.fontSize, rtfParFormat.CHARACTER.foregroundColor );
-	if ( rtfParFormat.CHARACTER.boldCharacter )
-		strcat( font, "\\b" );
-	else
-		strcat( font, "\\b0" );
-	if ( rtfParFormat.CHARACTER.capitalCharacter )
-		strcat( font, "\\caps" );
-	else
-		strcat( font, "\\caps0" );
-	if ( rtfParFormat.CHARACTER.doublestrikeCharacter )
-		strcat( font, "\\striked1" );
-	else
-		strcat( font, "\\striked0" );
-	if ( rtfParFormat.CHARACTER.embossCharacter )
-		strcat( font, "\\embo" );
-	if ( rtfParFormat.CHARACTER.engraveCharacter )
-		strcat( font, "\\impr" );
-	if ( rtfParFormat.CHARACTER.italicCharacter )
-		strcat( font, "\\i" );
-	else
-		strcat( font, "\\i0" );
-	if ( rtfParFormat.CHARACTER.outlineCharacter )
-		strcat( font, "\\outl" );
-	else
-		strcat( font, "\\outl0" );
-	if ( rtfParFormat.CHARACTER.shadowCharacter )
-		strcat( font, "\\shad" );
-	else
-		strcat( font, "\\shad0" );
-	if ( rtfParFormat.CHARACTER.smallcapitalCharacter )
-		strcat( font, "\\scaps" );
-	else
-		strcat( font, "\\scaps0" );
-	if ( rtfParFormat.CHARACTER.strikeCharacter )
-		strcat( font, "\\strike" );
-	else
-		strcat( font, "\\strike0" );
-	if ( rtfParFormat.CHARACTER.subscriptCharacter )
-		strcat( font, "\\sub" );
-	if ( rtfParFormat.CHARACTER.superscriptCharacter )
-		strcat( font, "\\super" );
-	
-	switch (rtfParFormat.CHARACTER.underlineCharacter)
-	{
-		// None underline
-		case 0:
-			strcat( font, "\\ulnone" );
-			break;
-
-		// Continuous underline
-		case 1:
-			strcat( font, "\\ul" );
-			break;
-
-		// Dotted underline
-		case 2:
-			strcat( font, "\\uld" );
-			break;
-
-		// Dashed underline
-		case 3:
-			strcat( font, "\\uldash" );
-			break;
-
-		// Dash-dotted underline
-		case 4:
-			strcat( font, "\\uldashd" );
-			break;
-
-		// Dash-dot-dotted underline
-		case 5:
-			strcat( font, "\\uldashdd" );
-			break;
-
-		// Double underline
-		case 6:
-			strcat( font, "\\uldb" );
-			break;
-
-		// Heavy wave underline
-		case 7:
-			strcat( font, "\\ulhwave" );
-			break;
-
-		// Long dashed underline
-		case 8:
-			strcat( font, "\\ulldash" );
-			break;
-
-		// Thick underline
-		case 9:
-			strcat( font, "\\ulth" );
-			break;
-
-		// Thick dotted underline
-		case 10:
-			strcat( font, "\\ulthd" );
-			break;
-
-		// Thick dashed underline
-		case 11:
-			strcat( font, "\\ulthdash" );
-			break;
-
-		// Thick dash-dotted underline
-		case 12:
-			strcat( font, "\\ulthdashd" );
-			break;
-
-		// Thick dash-dot-dotted underline
-		case 13:
-			strcat( font, "\\ulthdashdd" );
-			break;
-
-		// Thick long dashed underline
-		case 14:
-			strcat( font, "\\ulthldash" );
-			break;
-
-		// Double wave underline
-		case 15:
-			strcat( font, "\\ululdbwave" );
-			break;
-
-		// Word underline
-		case 16:
-			strcat( font, "\\ulw" );
-			break;
-
-		// Wave underline
-		case 17:
-			strcat( font, "\\ulwave" );
-			break;
-	}
-
-	char txt[20] = "";
-	// Set paragraph tabbed text
-	if ( rtfParFormat.tabbedText == false )
-	{
-		sprintf( rtfText, "\n%s\\fi%d\\li%d\\ri%d\\sb%d\\sa%d\\sl%d%s %s", text, 
-			rtfParFormat.firstLineIndent, rtfParFormat.leftIndent, rtfParFormat.rightIndent, rtfParFormat.spaceBefore, 
-			rtfParFormat.spaceAfter, rtfParFormat.lineSpacing, font, rtfParFormat.paragraphText );
-	}
-	else
-		sprintf( rtfText, "\\tab %s", rtfParFormat.paragraphText );
-
-	// Writes RTF paragraph formatting properties
-	if ( fwrite( rtfText, 1, strlen(rtfText), rtfFile ) < strlen(rtfText) )
-		result = false;
-
-	// Return error flag
-	return result;
-}
-
-
-// Starts new RTF paragraph
-int rtf_start_paragraph(char* text, bool newPar)
-{
-	// Set error flag
-	int error = RTF_SUCCESS;
-
-	// Copy paragraph text
-	rtfParFormat.paragraphText = new char[strlen(text)];
-	strcpy( rtfParFormat.paragraphText, text );
-
-	// Set new paragraph
-	rtfParFormat.newParagraph = newPar;
-
-	// Starts new RTF paragraph
-	if( !rtf_write_paragraphformat() )
-		error = RTF_PARAGRAPHFORMAT_ERROR;
-
-	// Return error flag
-	return error;
-}
-
-
-// Gets RTF document formatting properties
-RTF_DOCUMENT_FORMAT* rtf_get_documentformat()
-{
-	// Get current RTF document formatting properties
-	return &rtfDocFormat;
-}
-
-
-// Gets RTF section formatting properties
-RTF_SECTION_FORMAT* rtf_get_sectionformat()
-{
-	// Get current RTF section formatting properties
-	return &rtfSecFormat;
-}
-
-
-// Gets RTF paragraph formatting properties
-RTF_PARAGRAPH_FORMAT* rtf_get_paragraphformat()
-{
-	// Get current RTF paragraph formatting properties
-	return &rtfParFormat;
-}
-
-
-// Loads image from file
-int rtf_load_image(char* image, int width, int height)
-{
-	// Set error flag
-	int error = RTF_SUCCESS;
-
-	// Check image type
-	bool err = false;
-	if ( strstr(image,".bmp") == NULL )
-	{
-		if ( strstr(image,".jpg") == NULL )
-		{
-			if (strstr(image,".gif") == NULL )
-				err = true;
-		}
-	}
-
-	// If valid image type
-	if ( err == false )
-	{
-		// Free IPicture object
-		if ( rtfPicture != NULL )
-		{
-			rtfPicture->Release();
-			rtfPicture = NULL;
-		}
-
-		// Read image file
-		int imageFile = _open( image, _O_RDONLY | _O_BINARY );
-		struct _stat st;
-		_fstat( imageFile, &st );
-		DWORD nSize = st.st_size;
-		BYTE* pBuff = new BYTE[nSize];
-		_read( imageFile, pBuff, nSize );
-		// Alocate memory for image data
-		HGLOBAL hGlobal = GlobalAlloc(GMEM_MOVEABLE, nSize);
-		void* pData = GlobalLock(hGlobal);
-		memcpy(pData, pBuff, nSize);
-		GlobalUnlock(hGlobal);
-		// Load image using OLE
-		IStream* pStream = NULL;
-		if ( CreateStreamOnHGlobal(hGlobal, TRUE, &pStream) == S_OK )
-		{
-			HRESULT hr;
-			if ((hr = OleLoadPicture( pStream, nSize, FALSE, IID_IPicture, (LPVOID *)&rtfPicture)) != S_OK)
-				error = RTF_IMAGE_ERROR;
-
-			pStream->Release();
-		}
-		delete []pBuff;
-		_close(imageFile);
-
-		// If image is loaded
-		if ( rtfPicture != NULL )
-		{
-			// Calculate image size
-			long hmWidth;
-			long hmHeight;
-			rtfPicture->get_Width(&hmWidth);
-			rtfPicture->get_Height(&hmHeight);
-			int nWidth	= MulDiv( hmWidth, GetDeviceCaps(GetDC(NULL),LOGPIXELSX), 2540 );
-			int nHeight	= MulDiv( hmHeight, GetDeviceCaps(GetDC(NULL),LOGPIXELSY), 2540 );
-
-			// Create metafile;
-			HDC hdcMeta = CreateMetaFile(NULL);
-
-			// Render picture to metafile
-			rtfPicture->Render( hdcMeta, 0, 0, nWidth, nHeight, 0, hmHeight, hmWidth, -hmHeight, NULL );
-
-			// Close metafile
-			HMETAFILE hmf = CloseMetaFile(hdcMeta);
-
-			// Get metafile data
-			UINT size = GetMetaFileBitsEx( hmf, 0, NULL );
-			BYTE* buffer = new BYTE[size];
-			GetMetaFileBitsEx( hmf, size, buffer );
-			DeleteMetaFile(hmf);
-
-			// Convert metafile binary data to hexadecimal
-			char* str = rtf_bin_hex_convert( buffer, size );
-			delete []buffer;
-
-			// Format picture paragraph
-			RTF_PARAGRAPH_FORMAT* pf = rtf_get_paragraphformat();
-			pf->paragraphText = "";
-			rtf_write_paragraphformat();
-
-			// Writes RTF picture data
-			char rtfText[1024];
-			sprintf( rtfText, "\n{\\pict\\wmetafile8\\picwgoal%d\\pichgoal%d\\picscalex%d\\picscaley%d\n", hmWidth, hmHeight, width, height );
-			if ( fwrite( rtfText, 1, strlen(rtfText), rtfFile ) < strlen(rtfText) )
-				error = RTF_IMAGE_ERROR;
-			fwrite( str, 1, 2*size, rtfFile );
-			strcpy( rtfText, "}" );
-			fwrite( rtfText, 1, strlen(rtfText), rtfFile );
-		}
-	}
-	else
-	{
-		// Writes RTF picture data
-		char rtfText[1024];
-		strcpy( rtfText, "\n\\par\\pard *** Error! Wrong image format ***\\par" );
-		fwrite( rtfText, 1, strlen(rtfText), rtfFile );
-	}
-
-	// Return error flag
-	return error;
-}
-
-
-// Converts binary data to hex
-char* rtf_bin_hex_convert(unsigned char* binary, int size)
-{
-	char* result = new char[2*size];
-
-	char part1, part2;
-	for ( int i=0; i<size; i++ )
-	{
-		part1 = binary[i] / 16;
-		if ( part1 < 10 )
-			part1 += 48;
-		else
-		{
-			if ( part1 == 10 )
-				part1 = 'a';
-			if ( part1 == 11 )
-				part1 = 'b';
-			if ( part1 == 12 )
-				part1 = 'c';
-			if ( part1 == 13 )
-				part1 = 'd';
-			if ( part1 == 14 )
-				part1 = 'e';
-			if ( part1 == 15 )
-				part1 = 'f';
-		}
-
-		part2 = binary[i] % 16;
-		if ( part2 < 10 )
-			part2 += 48;
-		else
-		{
-			if ( part2 == 10 )
-				part2 = 'a';
-			if ( part2 == 11 )
-				part2 = 'b';
-			if ( part2 == 12 )
-				part2 = 'c';
-			if ( part2 == 13 )
-				part2 = 'd';
-			if ( part2 == 14 )
-				part2 = 'e';
-			if ( part2 == 15 )
-				part2 = 'f';
-		}
-
-		result[2*i] = part1;
-		result[2*i+1] = part2;
-	}
-
-	strcat( result, "\0" );
-
-	return result;
-}
-
-
-// Starts new RTF table row
-int rtf_start_tablerow()
-{
-	// Set error flag
-	int error = RTF_SUCCESS;
-
-	char tblrw[] = "";
-	// Format table row aligment
-	switch (rtfRowFormat.rowAligment)
-	{
-		// Left align
-		case RTF_ROWTEXTALIGN_LEFT:
-			strcat( tblrw, "\\trql" );
-			break;
-
-		// Center align
-		case RTF_ROWTEXTALIGN_CENTER:
-			strcat( tblrw, "\\trqc" );
-			break;
-
-		// Right align
-		case RTF_ROWTEXTALIGN_RIGHT:
-			strcat( tblrw, "\\trqr" );
-			break;
-	}
-
-	// Writes RTF table data
-	char rtfText[1024];
-	sprintf( rtfText, "\n\\trowd\\trgaph115%s\\trleft%d\\trrh%d\\trpaddb%d\\trpaddfb3\\trpaddl%d\\trpaddfl3\\trpaddr%d\\trpaddfr3\\trpaddt%d\\trpaddft3", 
-		tblrw, rtfRowFormat.rowLeftMargin, rtfRowFormat.rowHeight, rtfRowFormat.marginTop, rtfRowFormat.marginBottom, rtfRowFormat.marginLeft, rtfRowFormat.marginRight );
-	if ( fwrite( rtfText, 1, strlen(rtfText), rtfFile ) < strlen(rtfText) )
-		error = RTF_TABLE_ERROR;
-
-	// Return error flag
-	return error;
-}
-
-
-// Ends RTF table row
-int rtf_end_tablerow()
-{
-	// Set error flag
-	int error = RTF_SUCCESS;
-
-	// Writes RTF table data
-	char rtfText[1024];
-	sprintf( rtfText, "\n\\trgaph115\\row\\pard" );
-	if ( fwrite( rtfText, 1, strlen(rtfText), rtfFile ) < strlen(rtfText) )
-		error = RTF_TABLE_ERROR;
-
-	// Return error flag
-	return error;
-}
-
-
-// Starts new RTF table cell
-int rtf_start_tablecell(int rightMargin)
-{
-	// Set error flag
-	int error = RTF_SUCCESS;
-
-	char tblcla[20];
-	// Format table cell text aligment
-	switch (rtfCellFormat.textVerticalAligment)
-	{
-		// Top align
-		case RTF_CELLTEXTALIGN_TOP:
-			strcpy( tblcla, "\\clvertalt" );
-			break;
-
-		// Center align
-		case RTF_CELLTEXTALIGN_CENTER:
-			strcpy( tblcla, "\\clvertalc" );
-			break;
-
-		// Bottom align
-		case RTF_CELLTEXTALIGN_BOTTOM:
-			strcpy( tblcla, "\\clvertalb" );
-			break;
-	}
-
-	char tblcld[20];
-	// Format table cell text direction
-	switch (rtfCellFormat.textDirection)
-	{
-		// Left to right, top to bottom
-		case RTF_CELLTEXTDIRECTION_LRTB:
-			strcpy( tblcld, "\\cltxlrtb" );
-			break;
-
-		// Right to left, top to bottom
-		case RTF_CELLTEXTDIRECTION_RLTB:
-			strcpy( tblcld, "\\cltxtbrl" );
-			break;
-
-		// Left to right, bottom to top
-		case RTF_CELLTEXTDIRECTION_LRBT:
-			strcpy( tblcld, "\\cltxbtlr" );
-			break;
-
-		// Left to right, top to bottom, vertical
-		case RTF_CELLTEXTDIRECTION_LRTBV:
-			strcpy( tblcld, "\\cltxlrtbv" );
-			break;
-
-		// Right to left, top to bottom, vertical
-		case RTF_CELLTEXTDIRECTION_RLTBV:
-			strcpy( tblcld, "\\cltxtbrlv" );
-			break;
-	}
-
-	char tbclbrb[1024]="", tbclbrl[1024]="", tbclbrr[1024]="", tbclbrt[1024]="";
-	// Format table cell border
-	if ( rtfCellFormat.borderBottom.border == true )
-	{
-		// Bottom cell border
-		char tbclbt[20];
-		strcpy( tbclbt, "\\clbrdrb" );
-
-		char* border = rtf_get_bordername(rtfCellFormat.borderBottom.BORDERS.borderType);
-
-		sprintf( tbclbrb, "%s%s\\brdrw%d\\brsp%d\\brdrcf%d", tbclbt, border, rtfCellFormat.borderBottom.BORDERS.borderWidth, 
-			rtfCellFormat.borderBottom.BORDERS.borderSpace, rtfCellFormat.borderBottom.BORDERS.borderColor );
-	}
-	if ( rtfCellFormat.borderLeft.border == true )
-	{
-		// Left cell border
-		char tbclbt[20];
-		strcpy( tbclbt, "\\clbrdrl" );
-
-		char* border = rtf_get_bordername(rtfCellFormat.borderLeft.BORDERS.borderType);
-
-		sprintf( tbclbrl, "%s%s\\brdrw%d\\brsp%d\\brdrcf%d", tbclbt, border, rtfCellFormat.borderLeft.BORDERS.borderWidth, 
-		rtfCellFormat.borderLeft.BORDERS.borderSpace, rtfCellFormat.borderLeft.BORDERS.borderColor );
-	}
-	if ( rtfCellFormat.borderRight.border == true )
-	{
-		// Right cell border
-		char tbclbt[20];
-		strcpy( tbclbt, "\\clbrdrr" );
-
-		char* border = rtf_get_bordername(rtfCellFormat.borderRight.BORDERS.borderType);
-
-		sprintf( tbclbrr, "%s%s\\brdrw%d\\brsp%d\\brdrcf%d", tbclbt, border, rtfCellFormat.borderRight.BORDERS.borderWidth, 
-		rtfCellFormat.borderRight.BORDERS.borderSpace, rtfCellFormat.borderRight.BORDERS.borderColor );
-	}
-	if ( rtfCellFormat.borderTop.border == true )
-	{
-		// Top cell border
-		char tbclbt[20];
-		strcpy( tbclbt, "\\clbrdrt" );
-
-		char* border = rtf_get_bordername(rtfCellFormat.borderTop.BORDERS.borderType);
-
-		sprintf( tbclbrt, "%s%s\\brdrw%d\\brsp%d\\brdrcf%d", tbclbt, border, rtfCellFormat.borderTop.BORDERS.borderWidth, 
-		rtfCellFormat.borderTop.BORDERS.borderSpace, rtfCellFormat.borderTop.BORDERS.borderColor );
-	}
-
-	// Format table cell shading
-	char shading[100] = "";
-	if ( rtfCellFormat.cellShading == true )
-	{
-		char* sh = rtf_get_shadingname( rtfCellFormat.SHADING.shadingType, true );
-
-		// Set paragraph shading color
-		sprintf( shading, "%s\\clshdgn%d\\clcfpat%d\\clcbpat%d", sh, rtfCellFormat.SHADING.shadingIntensity, rtfCellFormat.SHADING.shadingFillColor, rtfCellFormat.SHADING.shadingBkColor );
-	}
-
-	// Writes RTF table data
-	char rtfText[1024];
-	sprintf( rtfText, "\n\\tcelld%s%s%s%s%s%s%s\\cellx%d", tblcla, tblcld, tbclbrb, tbclbrl, tbclbrr, tbclbrt, shading, rightMargin );
-	if ( fwrite( rtfText, 1, strlen(rtfText), rtfFile ) < strlen(rtfText) )
-		error = RTF_TABLE_ERROR;
-
-	// Return error flag
-	return error;
-}
-
-
-// Ends RTF table cell
-int rtf_end_tablecell()
-{
-	// Set error flag
-	int error = RTF_SUCCESS;
-
-	// Writes RTF table data
-	char rtfText[1024];
-	strcpy( rtfText, "\n\\cell " );
-	if ( fwrite( rtfText, 1, strlen(rtfText), rtfFile ) < strlen(rtfText) )
-		error = RTF_TABLE_ERROR;
-
-	// Return error flag
-	return error;
-}
-
-
-// Gets RTF table row formatting properties
-RTF_TABLEROW_FORMAT* rtf_get_tablerowformat()
-{
-	// Get current RTF table row formatting properties
-	return &rtfRowFormat;
-}
-
-
-// Sets RTF table row formatting properties
-void rtf_set_tablerowformat(RTF_TABLEROW_FORMAT* rf)
-{
-	// Set new RTF table row formatting properties
-	memcpy( &rtfRowFormat, rf, sizeof(RTF_TABLEROW_FORMAT) );
-}
-
-
-// Gets RTF table cell formatting properties
-RTF_TABLECELL_FORMAT* rtf_get_tablecellformat()
-{
-	// Get current RTF table cell formatting properties
-	return &rtfCellFormat;
-}
-
-
-// Sets RTF table cell formatting properties
-void rtf_set_tablecellformat(RTF_TABLECELL_FORMAT* cf)
-{
-	// Set new RTF table cell formatting properties
-	memcpy( &rtfCellFormat, cf, sizeof(RTF_TABLECELL_FORMAT) );
-}
-
-
-// Gets border name
-char* rtf_get_bordername(int border_type)
-{
-	char* border = new char[20];
-
-	switch (border_type)
-	{
-		// Single-thickness border
-		case RTF_PARAGRAPHBORDERTYPE_STHICK:
-			strcpy( border, "\\brdrs" );
-			break;
-
-		// Double-thickness border
-		case RTF_PARAGRAPHBORDERTYPE_DTHICK:
-			strcpy( border, "\\brdrth" );
-			break;
-
-		// Shadowed border
-		case RTF_PARAGRAPHBORDERTYPE_SHADOW:
-			strcpy( border, "\\brdrsh" );
-			break;
-
-		// Double border
-		case RTF_PARAGRAPHBORDERTYPE_DOUBLE:
-			strcpy( border, "\\brdrdb" );
-			break;
-
-		// Dotted border
-		case RTF_PARAGRAPHBORDERTYPE_DOT:
-			strcpy( border, "\\brdrdot" );
-			break;
-
-		// Dashed border
-		case RTF_PARAGRAPHBORDERTYPE_DASH:
-			strcpy( border, "\\brdrdash" );
-			break;
-
-		// Hairline border
-		case RTF_PARAGRAPHBORDERTYPE_HAIRLINE:
-			strcpy( border, "\\brdrhair" );
-			break;
-
-		// Inset border
-		case RTF_PARAGRAPHBORDERTYPE_INSET:
-			strcpy( border, "\\brdrinset" );
-			break;
-
-		// Dashed border (small)
-		case RTF_PARAGRAPHBORDERTYPE_SDASH:
-			strcpy( border, "\\brdrdashsm" );
-			break;
-
-		// Dot-dashed border
-		case RTF_PARAGRAPHBORDERTYPE_DOTDASH:
-			strcpy( border, "\\brdrdashd" );
-			break;
-
-		// Dot-dot-dashed border
-		case RTF_PARAGRAPHBORDERTYPE_DOTDOTDASH:
-			strcpy( border, "\\brdrdashdd" );
-			break;
-
-		// Outset border
-		case RTF_PARAGRAPHBORDERTYPE_OUTSET:
-			strcpy( border, "\\brdroutset" );
-			break;
-
-		// Triple border
-		case RTF_PARAGRAPHBORDERTYPE_TRIPLE:
-			strcpy( border, "\\brdrtriple" );
-			break;
-
-		// Wavy border
-		case RTF_PARAGRAPHBORDERTYPE_WAVY:
-			strcpy( border, "\\brdrwavy" );
-			break;
-
-		// Double wavy border
-		case RTF_PARAGRAPHBORDERTYPE_DWAVY:
-			strcpy( border, "\\brdrwavydb" );
-			break;
-
-		// Striped border
-		case RTF_PARAGRAPHBORDERTYPE_STRIPED:
-			strcpy( border, "\\brdrdashdotstr" );
-			break;
-
-		// Embossed border
-		case RTF_PARAGRAPHBORDERTYPE_EMBOSS:
-			strcpy( border, "\\brdremboss" );
-			break;
-
-		// Engraved border
-		case RTF_PARAGRAPHBORDERTYPE_ENGRAVE:
-			strcpy( border, "\\brdrengrave" );
-			break;
-	}
-
-	return border;
-}
-
-
-// Gets shading name
-char* rtf_get_shadingname(int shading_type, bool cell)
-{
-	char* shading = new char[20];
-
-	if ( cell == false )
-	{
-		switch (shading_type)
-		{
-			// Fill shading
-			case RTF_PARAGRAPHSHADINGTYPE_FILL:
-				strcpy( shading, "" );
-				break;
-
-			// Horizontal background pattern
-			case RTF_PARAGRAPHSHADINGTYPE_HORIZ:
-				strcpy( shading, "\\bghoriz" );
-				break;
-
-			// Vertical background pattern
-			case RTF_PARAGRAPHSHADINGTYPE_VERT:
-				strcpy( shading, "\\bgvert" );
-				break;
-
-			// Forward diagonal background pattern
-			case RTF_PARAGRAPHSHADINGTYPE_FDIAG:
-				strcpy( shading, "\\bgfdiag" );
-				break;
-
-			// Backward diagonal background pattern
-			case RTF_PARAGRAPHSHADINGTYPE_BDIAG:
-				strcpy( shading, "\\bgbdiag" );
-				break;
-
-			// Cross background pattern
-			case RTF_PARAGRAPHSHADINGTYPE_CROSS:
-				strcpy( shading, "\\bgcross" );
-				break;
-
-			// Diagonal cross background pattern
-			case RTF_PARAGRAPHSHADINGTYPE_CROSSD:
-				strcpy( shading, "\\bgdcross" );
-				break;
-
-			// Dark horizontal background pattern
-			case RTF_PARAGRAPHSHADINGTYPE_DHORIZ:
-				strcpy( shading, "\\bgdkhoriz" );
-				break;
-
-			// Dark vertical background pattern
-			case RTF_PARAGRAPHSHADINGTYPE_DVERT:
-				strcpy( shading, "\\bgdkvert" );
-				break;
-
-			// Dark forward diagonal background pattern
-			case RTF_PARAGRAPHSHADINGTYPE_DFDIAG:
-				strcpy( shading, "\\bgdkfdiag" );
-				break;
-
-			// Dark backward diagonal background pattern
-			case RTF_PARAGRAPHSHADINGTYPE_DBDIAG:
-				strcpy( shading, "\\bgdkbdiag" );
-				break;
-
-			// Dark cross background pattern
-			case RTF_PARAGRAPHSHADINGTYPE_DCROSS:
-				strcpy( shading, "\\bgdkcross" );
-				break;
-
-			// Dark diagonal cross background pattern
-			case RTF_PARAGRAPHSHADINGTYPE_DCROSSD:
-				strcpy( shading, "\\bgdkdcross" );
-				break;
-		}
-	}
-	else
-	{
-		switch (shading_type)
-		{
-			// Fill shading
-			case RTF_CELLSHADINGTYPE_FILL:
-				strcpy( shading, "" );
-				break;
-
-			// Horizontal background pattern
-			case RTF_CELLSHADINGTYPE_HORIZ:
-				strcpy( shading, "\\clbghoriz" );
-				break;
-
-			// Vertical background pattern
-			case RTF_CELLSHADINGTYPE_VERT:
-				strcpy( shading, "\\clbgvert" );
-				break;
-
-			// Forward diagonal background pattern
-			case RTF_CELLSHADINGTYPE_FDIAG:
-				strcpy( shading, "\\clbgfdiag" );
-				break;
-
-			// Backward diagonal background pattern
-			case RTF_CELLSHADINGTYPE_BDIAG:
-				strcpy( shading, "\\clbgbdiag" );
-				break;
-
-			// Cross background pattern
-			case RTF_CELLSHADINGTYPE_CROSS:
-				strcpy( shading, "\\clbgcross" );
-				break;
-
-			// Diagonal cross background pattern
-			case RTF_CELLSHADINGTYPE_CROSSD:
-				strcpy( shading, "\\clbgdcross" );
-				break;
-
-			// Dark horizontal background pattern
-			case RTF_CELLSHADINGTYPE_DHORIZ:
-				strcpy( shading, "\\clbgdkhoriz" );
-				break;
-
-			// Dark vertical background pattern
-			case RTF_CELLSHADINGTYPE_DVERT:
-				strcpy( shading, "\\clbgdkvert" );
-				break;
-
-			// Dark forward diagonal background pattern
-			case RTF_CELLSHADINGTYPE_DFDIAG:
-				strcpy( shading, "\\clbgdkfdiag" );
-				break;
-
-			// Dark backward diagonal background pattern
-			case RTF_CELLSHADINGTYPE_DBDIAG:
-				strcpy( shading, "\\clbgdkbdiag" );
-				break;
-
-			// Dark cross background pattern
-			case RTF_CELLSHADINGTYPE_DCROSS:
-				strcpy( shading, "\\clbgdkcross" );
-				break;
-
-			// Dark diagonal cross background pattern
-			case RTF_CELLSHADINGTYPE_DCROSSD:
-				strcpy( shading, "\\clbgdkdcross" );
-				break;
-		}
-	}
-
-	return shading;
-}
+#include "errors.h"
+#include "globals.h"
+#include "rtflib.h"
+
+
+
+RTF_DOCUMENT_FORMAT rtfDocFormat;					// RTF document formatting params
+RTF_SECTION_FORMAT rtfSecFormat;					// RTF section formatting params
+RTF_PARAGRAPH_FORMAT rtfParFormat;					// RTF paragraph formatting params
+RTF_TABLEROW_FORMAT rtfRowFormat;					// RTF table row formatting params
+RTF_TABLECELL_FORMAT rtfCellFormat;					// RTF table cell formatting params
+
+
+
+// RTF library global params
+FILE* rtfFile = NULL;
+char rtfFontTable[4096] = "";
+char* rtfColorTable = NULL;
+size_t rtfColorTableLength = 0;
+size_t rtfColorTableSize = 0;
+IPicture* rtfPicture = NULL;
+RTF_TEMPLATE* rtfTemplate = NULL;
+bool rtfHeaderWritten = false;
+RTF_ARENA rtfArena = {NULL, NULL, 0};
+bool rtfTextStarted = false;
+bool rtfRunStarted = false;
+RTF_CHARACTER_FORMAT rtfRunFormat;
+RTF_NUMS_FORMAT rtfLists[RTF_LIST_MAXCOUNT];
+int rtfListCount = 0;
+int rtfListLevel = 0;
+RTF_TOC rtfToc;
+RTF_HASH_TABLE rtfFontHash = {NULL, 0, 0, &rtfArena};
+RTF_HASH_TABLE rtfColorHash = {NULL, 0, 0, &rtfArena};
+int rtfFontCount = 0;
+int rtfColorCount = 0;
+bool rtfDeferred = false;
+char rtfFileName[1024] = "";
+bool rtfBinaryFile = false;
+char rtfCheckpointName[1024] = "";
+char* rtfSpoolData = NULL;
+size_t rtfSpoolSize = 0;
+size_t rtfSpoolCapacity = 0;
+size_t rtfSpoolLimit = 1048576;
+RTF_MEMORY_USAGE rtfMemory;
+bool rtfMemoryRefused = false;
+int rtfColorLevels = 0;
+int* rtfColorCache = NULL;
+RTF_EXTRACTOR* rtfExtractor = NULL;
+RTF_ANALYZER* rtfAnalyzer = NULL;
+char rtfAnalysisName[1024] = "";
+RTF_INDEX* rtfIndex = NULL;
+RTF_PREVIOUS* rtfPrevious = NULL;
+RTF_STATS rtfStats;
+RTF_STATS rtfProcessStats;
+bool rtfTraceEnabled = false;
+char rtfTraceName[1024] = "";
+LONGLONG rtfTraceStart = 0;
+RTF_TRACE_SPANS rtfTraceSpans;
+RTF_TRACE_BUFFER* rtfTraceBuffers[RTF_TRACE_MAXBUFFERS];
+CRITICAL_SECTION rtfTraceLock;
+bool rtfTraceLockReady = false;
+__declspec(thread) RTF_TRACE_BUFFER* rtfTraceBuffer = NULL;
+char rtfHexDigits[] = "0123456789abcdef";
+
+
+
+// Creates new RTF document
+int rtf_open( char* filename, char* fonts, char* colors )
+{
+	// Set error flag
+	int error = RTF_SUCCESS;
+	RTF_STATS_START();
+	RTF_TRACE_START(traceStart);
+
+	// Initialize global params
+	rtf_init();
+	RTF_STATS_ADD( documentCount, 1 );
+
+	// Set RTF document font table
+	if ( fonts != NULL )
+	{
+		if ( strcmp( fonts, "" ) != 0 )
+			rtf_set_fonttable(fonts);
+	}
+
+	// Set RTF document color table
+	if ( colors != NULL )
+	{
+		if ( strcmp( colors, "" ) != 0 )
+			rtf_set_colortable(colors);
+	}
+
+	// Create RTF document
+	rtfFile = fopen( filename, "w" );
+	if ( strlen(filename) < sizeof(rtfFileName) )
+		strcpy( rtfFileName, filename );
+
+	if ( rtfFile != NULL )
+	{
+		// Write RTF document header
+		if ( !rtf_write_header() )
+			error = RTF_HEADER_ERROR;
+
+		// Write RTF document formatting properties
+		if ( !rtf_write_documentformat() )
+			error = RTF_DOCUMENTFORMAT_ERROR;
+
+		// Create first RTF document section with default formatting
+		rtf_write_sectionformat();
+	}
+	else
+		error = RTF_OPEN_ERROR;
+
+	// Count entry point call
+	RTF_STATS_END(RTF_STATSCALL_OPEN);
+	RTF_TRACE( rtf_trace_end( "rtf_open", &traceStart, 0 ) );
+
+	// Return error flag
+	return error;
+}
+
+
+// Opens existing RTF document for appending
+int rtf_open_append(char* filename, char* fonts, char* colors)
+{
+	// Set error flag
+	int error = RTF_SUCCESS;
+	RTF_STATS_START();
+	RTF_TRACE_START(traceStart);
+
+	// Initialize global params
+	rtf_init();
+	RTF_STATS_ADD( documentCount, 1 );
+
+	// Set RTF document font table
+	bool checkFonts = false;
+	if ( fonts != NULL )
+	{
+		if ( strcmp( fonts, "" ) != 0 )
+		{
+			rtf_set_fonttable(fonts);
+			checkFonts = true;
+		}
+	}
+
+	// Set RTF document color table
+	bool checkColors = false;
+	if ( colors != NULL )
+	{
+		if ( strcmp( colors, "" ) != 0 )
+		{
+			rtf_set_colortable(colors);
+			checkColors = true;
+		}
+	}
+
+	// Appended RTF document is not indexed (header and section offsets are unknown)
+	if ( rtfIndex != NULL )
+		rtf_free_index();
+
+	// Appended RTF document list table is not read (list paragraphs are written without list numbers)
+	rtfListCount = 0;
+
+	// Open existing RTF document
+	rtfFile = fopen( filename, "r+b" );
+	if ( rtfFile == NULL )
+	{
+		RTF_STATS_END(RTF_STATSCALL_OPEN);
+		RTF_TRACE( rtf_trace_end( "rtf_open", &traceStart, 0 ) );
+		return RTF_OPEN_ERROR;
+	}
+	if ( strlen(filename) < sizeof(rtfFileName) )
+		strcpy( rtfFileName, filename );
+	rtfBinaryFile = true;
+
+	// Read RTF document header (up to generator group, color table can be large)
+	int headerSize = 0, headerCapacity = 0;
+	char* header = NULL;
+	do
+	{
+		// Header buffer is heap memory freed after header is parsed (it can be larger than arena blocks)
+		headerCapacity = ( headerCapacity == 0 ? 65536 : 2*headerCapacity );
+		char* buffer = new char[headerCapacity+1];
+		RTF_STATS_ADD( allocationCount, 1 );
+		memcpy( buffer, header, headerSize );
+		delete []header;
+		header = buffer;
+		headerSize += fread( header + headerSize, 1, headerCapacity - headerSize, rtfFile );
+		header[headerSize] = '\0';
+	}
+	while ( headerSize == headerCapacity && strstr( header, "{\\*\\generator" ) == NULL );
+
+	// Read RTF document font and color table
+	char* fontTable = new char[headerSize+1];
+	char* colorTable = new char[headerSize+1];
+	RTF_STATS_ADD( allocationCount, 2 );
+	if ( strncmp( header, "{\\rtf1", 6 ) != 0 )
+		error = RTF_APPEND_ERROR;
+	else if ( !rtf_read_table( header, "{\\fonttbl", fontTable, headerSize+1 ) )
+		error = RTF_APPEND_ERROR;
+	else if ( !rtf_read_table( header, "{\\colortbl", colorTable, headerSize+1 ) )
+		error = RTF_APPEND_ERROR;
+	// Document tables must start with all requested fonts and colors (same numbers)
+	else if ( strlen(fontTable) >= sizeof(rtfFontTable) )
+		error = RTF_FONTTABLE_ERROR;
+	else if ( checkFonts && strncmp( fontTable, rtfFontTable, strlen(rtfFontTable) ) != 0 )
+		error = RTF_FONTTABLE_ERROR;
+	else if ( checkColors && strncmp( colorTable, rtfColorTable, rtfColorTableLength ) != 0 )
+		error = RTF_COLORTABLE_ERROR;
+	else
+	{
+		// Use RTF document font and color table
+		strcpy( rtfFontTable, fontTable );
+		rtfColorTableLength = 0;
+		rtf_append_colortable( colorTable );
+		rtf_hash_clear( &rtfFontHash );
+		rtf_hash_clear( &rtfColorHash );
+	}
+	delete []header;
+	delete []fontTable;
+	delete []colorTable;
+
+	// Find RTF document end part
+	long position = -1;
+	if ( error == RTF_SUCCESS )
+	{
+		char tail[64];
+		fseek( rtfFile, 0, SEEK_END );
+		long fileSize = ftell(rtfFile);
+		long tailSize = ( fileSize < (long)sizeof(tail) ? fileSize : (long)sizeof(tail) );
+		fseek( rtfFile, fileSize - tailSize, SEEK_SET );
+		fread( tail, 1, tailSize, rtfFile );
+
+		// Skip trailing white space
+		long end = tailSize;
+		while ( end > 0 && ( tail[end-1] == '\r' || tail[end-1] == '\n' || tail[end-1] == ' ' ) )
+			end--;
+
+		// Document must end with "\par}" written by rtf_close
+		if ( end >= 5 && strncmp( tail + end - 5, "\\par}", 5 ) == 0 )
+		{
+			end -= 5;
+			while ( end > 0 && ( tail[end-1] == '\r' || tail[end-1] == '\n' ) )
+				end--;
+			position = fileSize - tailSize + end;
+		}
+		else
+			error = RTF_APPEND_ERROR;
+	}
+
+	if ( error == RTF_SUCCESS )
+	{
+		// Seek back over RTF document end part (it is written again by rtf_close)
+		fseek( rtfFile, position, SEEK_SET );
+		rtfHeaderWritten = true;
+	}
+	else
+	{
+		// Leave RTF document unchanged
+		fclose(rtfFile);
+		rtfFile = NULL;
+	}
+
+	// Count entry point call
+	RTF_STATS_END(RTF_STATSCALL_OPEN);
+	RTF_TRACE( rtf_trace_end( "rtf_open", &traceStart, 0 ) );
+
+	// Return error flag
+	return error;
+}
+
+
+// Creates new RTF document with deferred header
+int rtf_open_deferred(char* filename, char* fonts, char* colors)
+{
+	// Set error flag
+	int error = RTF_SUCCESS;
+	RTF_STATS_START();
+	RTF_TRACE_START(traceStart);
+
+	// Initialize global params
+	rtf_init();
+	RTF_STATS_ADD( documentCount, 1 );
+
+	// Set RTF document font table
+	if ( fonts != NULL )
+	{
+		if ( strcmp( fonts, "" ) != 0 )
+			rtf_set_fonttable(fonts);
+	}
+
+	// Set RTF document color table
+	if ( colors != NULL )
+	{
+		if ( strcmp( colors, "" ) != 0 )
+			rtf_set_colortable(colors);
+	}
+
+	// RTF document is created at close, body is spooled until then
+	strcpy( rtfFileName, filename );
+	rtfFile = NULL;
+	rtfSpoolSize = 0;
+	rtfDeferred = true;
+
+	// Create first RTF document section with default formatting
+	if ( !rtf_write_sectionformat() )
+		error = RTF_SECTIONFORMAT_ERROR;
+
+	// Count entry point call
+	RTF_STATS_END(RTF_STATSCALL_OPEN);
+	RTF_TRACE( rtf_trace_end( "rtf_open", &traceStart, 0 ) );
+
+	// Return error flag
+	return error;
+}
+
+
+// Closes created RTF document
+int rtf_close()
+{
+	// Set error flag
+	int error = RTF_SUCCESS;
+	RTF_STATS_START();
+	RTF_TRACE_START(traceStart);
+
+	// Free IPicture object
+	if ( rtfPicture != NULL )
+	{
+		rtfPicture->Release();
+		rtfPicture = NULL;
+	}
+
+	// Section index content ends before end part
+	if ( rtfIndex != NULL )
+		rtfIndex->bodyEnd = rtfIndex->writtenSize;
+
+	// Last traced section and table end before end part
+	RTF_TRACE( rtf_trace_endspans(true) );
+
+	// Write RTF document end part
+	char rtfText[1024];
+	strcpy( rtfText, "\n\\par}" );
+	rtf_write_data( rtfText, strlen(rtfText) );
+
+	// Fill reserved table of contents region (it is spliced into spooled body with deferred header)
+	if ( rtfToc.tocReserved && !rtfDeferred && rtf_fill_toc() != RTF_SUCCESS )
+		error = RTF_TOC_ERROR;
+
+	// Write deferred RTF document header and spooled body
+	if ( rtfDeferred )
+	{
+		int deferred = rtf_write_deferred();
+		if ( deferred != RTF_SUCCESS )
+			error = deferred;
+	}
+
+	// Close RTF document
+	if ( rtfFile != NULL )
+	{
+		RTF_STATS_ADD( flushCalls, 1 );
+		RTF_TRACE_START(flushStart);
+		if ( fclose(rtfFile) )
+			error = RTF_CLOSE_ERROR;
+		RTF_TRACE( rtf_trace_end( "flush", &flushStart, 0 ) );
+	}
+	rtfFile = NULL;
+
+	// Close plain text file
+	if ( rtfExtractor != NULL && rtf_close_textfile() != RTF_SUCCESS && error == RTF_SUCCESS )
+		error = RTF_TEXTFILE_ERROR;
+
+	// Write output size analysis report
+	if ( rtfAnalyzer != NULL && rtf_close_analysisfile() != RTF_SUCCESS && error == RTF_SUCCESS )
+		error = RTF_ANALYSIS_ERROR;
+
+	// Write section index file
+	if ( rtfIndex != NULL && rtf_close_indexfile() != RTF_SUCCESS && error == RTF_SUCCESS )
+		error = RTF_INDEX_ERROR;
+
+	// Memory refused by memory budget fails RTF document (it is reported over errors it caused)
+	if ( rtfMemoryRefused )
+		error = RTF_MEMORY_ERROR;
+
+	// Close previous RTF document
+	if ( rtfPrevious != NULL )
+		rtf_free_previous();
+
+	// Release per-document memory (arena blocks are reused by next RTF document)
+	rtf_hash_clear( &rtfFontHash );
+	rtf_hash_clear( &rtfColorHash );
+	rtf_arena_reset( &rtfArena );
+
+	// Lists of next RTF document are added again (they can be added before it is opened)
+	rtfHeaderWritten = false;
+	rtfListCount = 0;
+
+	// Count entry point call
+	RTF_STATS_END(RTF_STATSCALL_CLOSE);
+	RTF_TRACE( rtf_trace_end( "rtf_close", &traceStart, 0 ) );
+
+	// Write trace file
+	if ( rtfTraceEnabled && strcmp( rtfTraceName, "" ) != 0 && rtf_write_trace(rtfTraceName) != RTF_SUCCESS && error == RTF_SUCCESS )
+		error = RTF_TRACE_ERROR;
+
+	// Return error flag
+	return error;
+}
+
+
+// Writes RTF document header
+bool rtf_write_header()
+{
+	// Set error flag
+	bool result = true;
+
+	// Writes standard RTF document header part (font and color table are written directly, they can be large)
+	char rtfText[1024];
+	strcpy( rtfText, "{\\rtf1\\ansi\\ansicpg1252\\deff0{\\fonttbl" );
+	if ( !rtf_write_data( rtfText, strlen(rtfText) ) || !rtf_write_data( rtfFontTable, strlen(rtfFontTable) ) )
+		result = false;
+	strcpy( rtfText, "}{\\colortbl" );
+	if ( !rtf_write_data( rtfText, strlen(rtfText) ) || !rtf_write_data( rtfColorTable, rtfColorTableLength ) )
+		result = false;
+	strcpy( rtfText, "}" );
+	if ( !rtf_write_data( rtfText, strlen(rtfText) ) || !rtf_write_listtable() )
+		result = false;
+	strcpy( rtfText, "{\\*\\generator rtflib ver. 1.0;}" );
+	strcat( rtfText, "\n{\\info{\\author rtflib ver. 1.0}{\\company ETC Company LTD.}}" );
+	if ( !rtf_write_data( rtfText, strlen(rtfText) ) )
+		result = false;
+
+	// Font and color table can not be changed any more
+	rtfHeaderWritten = true;
+
+	// Return error flag
+	return result;
+}
+
+
+// Sets global RTF library params
+void rtf_init()
+{
+	// Add previous RTF document statistics to process-wide statistics
+	rtf_stats_add( &rtfProcessStats, &rtfStats );
+	memset( &rtfStats, 0, sizeof(RTF_STATS) );
+
+	// Reset traced sections and tables
+	memset( &rtfTraceSpans, 0, sizeof(RTF_TRACE_SPANS) );
+
+	// Reset RTF document state
+	rtfHeaderWritten = false;
+	rtfDeferred = false;
+	rtfBinaryFile = false;
+	rtfTextStarted = false;
+	rtfRunStarted = false;
+	memset( &rtfToc, 0, sizeof(RTF_TOC) );
+	strcpy( rtfFileName, "" );
+	strcpy( rtfCheckpointName, "" );
+	rtfMemoryRefused = false;
+	rtf_hash_clear( &rtfFontHash );
+	rtf_hash_clear( &rtfColorHash );
+
+	// Release per-document memory (arena blocks are reused)
+	rtf_arena_reset( &rtfArena );
+
+	// Set RTF document default font table
+	strcpy( rtfFontTable, "" );
+	strcat( rtfFontTable, "{\\f0\\froman\\fcharset0\\cpg1252 Times New Roman}" );
+	strcat( rtfFontTable, "{\\f1\\fswiss\\fcharset0\\cpg1252 Arial}" );
+	strcat( rtfFontTable, "{\\f2\\fmodern\\fcharset0\\cpg1252 Courier New}" );
+	strcat( rtfFontTable, "{\\f3\\fscript\\fcharset0\\cpg1252 Cursive}" );
+	strcat( rtfFontTable, "{\\f4\\fdecor\\fcharset0\\cpg1252 Old English}" );
+	strcat( rtfFontTable, "{\\f5\\ftech\\fcharset0\\cpg1252 Symbol}" );
+	strcat( rtfFontTable, "{\\f6\\fbidi\\fcharset0\\cpg1252 Miriam}" );
+
+	// Set RTF document default color table
+	rtfColorTableLength = 0;
+	rtf_append_colortable( "\\red0\\green0\\blue0;" );
+	rtf_append_colortable( "\\red255\\green0\\blue0;" );
+	rtf_append_colortable( "\\red0\\green255\\blue0;" );
+	rtf_append_colortable( "\\red0\\green0\\blue255;" );
+	rtf_append_colortable( "\\red255\\green255\\blue0;" );
+	rtf_append_colortable( "\\red255\\green0\\blue255;" );
+	rtf_append_colortable( "\\red0\\green255\\blue255;" );
+	rtf_append_colortable( "\\red255\\green255\\blue255;" );
+	rtf_append_colortable( "\\red128\\green0\\blue0;" );
+	rtf_append_colortable( "\\red0\\green128\\blue0;" );
+	rtf_append_colortable( "\\red0\\green0\\blue128;" );
+	rtf_append_colortable( "\\red128\\green128\\blue0;" );
+	rtf_append_colortable( "\\red128\\green0\\blue128;" );
+	rtf_append_colortable( "\\red0\\green128\\blue128;" );
+	rtf_append_colortable( "\\red128\\green128\\blue128;" );
+
+	// Reset quantized color cache (color numbers are per document)
+	if ( rtfColorCache != NULL )
+		memset( rtfColorCache, 0xFF, 32768*sizeof(int) );
+
+	// Reset section index (offsets are per document)
+	if ( rtfIndex != NULL )
+	{
+		rtfIndex->entryCount = 0;
+		rtfIndex->writtenSize = 0;
+		rtfIndex->rowEnd = 0;
+		rtfIndex->bodyEnd = 0;
+		rtfIndex->sectionCount = 0;
+		rtfIndex->tableCount = 0;
+		rtfIndex->rowCount = 0;
+		rtfIndex->paragraphCount = 0;
+		rtfIndex->sectionEntry = 0;
+		rtfIndex->checkpointEntries = 0;
+		rtfIndex->checkpointSection = 0;
+	}
+
+	// Set default formatting
+	rtf_set_defaultformat();
+}
+
+
+// Sets default RTF document formatting
+void rtf_set_defaultformat()
+{
+	// Set default RTF document formatting properties
+	RTF_DOCUMENT_FORMAT df = {RTF_DOCUMENTVIEWKIND_PAGE, 100, 12240, 15840, 1800, 1800, 1440, 1440, false, 0, false};
+	rtf_set_documentformat(&df);
+
+	// Set default RTF section formatting properties
+	RTF_SECTION_FORMAT sf = {RTF_SECTIONBREAK_CONTINUOUS, false, true, 12240, 15840, 1800, 1800, 1440, 1440, 0, 720, 720, false, 720, 720, false, 1, 720, false};
+	rtf_set_sectionformat(&sf);
+
+	// Set default RTF paragraph formatting properties
+	RTF_PARAGRAPH_FORMAT pf = {RTF_PARAGRAPHBREAK_NONE, false, true, RTF_PARAGRAPHALIGN_LEFT, 0, 0, 0, 0, 0, 0, "", false, false, false, false, false, false};
+	pf.BORDERS.borderColor = 0;
+	pf.BORDERS.borderKind = RTF_PARAGRAPHBORDERKIND_NONE;
+	pf.BORDERS.borderSpace = 0;
+	pf.BORDERS.borderType = RTF_PARAGRAPHBORDERTYPE_STHICK;
+	pf.BORDERS.borderWidth = 0;
+	pf.CHARACTER.animatedCharacter = false;
+	pf.CHARACTER.backgroundColor = 0;
+	pf.CHARACTER.boldCharacter = false;
+	pf.CHARACTER.capitalCharacter = false;
+	pf.CHARACTER.doublestrikeCharacter = false;
+	pf.CHARACTER.embossCharacter = false;
+	pf.CHARACTER.engraveCharacter = false;
+	pf.CHARACTER.expandCharacter = 0;
+	pf.CHARACTER.fontNumber = 0;
+	pf.CHARACTER.fontSize = 24;
+	pf.CHARACTER.foregroundColor = 0;
+	pf.CHARACTER.italicCharacter = false;
+	pf.CHARACTER.kerningCharacter = 0;
+	pf.CHARACTER.outlineCharacter = false;
+	pf.CHARACTER.scaleCharacter = 100;
+	pf.CHARACTER.shadowCharacter = false;
+	pf.CHARACTER.smallcapitalCharacter = false;
+	pf.CHARACTER.strikeCharacter = false;
+	pf.CHARACTER.subscriptCharacter = false;
+	pf.CHARACTER.superscriptCharacter = false;
+	pf.CHARACTER.underlineCharacter = 0;
+	pf.NUMS.numsChar = char(0x95);
+	pf.NUMS.numsLevel = 11;
+	pf.NUMS.numsSpace = 360;
+	pf.SHADING.shadingBkColor = 0;
+	pf.SHADING.shadingFillColor = 0;
+	pf.SHADING.shadingIntensity = 0;
+	pf.SHADING.shadingType = RTF_PARAGRAPHSHADINGTYPE_FILL;
+	pf.TABS.tabKind = RTF_PARAGRAPHTABKIND_NONE;
+	pf.TABS.tabLead = RTF_PARAGRAPHTABLEAD_NONE;
+	pf.TABS.tabPosition = 0;
+	rtf_set_paragraphformat(&pf);
+
+	// Set default RTF table row formatting properties
+	RTF_TABLEROW_FORMAT rf = {RTF_ROWTEXTALIGN_LEFT, 0, 0, 0, 0, 0, 0};
+	rtf_set_tablerowformat(&rf);
+
+	// Set default RTF table cell formatting properties
+	RTF_TABLECELL_FORMAT cf = {RTF_CELLTEXTALIGN_CENTER, 0, 0, 0, 0, RTF_CELLTEXTDIRECTION_LRTB, false};
+	cf.SHADING.shadingBkColor = 0;
+	cf.SHADING.shadingFillColor = 0;
+	cf.SHADING.shadingIntensity = 0;
+	cf.SHADING.shadingType = RTF_PARAGRAPHSHADINGTYPE_FILL;
+	cf.borderBottom.border = false;
+	cf.borderBottom.BORDERS.borderColor = 0;
+	cf.borderBottom.BORDERS.borderKind = RTF_PARAGRAPHBORDERKIND_NONE;
+	cf.borderBottom.BORDERS.borderSpace = 0;
+	cf.borderBottom.BORDERS.borderType = RTF_PARAGRAPHBORDERTYPE_STHICK;
+	cf.borderBottom.BORDERS.borderWidth = 5;
+	cf.borderLeft.border = false;
+	cf.borderLeft.BORDERS.borderColor = 0;
+	cf.borderLeft.BORDERS.borderKind = RTF_PARAGRAPHBORDERKIND_NONE;
+	cf.borderLeft.BORDERS.borderSpace = 0;
+	cf.borderLeft.BORDERS.borderType = RTF_PARAGRAPHBORDERTYPE_STHICK;
+	cf.borderLeft.BORDERS.borderWidth = 5;
+	cf.borderRight.border = false;
+	cf.borderRight.BORDERS.borderColor = 0;
+	cf.borderRight.BORDERS.borderKind = RTF_PARAGRAPHBORDERKIND_NONE;
+	cf.borderRight.BORDERS.borderSpace = 0;
+	cf.borderRight.BORDERS.borderType = RTF_PARAGRAPHBORDERTYPE_STHICK;
+	cf.borderRight.BORDERS.borderWidth = 5;
+	cf.borderTop.border = false;
+	cf.borderTop.BORDERS.borderColor = 0;
+	cf.borderTop.BORDERS.borderKind = RTF_PARAGRAPHBORDERKIND_NONE;
+	cf.borderTop.BORDERS.borderSpace = 0;
+	cf.borderTop.BORDERS.borderType = RTF_PARAGRAPHBORDERTYPE_STHICK;
+	cf.borderTop.BORDERS.borderWidth = 5;
+	rtf_set_tablecellformat(&cf);
+}
+
+
+// Sets new RTF document font table
+void rtf_set_fonttable( char* fonts )
+{
+	// Clear old font table
+	strcpy( rtfFontTable, "" );
+	rtf_hash_clear( &rtfFontHash );
+
+	// Set separator list
+	char separator[] = ";";
+
+	// Create new RTF document font table
+	int font_number = 0;
+	char font_table_entry[1024];
+	char* token = strtok( fonts, separator );
+ 	while ( token != NULL )
+	{
+		// Format font table entry
+		sprintf( font_table_entry, "{\\f%d\\fnil\\fcharset0\\cpg1252 %s}", font_number, token );
+		strcat( rtfFontTable, font_table_entry );
+
+		// Get next font
+		token = strtok( NULL, separator );
+		font_number++;
+	}
+}
+
+
+// Sets new RTF document color table
+void rtf_set_colortable(char* colors)
+{
+	// Clear old color table
+	rtfColorTableLength = 0;
+	rtf_append_colortable( "" );
+	rtf_hash_clear( &rtfColorHash );
+
+	// Set separator list
+	char separator[] = ";";
+
+	// Create new RTF document color table
+	int color_number = 0;
+	char color_table_entry[1024];
+	char* token = strtok( colors, separator );
+ 	while ( token != NULL )
+	{
+		// Red
+		sprintf( color_table_entry, "\\red%s", token );
+		rtf_append_colortable( color_table_entry );
+
+		// Green
+		token = strtok( NULL, separator );
+		if ( token != NULL )
+		{
+			sprintf( color_table_entry, "\\green%s", token );
+			rtf_append_colortable( color_table_entry );
+		}
+
+		// Blue
+		token = strtok( NULL, separator );
+		if ( token != NULL )
+		{
+			sprintf( color_table_entry, "\\blue%s;", token );
+			rtf_append_colortable( color_table_entry );
+		}
+
+		// Get next color
+		token = strtok( NULL, separator );
+		color_number++;
+	}
+}
+
+
+// Adds font to RTF document font table
+int rtf_add_font(char* name, int family, int charset)
+{
+	// Font family names
+	static char* families[] = { "fnil", "froman", "fswiss", "fmodern", "fscript", "fdecor", "ftech", "fbidi" };
+	if ( family < RTF_FONTFAMILY_NIL || family > RTF_FONTFAMILY_BIDI )
+		family = RTF_FONTFAMILY_NIL;
+
+	// Register existing font table entries
+	if ( rtfFontHash.entryCount == 0 )
+		rtfFontCount = rtf_register_table( rtfFontTable, &rtfFontHash, true );
+
+	// Find font in font table
+	char key[1024];
+	sprintf( key, "\\%s\\fcharset%d\\cpg1252 %s", families[family], charset, name );
+	int index = rtf_hash_find( &rtfFontHash, key );
+	if ( index >= 0 )
+	{
+		RTF_STATS_ADD( cacheHits, 1 );
+		return index;
+	}
+	RTF_STATS_ADD( cacheMisses, 1 );
+
+	// Font table is already written
+	if ( rtfHeaderWritten )
+		return -1;
+
+	// Append font table entry
+	char font_table_entry[1024];
+	sprintf( font_table_entry, "{\\f%d%s}", rtfFontCount, key );
+	if ( strlen(rtfFontTable) + strlen(font_table_entry) >= sizeof(rtfFontTable) || !rtf_hash_insert( &rtfFontHash, key, rtfFontCount ) )
+		return -1;
+	strcat( rtfFontTable, font_table_entry );
+
+	return rtfFontCount++;
+}
+
+
+// Adds color to RTF document color table
+int rtf_add_color(int red, int green, int blue)
+{
+	// Color channels are 0-255 (also bounds quantized color cache index)
+	red = ( red < 0 ? 0 : ( red > 255 ? 255 : red ) );
+	green = ( green < 0 ? 0 : ( green > 255 ? 255 : green ) );
+	blue = ( blue < 0 ? 0 : ( blue > 255 ? 255 : blue ) );
+
+	// Map color to bounded palette
+	int cacheIndex = -1;
+	if ( rtfColorLevels > 0 )
+	{
+		// Quantized colors are cached by 15-bit RGB value (cache is skipped if memory budget refused it)
+		cacheIndex = ( (red >> 3) << 10 ) | ( (green >> 3) << 5 ) | ( blue >> 3 );
+		if ( rtfColorCache != NULL && rtfColorCache[cacheIndex] >= 0 )
+		{
+			RTF_STATS_ADD( cacheHits, 1 );
+			return rtfColorCache[cacheIndex];
+		}
+
+		// Quantize 15-bit RGB cell center to nearest palette level
+		int steps = rtfColorLevels - 1;
+		red = ( ( ( (red >> 3) << 3 ) + 4 ) * steps + 127 ) / 255 * 255 / steps;
+		green = ( ( ( (green >> 3) << 3 ) + 4 ) * steps + 127 ) / 255 * 255 / steps;
+		blue = ( ( ( (blue >> 3) << 3 ) + 4 ) * steps + 127 ) / 255 * 255 / steps;
+	}
+
+	// Register existing color table entries
+	if ( rtfColorHash.entryCount == 0 )
+		rtfColorCount = rtf_register_table( rtfColorTable, &rtfColorHash, false );
+
+	// Find color in color table
+	char key[100];
+	sprintf( key, "\\red%d\\green%d\\blue%d", red, green, blue );
+	int index = rtf_hash_find( &rtfColorHash, key );
+	if ( index >= 0 )
+		RTF_STATS_ADD( cacheHits, 1 );
+	else
+	{
+		RTF_STATS_ADD( cacheMisses, 1 );
+
+		// Color table is already written
+		if ( rtfHeaderWritten )
+			return -1;
+
+		// Append color table entry (entry refused by memory budget is removed again)
+		size_t length = rtfColorTableLength;
+		if ( !rtf_append_colortable( key ) || !rtf_append_colortable( ";" ) || !rtf_hash_insert( &rtfColorHash, key, rtfColorCount ) )
+		{
+			rtfColorTableLength = length;
+			if ( rtfColorTable != NULL )
+				rtfColorTable[length] = '\0';
+			return -1;
+		}
+		index = rtfColorCount++;
+	}
+
+	// Cache quantized color
+	if ( cacheIndex >= 0 && rtfColorCache != NULL )
+		rtfColorCache[cacheIndex] = index;
+
+	return index;
+}
+
+
+// Appends text to RTF document color table
+bool rtf_append_colortable(const char* text)
+{
+	size_t length = strlen(text);
+
+	// Grow color table (color table refused by memory budget is not changed)
+	if ( rtfColorTableLength + length + 1 > rtfColorTableSize )
+	{
+		size_t size = 2*rtfColorTableSize + length + 4096;
+		if ( !rtf_memory_reserve( RTF_MEMORY_TABLES, size, true ) )
+			return false;
+		char* table = new char[size];
+		RTF_STATS_ADD( allocationCount, 1 );
+		memcpy( table, rtfColorTable, rtfColorTableLength );
+		delete []rtfColorTable;
+		rtf_memory_release( RTF_MEMORY_TABLES, rtfColorTableSize );
+		rtfColorTable = table;
+		rtfColorTableSize = size;
+	}
+
+	// Append text
+	memcpy( rtfColorTable + rtfColorTableLength, text, length + 1 );
+	rtfColorTableLength += length;
+
+	return true;
+}
+
+
+// Adds list to RTF document list table
+int rtf_add_list(RTF_NUMS_FORMAT* nums)
+{
+	// Lists differ by bullet or number, bullet char and text distance (levels share list)
+	bool bullet = ( nums->numsLevel == RTF_LIST_BULLETLEVEL );
+	for ( int i=0; i<rtfListCount; i++ )
+	{
+		RTF_NUMS_FORMAT* list = &rtfLists[i];
+		if ( ( list->numsLevel == RTF_LIST_BULLETLEVEL ) == bullet && list->numsChar == nums->numsChar && list->numsSpace == nums->numsSpace )
+			return i+1;
+	}
+
+	// List table is already written or full
+	if ( rtfHeaderWritten || rtfListCount == RTF_LIST_MAXCOUNT )
+		return -1;
+
+	// Append list table entry
+	rtfLists[rtfListCount] = *nums;
+	return ++rtfListCount;
+}
+
+
+// Writes RTF document list and list override tables
+bool rtf_write_listtable()
+{
+	// Set error flag
+	bool result = true;
+	if ( rtfListCount == 0 )
+		return result;
+
+	// Write list definitions (each list has all levels, bullet lists show bullet char, numbered lists show char and number)
+	char rtfText[1024];
+	strcpy( rtfText, "\n{\\*\\listtable" );
+	if ( !rtf_write_data( rtfText, strlen(rtfText) ) )
+		result = false;
+	int i;
+	for ( i=0; i<rtfListCount; i++ )
+	{
+		RTF_NUMS_FORMAT* list = &rtfLists[i];
+		bool bullet = ( list->numsLevel == RTF_LIST_BULLETLEVEL );
+		sprintf( rtfText, "{\\list\\listtemplateid%d", i+1 );
+		if ( !rtf_write_data( rtfText, strlen(rtfText) ) )
+			result = false;
+		for ( int level=0; level<RTF_LIST_LEVELS; level++ )
+		{
+			if ( bullet )
+				sprintf( rtfText, "{\\listlevel\\levelnfc23\\leveljc0\\levelfollow0\\levelstartat1{\\leveltext\\'01\\'%02x;}{\\levelnumbers;}\\fi-%d\\li%d}",
+					(unsigned char)list->numsChar, list->numsSpace, (level+1)*list->numsSpace );
+			else
+				sprintf( rtfText, "{\\listlevel\\levelnfc0\\leveljc0\\levelfollow0\\levelstartat1{\\leveltext\\'02\\'%02x\\'%02x;}{\\levelnumbers\\'02;}\\fi-%d\\li%d}",
+					(unsigned char)list->numsChar, level, list->numsSpace, (level+1)*list->numsSpace );
+			if ( !rtf_write_data( rtfText, strlen(rtfText) ) )
+				result = false;
+		}
+		sprintf( rtfText, "\\listid%d}", i+1 );
+		if ( !rtf_write_data( rtfText, strlen(rtfText) ) )
+			result = false;
+	}
+
+	// Write list overrides (list override N refers to list N)
+	strcpy( rtfText, "}\n{\\*\\listoverridetable" );
+	if ( !rtf_write_data( rtfText, strlen(rtfText) ) )
+		result = false;
+	for ( i=0; i<rtfListCount; i++ )
+	{
+		sprintf( rtfText, "{\\listoverride\\listid%d\\listoverridecount0\\ls%d}", i+1, i+1 );
+		if ( !rtf_write_data( rtfText, strlen(rtfText) ) )
+			result = false;
+	}
+	strcpy( rtfText, "}" );
+	if ( !rtf_write_data( rtfText, strlen(rtfText) ) )
+		result = false;
+
+	// Return error flag
+	return result;
+}
+
+
+// Sets RTF document color quantization
+void rtf_set_colorquantization(int palette_size)
+{
+	// Colors are quantized to uniform levels per channel (levels^3 <= palette size, palette size 1-7 is rounded up to 8)
+	rtfColorLevels = 0;
+	if ( palette_size > 0 )
+	{
+		rtfColorLevels = 2;
+		while ( (rtfColorLevels+1)*(rtfColorLevels+1)*(rtfColorLevels+1) <= palette_size && rtfColorLevels < 32 )
+			rtfColorLevels++;
+
+		// Create quantized color cache (colors are quantized without cache over memory budget)
+		if ( rtfColorCache == NULL && rtf_memory_reserve( RTF_MEMORY_CACHE, 32768*sizeof(int), false ) )
+			rtfColorCache = new int[32768];
+		if ( rtfColorCache != NULL )
+			memset( rtfColorCache, 0xFF, 32768*sizeof(int) );
+	}
+}
+
+
+// Registers font or color table entries
+int rtf_register_table(char* table, RTF_HASH_TABLE* hash, bool fonts)
+{
+	int count = 0;
+	char key[1024];
+
+	// Color table refused by memory budget is not allocated
+	char* entry = ( table != NULL ? table : (char*)"" );
+	while ( *entry != '\0' )
+	{
+		char* end = NULL;
+		if ( fonts )
+		{
+			// Font entry key is text after "{\fN" up to "}"
+			end = strchr( entry, '}' );
+			if ( end == NULL || *entry != '{' )
+				break;
+			char* start = entry + 1;
+			if ( strncmp( start, "\\f", 2 ) == 0 )
+			{
+				start += 2;
+				while ( *start >= '0' && *start <= '9' )
+					start++;
+			}
+			int length = end - start;
+			if ( length >= (int)sizeof(key) )
+				length = sizeof(key) - 1;
+			strncpy( key, start, length );
+			key[length] = '\0';
+		}
+		else
+		{
+			// Color entry key is text up to ";"
+			end = strchr( entry, ';' );
+			if ( end == NULL )
+				break;
+			int length = end - entry;
+			if ( length >= (int)sizeof(key) )
+				length = sizeof(key) - 1;
+			strncpy( key, entry, length );
+			key[length] = '\0';
+		}
+
+		// First entry wins for duplicated keys
+		if ( rtf_hash_find( hash, key ) < 0 )
+			rtf_hash_insert( hash, key, count );
+		count++;
+		entry = end + 1;
+	}
+
+	return count;
+}
+
+
+// Reads font or color table from RTF document header
+bool rtf_read_table(char* header, char* name, char* table, int size)
+{
+	// Find table group
+	char* start = strstr( header, name );
+	if ( start == NULL )
+		return false;
+	start += strlen(name);
+
+	// Find end of table group
+	int depth = 0, length = 0;
+	while ( start[length] != '\0' )
+	{
+		if ( start[length] == '\\' && start[length+1] != '\0' )
+			length++;
+		else if ( start[length] == '{' )
+			depth++;
+		else if ( start[length] == '}' )
+		{
+			if ( depth == 0 )
+				break;
+			depth--;
+		}
+		length++;
+	}
+
+	// Copy table group content
+	if ( start[length] != '}' || length >= size )
+		return false;
+	strncpy( table, start, length );
+	table[length] = '\0';
+
+	return true;
+}
+
+
+// Sets RTF document formatting properties
+void rtf_set_documentformat(RTF_DOCUMENT_FORMAT* df)
+{
+	// Set new RTF document formatting properties
+	memcpy( &rtfDocFormat, df, sizeof(RTF_DOCUMENT_FORMAT) );
+}
+
+
+// Writes RTF document formatting properties
+bool rtf_write_documentformat()
+{
+	// Set error flag
+	bool result = true;
+
+	// RTF document text
+	char rtfText[1024];
+	strcpy( rtfText, "" );
+
+	sprintf( rtfText, "\\viewkind%d\\viewscale%d\\paperw%d\\paperh%d\\margl%d\\margr%d\\margt%d\\margb%d\\gutter%d", 
+		rtfDocFormat.viewKind, rtfDocFormat.viewScale, rtfDocFormat.paperWidth, rtfDocFormat.paperHeight,
+		rtfDocFormat.marginLeft, rtfDocFormat.marginRight, rtfDocFormat.marginTop, rtfDocFormat.marginBottom, rtfDocFormat.gutterWidth );
+
+	if ( rtfDocFormat.facingPages )
+		strcat( rtfText, "\\facingp" );
+	if ( rtfDocFormat.readOnly )
+		strcat( rtfText, "\\annotprot" );
+
+	// Writes RTF document formatting properties
+	if ( !rtf_write_data( rtfText, strlen(rtfText) ) )
+		result = false;
+
+	// Return error flag
+	return result;
+}
+
+
+// Sets RTF section formatting properties
+void rtf_set_sectionformat(RTF_SECTION_FORMAT* sf)
+{
+	// Set new RTF section formatting properties
+	memcpy( &rtfSecFormat, sf, sizeof(RTF_SECTION_FORMAT) );
+}
+
+
+// Writes RTF section formatting properties
+bool rtf_write_sectionformat()
+{
+	// Set error flag
+	bool result = true;
+	RTF_STATS_ADD( sectionCount, 1 );
+	RTF_TRACE( rtf_trace_section() );
+
+	// RTF document text
+	char rtfText[1024];
+	strcpy( rtfText, "" );
+
+	// Write section break first (section index entry starts after it)
+	ULONGLONG breakStart = ( rtfIndex != NULL ? rtfIndex->writtenSize : 0 );
+	if ( rtfSecFormat.newSection )
+	{
+		strcpy( rtfText, "\n\\sect" );
+		if ( !rtf_write_data( rtfText, strlen(rtfText) ) )
+			result = false;
+	}
+	rtf_index_add( RTF_INDEXENTRY_SECTION, breakStart );
+
+	// Format new section
+	char text[1024]="", pgn[100]="";
+	if ( !rtfSecFormat.newSection )
+		strcat( text, "\n" );
+	if ( rtfSecFormat.defaultSection )
+		strcat( text, "\\sectd" );
+	if ( rtfSecFormat.showPageNumber )
+	{
+		sprintf( pgn, "\\pgnx%d\\pgny%d", rtfSecFormat.pageNumberOffsetX, rtfSecFormat.pageNumberOffsetY );
+		strcat( text, pgn );
+	}
+	
+	// Format section break
+	char sbr[100] = "";
+	switch (rtfSecFormat.sectionBreak)
+	{
+		// Continuous break
+		case RTF_SECTIONBREAK_CONTINUOUS:
+			strcat( sbr, "\\sbknone" );
+			break;
+
+		// Column break
+		case RTF_SECTIONBREAK_COLUMN:
+			strcat( sbr, "\\sbkcol" );
+			break;
+
+		// Page break
+		case RTF_SECTIONBREAK_PAGE:
+			strcat( sbr, "\\sbkpage" );
+			break;
+
+		// Even-page break
+		case RTF_SECTIONBREAK_EVENPAGE:
+			strcat( sbr, "\\sbkeven" );
+			break;
+
+		// Odd-page break
+		case RTF_SECTIONBREAK_ODDPAGE:
+			strcat( sbr, "\\sbkodd" );
+			break;
+	}
+
+	// Format section columns
+	char cols[100] = "";
+	if ( rtfSecFormat.cols == true )
+	{
+		// Format columns
+		sprintf( cols, "\\cols%d\\colsx%d", rtfSecFormat.colsNumber, rtfSecFormat.colsDistance );
+
+		if ( rtfSecFormat.colsLineBetween )
+			strcat( cols, "\\linebetcol" );
+	}
+
+	sprintf( rtfText, "%s%s%s\\pgwsxn%d\\pghsxn%d\\marglsxn%d\\margrsxn%d\\margtsxn%d\\margbsxn%d\\guttersxn%d\\headery%d\\footery%d", 
+		text, sbr, cols, rtfSecFormat.pageWidth, rtfSecFormat.pageHeight, rtfSecFormat.pageMarginLeft, rtfSecFormat.pageMarginRight,
+		rtfSecFormat.pageMarginTop, rtfSecFormat.pageMarginBottom, rtfSecFormat.pageGutterWidth, rtfSecFormat.pageHeaderOffset, rtfSecFormat.pageFooterOffset );
+
+	// Writes RTF section formatting properties
+	if ( !rtf_write_data( rtfText, strlen(rtfText) ) )
+		result = false;
+
+	// Section content starts after section formatting
+	if ( rtfIndex != NULL )
+	{
+		RTF_INDEX_ENTRY* entry = &rtfIndex->indexEntries[rtfIndex->sectionEntry];
+		entry->formatSize = (int)( rtfIndex->writtenSize - entry->entryOffset );
+	}
+
+	// Return error flag
+	return result;
+}
+
+
+// Starts new RTF section
+int rtf_start_section()
+{
+	// Set error flag
+	int error = RTF_SUCCESS;
+	RTF_STATS_START();
+
+	// Set new section flag
+	rtfSecFormat.newSection = true;
+
+	// Starts new RTF section
+	if( !rtf_write_sectionformat() )
+		error = RTF_SECTIONFORMAT_ERROR;
+
+	// Count entry point call
+	RTF_STATS_END(RTF_STATSCALL_SECTION);
+
+	// Return error flag
+	return error;
+}
+
+
+// Sets RTF paragraph formatting properties
+void rtf_set_paragraphformat(RTF_PARAGRAPH_FORMAT* pf)
+{
+	// Set new RTF paragraph formatting properties
+	memcpy( &rtfParFormat, pf, sizeof(RTF_PARAGRAPH_FORMAT) );
+}
+
+
+// Writes RTF paragraph formatting properties
+bool rtf_write_paragraphformat()
+{
+	// Set error flag
+	bool result = true;
+
+	// RTF document text
+	char rtfText[4096];
+	strcpy( rtfText, "" );
+
+	// Count paragraphs for section index
+	if ( rtfIndex != NULL )
+		rtfIndex->paragraphCount++;
+
+	// Format new paragraph
+	char text[1024] = "";
+	if ( rtfParFormat.newParagraph )
+		strcat( text, "\\par" );
+	if ( rtfParFormat.defaultParagraph )
+		strcat( text, "\\pard" );
+	if ( rtfParFormat.tableText == false )
+		strcat( text, "\\plain" );
+	else
+		strcat( text, "\\intbl" );
+	
+	switch (rtfParFormat.paragraphBreak)
+	{
+		// No break
+		case RTF_PARAGRAPHBREAK_NONE:
+			break;
+
+		// Page break;
+		case RTF_PARAGRAPHBREAK_PAGE:
+			strcat( text, "\\page" );
+			break;
+
+		// Column break;
+		case RTF_PARAGRAPHBREAK_COLUMN:
+			strcat( text, "\\column" );
+			break;
+
+		// Line break;
+		case RTF_PARAGRAPHBREAK_LINE:
+			strcat( text, "\\line" );
+			break;
+	}
+
+	// Format aligment
+	switch (rtfParFormat.paragraphAligment)
+	{
+		// Left aligned paragraph
+		case RTF_PARAGRAPHALIGN_LEFT:
+			strcat( text, "\\ql" );
+			break;
+
+		// Center aligned paragraph
+		case RTF_PARAGRAPHALIGN_CENTER:
+			strcat( text, "\\qc" );
+			break;
+
+		// Right aligned paragraph
+		case RTF_PARAGRAPHALIGN_RIGHT:
+			strcat( text, "\\qr" );
+			break;
+
+		// Justified aligned paragraph
+		case RTF_PARAGRAPHALIGN_JUSTIFY:
+			strcat( text, "\\qj" );
+			break;
+	}
+
+	// Format tabs
+	if ( rtfParFormat.paragraphTabs == true )
+	{
+		// Set tab kind
+		switch ( rtfParFormat.TABS.tabKind )
+		{
+			// No tab
+			case RTF_PARAGRAPHTABKIND_NONE:
+				break;
+
+			// Centered tab
+			case RTF_PARAGRAPHTABKIND_CENTER:
+				strcat( text, "\\tqc" );
+				break;
+
+			// Flush-right tab
+			case RTF_PARAGRAPHTABKIND_RIGHT:
+				strcat( text, "\\tqr" );
+				break;
+
+			// Decimal tab
+			case RTF_PARAGRAPHTABKIND_DECIMAL:
+				strcat( text, "\\tqdec" );
+				break;
+		}
+
+		// Set tab leader
+		switch ( rtfParFormat.TABS.tabLead )
+		{
+			// No lead
+			case RTF_PARAGRAPHTABLEAD_NONE:
+				break;
+
+			// Leader dots
+			case RTF_PARAGRAPHTABLEAD_DOT:
+				strcat( text, "\\tldot" );
+				break;
+
+			// Leader middle dots
+			case RTF_PARAGRAPHTABLEAD_MDOT:
+				strcat( text, "\\tlmdot" );
+				break;
+
+			// Leader hyphens
+			case RTF_PARAGRAPHTABLEAD_HYPH:
+				strcat( text, "\\tlhyph" );
+				break;
+
+			// Leader underline
+			case RTF_PARAGRAPHTABLEAD_UNDERLINE:
+				strcat( text, "\\tlul" );
+				break;
+
+			// Leader thick line
+			case RTF_PARAGRAPHTABLEAD_THICKLINE:
+				strcat( text, "\\tlth" );
+				break;
+
+			// Leader equal sign
+			case RTF_PARAGRAPHTABLEAD_EQUAL:
+				strcat( text, "\\tleq" );
+				break;
+		}
+
+		// Set tab position
+		char tb[10];
+		sprintf( tb, "\\tx%d", rtfParFormat.TABS.tabPosition );
+		strcat( text, tb );
+	}
+
+	// Format bullets and numbering
+	if ( rtfParFormat.paragraphNums == true )
+	{
+		// Numbered paragraphs refer to list table (lists can not be added after header is written)
+		char nums[1024];
+		int list = rtf_add_list( &rtfParFormat.NUMS );
+		int level = ( rtfListLevel > 0 ? rtfListLevel : rtfParFormat.NUMS.numsLevel );
+		if ( list > 0 )
+			sprintf( nums, "\\ls%d\\ilvl%d", list, ( level >= 1 && level <= RTF_LIST_LEVELS ? level-1 : 0 ) );
+		else
+			sprintf( nums, "{\\*\\pn\\pnlvl%d\\pnsp%d\\pntxtb %c}", rtfParFormat.NUMS.numsLevel, rtfParFormat.NUMS.numsSpace, rtfParFormat.NUMS.numsChar );
+		strcat( text, nums );
+	}
+
+	// Format paragraph borders
+	if ( rtfParFormat.paragraphBorders == true )
+	{
+		char border[1024] = "";
+
+		// Format paragraph border kind
+		switch (rtfParFormat.BORDERS.borderKind)
+		{
+			// No border
+			case RTF_PARAGRAPHBORDERKIND_NONE:
+				break;
+
+			// Border top
+			case RTF_PARAGRAPHBORDERKIND_TOP:
+				strcat( border, "\\brdrt" );
+				break;
+
+			// Border bottom
+			case RTF_PARAGRAPHBORDERKIND_BOTTOM:
+				strcat( border, "\\brdrb" );
+				break;
+
+			// Border left
+			case RTF_PARAGRAPHBORDERKIND_LEFT:
+				strcat( border, "\\brdrl" );
+				break;
+
+			// Border right
+			case RTF_PARAGRAPHBORDERKIND_RIGHT:
+				strcat( border, "\\brdrr" );
+				break;
+
+			// Border box
+			case RTF_PARAGRAPHBORDERKIND_BOX:
+				strcat( border, "\\box" );
+				break;
+		}
+
+		// Format paragraph border type
+		const char* br = rtf_get_bordername(rtfParFormat.BORDERS.borderType);
+		strcat( border, br );
+
+		// Set paragraph border width
+		char brd[100];
+		sprintf( brd, "\\brdrw%d\\brsp%d", rtfParFormat.BORDERS.borderWidth, rtfParFormat.BORDERS.borderSpace );
+		strcat( border, brd );
+		strcat( text, border );
+
+		// Set paragraph border color
+		char brdcol[100];
+		sprintf( brdcol, "\\brdrcf%d", rtfParFormat.BORDERS.borderColor );
+		strcat( text, brdcol );
+	}
+
+	// Format paragraph shading
+	if ( rtfParFormat.paragraphShading == true )
+	{
+		char shading[100];
+		sprintf( shading, "\\shading%d", rtfParFormat.SHADING.shadingIntensity );
+
+		// Format paragraph shading
+		const char* sh = rtf_get_shadingname( rtfParFormat.SHADING.shadingType, false );
+		strcat( text, sh );
+
+		// Set paragraph shading color
+		char shcol[100];
+		sprintf( shcol, "\\cfpat%d\\cbpat%d", rtfParFormat.SHADING.shadingFillColor, rtfParFormat.SHADING.shadingBkColor );
+		strcat( text, shcol );
+	}
+
+	// Format paragraph font
+	char font[1024] = "";
+	sprintf( font, "\\animtext%d\\expndtw%d\\kerning%d\\charscalex%d\\f%d\\fs%d\\cf%d", rtfParFormat.CHARACTER.animatedCharacter, 
+		rtfParFormat.CHARACTER.expandCharacter, rtfParFormat.CHARACTER.kerningCharacter, rtfParFormat.CHARACTER.scaleCharacter, 
+		rtfParFormat.CHARACTER.fontNumber, rtfParFormat.CHARACTER.fontSize, rtfParFormat.CHARACTER.foregroundColor );
+	if ( rtfParFormat.CHARACTER.boldCharacter )
+		strcat( font, "\\b" );
+	else
+		strcat( font, "\\b0" );
+	if ( rtfParFormat.CHARACTER.capitalCharacter )
+		strcat( font, "\\caps" );
+	else
+		strcat( font, "\\caps0" );
+	if ( rtfParFormat.CHARACTER.doublestrikeCharacter )
+		strcat( font, "\\striked1" );
+	else
+		strcat( font, "\\striked0" );
+	if ( rtfParFormat.CHARACTER.embossCharacter )
+		strcat( font, "\\embo" );
+	if ( rtfParFormat.CHARACTER.engraveCharacter )
+		strcat( font, "\\impr" );
+	if ( rtfParFormat.CHARACTER.italicCharacter )
+		strcat( font, "\\i" );
+	else
+		strcat( font, "\\i0" );
+	if ( rtfParFormat.CHARACTER.outlineCharacter )
+		strcat( font, "\\outl" );
+	else
+		strcat( font, "\\outl0" );
+	if ( rtfParFormat.CHARACTER.shadowCharacter )
+		strcat( font, "\\shad" );
+	else
+		strcat( font, "\\shad0" );
+	if ( rtfParFormat.CHARACTER.smallcapitalCharacter )
+		strcat( font, "\\scaps" );
+	else
+		strcat( font, "\\scaps0" );
+	if ( rtfParFormat.CHARACTER.strikeCharacter )
+		strcat( font, "\\strike" );
+	else
+		strcat( font, "\\strike0" );
+	if ( rtfParFormat.CHARACTER.subscriptCharacter )
+		strcat( font, "\\sub" );
+	if ( rtfParFormat.CHARACTER.superscriptCharacter )
+		strcat( font, "\\super" );
+	
+	// Format text underline
+	const char* ul = rtf_get_underlinename( rtfParFormat.CHARACTER.underlineCharacter );
+	strcat( font, ul );
+
+	char txt[20] = "";
+	RTF_STATS_ADD( paragraphCount, 1 );
+	size_t length = strlen(rtfParFormat.paragraphText);
+	RTF_STATS_ADD( textBytes, length );
+	// Set paragraph tabbed text
+	if ( rtfParFormat.tabbedText == false )
+	{
+		sprintf( rtfText, "\n%s\\fi%d\\li%d\\ri%d\\sb%d\\sa%d\\sl%d%s ", text, 
+			rtfParFormat.firstLineIndent, rtfParFormat.leftIndent, rtfParFormat.rightIndent, rtfParFormat.spaceBefore, 
+			rtfParFormat.spaceAfter, rtfParFormat.lineSpacing, font );
+	}
+	else
+		strcpy( rtfText, "\\tab " );
+
+	// Writes RTF paragraph formatting properties
+	if ( !rtf_write_data( rtfText, strlen(rtfText) ) )
+		result = false;
+
+	// Writes paragraph text (it can be longer than formatting buffer)
+	if ( length > 0 && !rtf_write_data( rtfParFormat.paragraphText, length ) )
+		result = false;
+
+	// Return error flag
+	return result;
+}
+
+
+// Starts new RTF paragraph
+int rtf_start_paragraph(char* text, bool newPar)
+{
+	// Set error flag
+	int error = RTF_SUCCESS;
+	RTF_STATS_START();
+
+	// Paragraph text is written from caller memory (it is not kept after paragraph is written)
+	rtfParFormat.paragraphText = text;
+
+	// Set new paragraph
+	rtfParFormat.newParagraph = newPar;
+
+	// Starts new RTF paragraph
+	if( !rtf_write_paragraphformat() )
+		error = RTF_PARAGRAPHFORMAT_ERROR;
+	rtfParFormat.paragraphText = "";
+
+	// Count entry point call
+	RTF_STATS_END(RTF_STATSCALL_PARAGRAPH);
+
+	// Return error flag
+	return error;
+}
+
+
+// Starts new RTF paragraph with escaped text of given length
+int rtf_start_paragraph_n(const char* text, size_t size, bool newPar)
+{
+	// Set error flag
+	int error = RTF_SUCCESS;
+	RTF_STATS_START();
+
+	// Starts new RTF paragraph without text
+	rtfParFormat.paragraphText = "";
+	rtfParFormat.newParagraph = newPar;
+	if( !rtf_write_paragraphformat() )
+		error = RTF_PARAGRAPHFORMAT_ERROR;
+
+	// Write escaped text from caller memory
+	if ( !rtf_write_escaped( text, size, RTF_FIELDTYPE_TEXT ) && error == RTF_SUCCESS )
+		error = RTF_TEXT_ERROR;
+
+	// Count entry point call
+	RTF_STATS_END(RTF_STATSCALL_PARAGRAPH);
+
+	// Return error flag
+	return error;
+}
+
+
+// Starts new RTF paragraph with text appended in chunks
+int rtf_begin_text(bool newPar)
+{
+	// Set error flag
+	int error = RTF_SUCCESS;
+	RTF_STATS_START();
+
+	// Starts new RTF paragraph without text
+	rtfParFormat.paragraphText = "";
+	rtfParFormat.newParagraph = newPar;
+	if( !rtf_write_paragraphformat() )
+		error = RTF_PARAGRAPHFORMAT_ERROR;
+	rtfTextStarted = true;
+
+	// Count entry point call
+	RTF_STATS_END(RTF_STATSCALL_PARAGRAPH);
+
+	// Return error flag
+	return error;
+}
+
+
+// Appends text chunk to RTF paragraph
+int rtf_append_text(const char* text, size_t size)
+{
+	// Paragraph text must be started
+	if ( !rtfTextStarted )
+		return RTF_TEXT_ERROR;
+
+	// Write escaped text chunk (memory use does not depend on paragraph length)
+	if ( !rtf_write_escaped( text, size, RTF_FIELDTYPE_TEXT ) )
+		return RTF_TEXT_ERROR;
+
+	// Return error flag
+	return RTF_SUCCESS;
+}
+
+
+// Ends RTF paragraph text appended in chunks
+int rtf_end_text()
+{
+	// Paragraph text must be started
+	if ( !rtfTextStarted )
+		return RTF_TEXT_ERROR;
+	rtfTextStarted = false;
+
+	// Return error flag
+	return RTF_SUCCESS;
+}
+
+
+// Writes escaped text to current RTF paragraph
+int rtf_write_text(const char* text, size_t size)
+{
+	// Set error flag
+	int error = RTF_SUCCESS;
+
+	// Write escaped text from caller memory
+	if ( !rtf_write_escaped( text, size, RTF_FIELDTYPE_TEXT ) )
+		error = RTF_TEXT_ERROR;
+
+	// Return error flag
+	return error;
+}
+
+
+// Writes RTF paragraphs sharing current paragraph formatting
+int rtf_write_paragraphs(const char* const* texts, const size_t* lens, size_t count)
+{
+	// Set error flag
+	int error = RTF_SUCCESS;
+	if ( count == 0 )
+		return error;
+	RTF_STATS_START();
+
+	// First paragraph writes shared formatting, next paragraphs keep it after \par
+	rtfParFormat.paragraphText = "";
+	rtfParFormat.newParagraph = true;
+	if( !rtf_write_paragraphformat() )
+		error = RTF_PARAGRAPHFORMAT_ERROR;
+	RTF_STATS_ADD( paragraphCount, count-1 );
+	if ( rtfIndex != NULL )
+		rtfIndex->paragraphCount += (int)(count-1);
+
+	// Size batch buffer from escaped text lengths (large batches are written in buffer sized parts)
+	const char separator[] = "\n\\par ";
+	size_t separatorSize = strlen(separator);
+	size_t total = 0;
+	size_t i;
+	for ( i=0; i<count; i++ )
+		total += ( i > 0 ? separatorSize : 0 ) + rtf_escape_size( texts[i], lens[i], RTF_FIELDTYPE_TEXT );
+	bool parts = ( total > RTF_BATCH_BUFFERSIZE );
+	size_t capacity = ( parts ? RTF_BATCH_BUFFERSIZE : total );
+	RTF_ARENA_MARK mark;
+	rtf_arena_mark( &rtfArena, &mark );
+	char* buffer = (char*)rtf_arena_alloc( &rtfArena, capacity );
+	if ( buffer == NULL )
+	{
+		RTF_STATS_END(RTF_STATSCALL_PARAGRAPH);
+		return RTF_MEMORY_ERROR;
+	}
+
+	// Copy separators and escaped texts to batch buffer
+	size_t length = 0;
+	for ( i=0; i<count; i++ )
+	{
+		// Write full batch buffer (paragraph larger than buffer is written directly)
+		if ( parts )
+		{
+			size_t size = ( i > 0 ? separatorSize : 0 ) + rtf_escape_size( texts[i], lens[i], RTF_FIELDTYPE_TEXT );
+			if ( length + size > capacity )
+			{
+				if ( !rtf_write_data( buffer, length ) )
+					error = RTF_TEXT_ERROR;
+				length = 0;
+			}
+			if ( size > capacity )
+			{
+				if ( i > 0 && !rtf_write_data( separator, separatorSize ) )
+					error = RTF_TEXT_ERROR;
+				if ( !rtf_write_escaped( texts[i], lens[i], RTF_FIELDTYPE_TEXT ) )
+					error = RTF_TEXT_ERROR;
+				continue;
+			}
+		}
+
+		if ( i > 0 )
+		{
+			memcpy( buffer+length, separator, separatorSize );
+			length += separatorSize;
+		}
+		size_t size = rtf_escape_copy( buffer+length, texts[i], lens[i], RTF_FIELDTYPE_TEXT );
+		RTF_STATS_ADD( textBytes, size );
+		length += size;
+	}
+
+	// Write batch buffer
+	if ( length > 0 && !rtf_write_data( buffer, length ) )
+		error = RTF_TEXT_ERROR;
+	rtf_arena_release( &rtfArena, &mark );
+
+	// Count entry point call
+	RTF_STATS_END(RTF_STATSCALL_PARAGRAPH);
+
+	// Return error flag
+	return error;
+}
+
+
+// Writes RTF list items
+int rtf_write_list(const char* const* items, const size_t* lens, size_t count, int level)
+{
+	// List items are paragraphs sharing list formatting (list is written once per item batch)
+	// Current format keeps list bulleted or numbered, level only sets list level of items
+	bool numbered = rtfParFormat.paragraphNums;
+	rtfParFormat.paragraphNums = true;
+	rtfListLevel = ( level >= 1 && level <= RTF_LIST_LEVELS ? level : 1 );
+	int error = rtf_write_paragraphs( items, lens, count );
+	rtfParFormat.paragraphNums = numbered;
+	rtfListLevel = 0;
+
+	// Return error flag
+	return error;
+}
+
+
+// Starts new RTF paragraph with text written in runs
+int rtf_begin_paragraph(bool newPar)
+{
+	// Set error flag
+	int error = RTF_SUCCESS;
+	RTF_STATS_START();
+
+	// Paragraph properties are written once, runs start with paragraph character formatting
+	rtfParFormat.paragraphText = "";
+	rtfParFormat.newParagraph = newPar;
+	if( !rtf_write_paragraphformat() )
+		error = RTF_PARAGRAPHFORMAT_ERROR;
+	rtfRunFormat = rtfParFormat.CHARACTER;
+	rtfRunStarted = true;
+
+	// Count entry point call
+	RTF_STATS_END(RTF_STATSCALL_PARAGRAPH);
+
+	// Return error flag
+	return error;
+}
+
+
+// Writes text run with character formatting to RTF paragraph
+int rtf_write_run(RTF_CHARACTER_FORMAT* cf, const char* text, size_t size)
+{
+	// Paragraph must be started
+	if ( !rtfRunStarted )
+		return RTF_TEXT_ERROR;
+
+	// Set error flag
+	int error = RTF_SUCCESS;
+
+	// Write only character formatting changes since previous run (NULL is paragraph formatting)
+	if ( cf == NULL )
+		cf = &rtfParFormat.CHARACTER;
+	char words[1024];
+	if ( rtf_diff_characterformat( &rtfRunFormat, cf, words ) && !rtf_write_data( words, strlen(words) ) )
+		error = RTF_TEXT_ERROR;
+	rtfRunFormat = *cf;
+
+	// Write escaped run text from caller memory
+	if ( !rtf_write_escaped( text, size, RTF_FIELDTYPE_TEXT ) )
+		error = RTF_TEXT_ERROR;
+
+	// Return error flag
+	return error;
+}
+
+
+// Ends RTF paragraph with text written in runs
+int rtf_end_paragraph()
+{
+	// Paragraph must be started
+	if ( !rtfRunStarted )
+		return RTF_TEXT_ERROR;
+	rtfRunStarted = false;
+
+	// Set error flag
+	int error = RTF_SUCCESS;
+
+	// Table text paragraphs do not start with \plain, restore paragraph character formatting
+	char words[1024];
+	if ( rtfParFormat.tableText && rtf_diff_characterformat( &rtfRunFormat, &rtfParFormat.CHARACTER, words ) && !rtf_write_data( words, strlen(words) ) )
+		error = RTF_TEXT_ERROR;
+
+	// Return error flag
+	return error;
+}
+
+
+// Gets character formatting changes
+bool rtf_diff_characterformat(RTF_CHARACTER_FORMAT* from, RTF_CHARACTER_FORMAT* to, char* words)
+{
+	char* word = words;
+
+	// Numeric properties
+	if ( to->animatedCharacter != from->animatedCharacter )
+		word += sprintf( word, "\\animtext%d", to->animatedCharacter );
+	if ( to->expandCharacter != from->expandCharacter )
+		word += sprintf( word, "\\expndtw%d", to->expandCharacter );
+	if ( to->kerningCharacter != from->kerningCharacter )
+		word += sprintf( word, "\\kerning%d", to->kerningCharacter );
+	if ( to->scaleCharacter != from->scaleCharacter )
+		word += sprintf( word, "\\charscalex%d", to->scaleCharacter );
+	if ( to->fontNumber != from->fontNumber )
+		word += sprintf( word, "\\f%d", to->fontNumber );
+	if ( to->fontSize != from->fontSize )
+		word += sprintf( word, "\\fs%d", to->fontSize );
+	if ( to->foregroundColor != from->foregroundColor )
+		word += sprintf( word, "\\cf%d", to->foregroundColor );
+
+	// Toggle properties
+	if ( to->boldCharacter != from->boldCharacter )
+		word += sprintf( word, to->boldCharacter ? "\\b" : "\\b0" );
+	if ( to->capitalCharacter != from->capitalCharacter )
+		word += sprintf( word, to->capitalCharacter ? "\\caps" : "\\caps0" );
+	if ( to->doublestrikeCharacter != from->doublestrikeCharacter )
+		word += sprintf( word, to->doublestrikeCharacter ? "\\striked1" : "\\striked0" );
+	if ( to->embossCharacter != from->embossCharacter )
+		word += sprintf( word, to->embossCharacter ? "\\embo" : "\\embo0" );
+	if ( to->engraveCharacter != from->engraveCharacter )
+		word += sprintf( word, to->engraveCharacter ? "\\impr" : "\\impr0" );
+	if ( to->italicCharacter != from->italicCharacter )
+		word += sprintf( word, to->italicCharacter ? "\\i" : "\\i0" );
+	if ( to->outlineCharacter != from->outlineCharacter )
+		word += sprintf( word, to->outlineCharacter ? "\\outl" : "\\outl0" );
+	if ( to->shadowCharacter != from->shadowCharacter )
+		word += sprintf( word, to->shadowCharacter ? "\\shad" : "\\shad0" );
+	if ( to->smallcapitalCharacter != from->smallcapitalCharacter )
+		word += sprintf( word, to->smallcapitalCharacter ? "\\scaps" : "\\scaps0" );
+	if ( to->strikeCharacter != from->strikeCharacter )
+		word += sprintf( word, to->strikeCharacter ? "\\strike" : "\\strike0" );
+
+	// Subscript and superscript share one switch
+	if ( to->subscriptCharacter != from->subscriptCharacter || to->superscriptCharacter != from->superscriptCharacter )
+	{
+		if ( to->subscriptCharacter )
+			word += sprintf( word, "\\sub" );
+		if ( to->superscriptCharacter )
+			word += sprintf( word, "\\super" );
+		if ( !to->subscriptCharacter && !to->superscriptCharacter )
+			word += sprintf( word, "\\nosupersub" );
+	}
+
+	// Underline
+	if ( to->underlineCharacter != from->underlineCharacter )
+		word += sprintf( word, "%s", rtf_get_underlinename( to->underlineCharacter ) );
+
+	// Control words end with delimiter space
+	if ( word == words )
+	{
+		*words = '\0';
+		return false;
+	}
+	strcpy( word, " " );
+	return true;
+}
+
+
+// Reserves RTF table of contents region at current position
+int rtf_reserve_toc(size_t size)
+{
+	// Table of contents is reserved once, template recording can not be patched (copied sections have headings missing from it)
+	if ( rtfToc.tocReserved || rtfTemplate != NULL || ( rtfFile == NULL && !rtfDeferred ) ||
+		( rtfPrevious != NULL && rtfPrevious->copiedSections > 0 ) )
+		return RTF_TOC_ERROR;
+
+	// Set error flag
+	int error = RTF_SUCCESS;
+
+	// Deferred header spools body, table of contents is spliced in when body is written
+	if ( rtfDeferred )
+	{
+		rtfToc.tocOffset = ( rtfFile == NULL ? rtfSpoolSize : rtf_file_tell(rtfFile) );
+		rtfToc.tocSize = 0;
+	}
+	else
+	{
+		// Write ignored placeholder group filled in place when RTF document is closed
+		if ( size < strlen("{\\*\\rtflibtoc}") )
+			size = strlen("{\\*\\rtflibtoc}");
+		rtfToc.tocOffset = rtf_file_tell(rtfFile);
+		rtfToc.tocSize = size;
+		RTF_ARENA_MARK mark;
+		rtf_arena_mark( &rtfArena, &mark );
+		char* placeholder = (char*)rtf_arena_alloc( &rtfArena, size );
+		if ( placeholder == NULL )
+			return RTF_MEMORY_ERROR;
+		rtf_toc_placeholder( placeholder, size );
+		if ( !rtf_write_data( placeholder, size ) )
+			error = RTF_TOC_ERROR;
+		rtf_arena_release( &rtfArena, &mark );
+	}
+	rtfToc.tocReserved = true;
+
+	// Return error flag
+	return error;
+}
+
+
+// Starts new RTF heading paragraph listed in table of contents
+int rtf_start_heading(const char* text, size_t size, int level)
+{
+	// Set error flag
+	int error = RTF_SUCCESS;
+
+	// Store heading for table of contents (entries live until RTF document is closed)
+	RTF_TOC_ENTRY* entry = (RTF_TOC_ENTRY*)rtf_arena_alloc( &rtfArena, sizeof(RTF_TOC_ENTRY) );
+	char* entryText = (char*)rtf_arena_alloc( &rtfArena, size );
+	if ( entry == NULL || entryText == NULL )
+		return RTF_MEMORY_ERROR;
+	entry->nextEntry = NULL;
+	entry->entryLevel = ( level < 1 ? 1 : level );
+	entry->bookmarkNumber = ++rtfToc.entryCount;
+	entry->textSize = size;
+	entry->entryText = entryText;
+	memcpy( entry->entryText, text, size );
+	if ( rtfToc.lastEntry != NULL )
+		rtfToc.lastEntry->nextEntry = entry;
+	else
+		rtfToc.firstEntry = entry;
+	rtfToc.lastEntry = entry;
+
+	// Write heading paragraph with text inside bookmark
+	char rtfText[100];
+	error = rtf_begin_text(true);
+	sprintf( rtfText, "{\\*\\bkmkstart _Toc%d}", entry->bookmarkNumber );
+	if ( !rtf_write_data( rtfText, strlen(rtfText) ) || rtf_append_text( text, size ) != RTF_SUCCESS )
+		error = RTF_TEXT_ERROR;
+	sprintf( rtfText, "{\\*\\bkmkend _Toc%d}", entry->bookmarkNumber );
+	if ( !rtf_write_data( rtfText, strlen(rtfText) ) )
+		error = RTF_TEXT_ERROR;
+	rtf_end_text();
+
+	// Return error flag
+	return error;
+}
+
+
+// Copies RTF table of contents (NULL destination gets its size)
+size_t rtf_toc_copy(char* dest)
+{
+	size_t length = 0;
+	char rtfText[1024];
+
+	// Page numbers are right aligned at text width
+	int tab = rtfDocFormat.paperWidth - rtfDocFormat.marginLeft - rtfDocFormat.marginRight;
+	for ( RTF_TOC_ENTRY* entry = rtfToc.firstEntry; entry != NULL; entry = entry->nextEntry )
+	{
+		// Entry links to heading bookmark (entries contain no line breaks, they can fill region in place)
+		sprintf( rtfText, "{\\pard\\plain\\tqr\\tldot\\tx%d\\li%d{\\field{\\*\\fldinst HYPERLINK \\\\l \"_Toc%d\"}{\\fldrslt ",
+			tab, (entry->entryLevel-1)*RTF_TOC_LEVELINDENT, entry->bookmarkNumber );
+		size_t size = strlen(rtfText);
+		if ( dest != NULL )
+			memcpy( dest+length, rtfText, size );
+		length += size;
+
+		// Heading text
+		if ( dest != NULL )
+			length += rtf_escape_copy( dest+length, entry->entryText, entry->textSize, RTF_FIELDTYPE_TEXT );
+		else
+			length += rtf_escape_size( entry->entryText, entry->textSize, RTF_FIELDTYPE_TEXT );
+
+		// Page number field (result is updated by RTF reader)
+		sprintf( rtfText, "}}\\tab{\\field{\\*\\fldinst PAGEREF _Toc%d \\\\h}{\\fldrslt }}\\par}", entry->bookmarkNumber );
+		size = strlen(rtfText);
+		if ( dest != NULL )
+			memcpy( dest+length, rtfText, size );
+		length += size;
+	}
+
+	return length;
+}
+
+
+// Writes ignored placeholder group of given size
+void rtf_toc_placeholder(char* dest, size_t size)
+{
+	size_t length = strlen("{\\*\\rtflibtoc");
+	memcpy( dest, "{\\*\\rtflibtoc", length );
+	memset( dest+length, ' ', size-length-1 );
+	dest[size-1] = '}';
+}
+
+
+// Fills reserved RTF table of contents region in place
+int rtf_fill_toc()
+{
+	// Set error flag
+	int error = RTF_SUCCESS;
+
+	// Table of contents must fit reserved region (rest of region stays ignored placeholder)
+	size_t length = rtf_toc_copy(NULL);
+	size_t minimum = strlen("{\\*\\rtflibtoc}");
+	if ( length != rtfToc.tocSize && length + minimum > rtfToc.tocSize )
+		return RTF_TOC_ERROR;
+	RTF_ARENA_MARK mark;
+	rtf_arena_mark( &rtfArena, &mark );
+	char* toc = (char*)rtf_arena_alloc( &rtfArena, rtfToc.tocSize );
+	if ( toc == NULL )
+		return RTF_MEMORY_ERROR;
+	rtf_toc_copy(toc);
+	if ( length < rtfToc.tocSize )
+		rtf_toc_placeholder( toc+length, rtfToc.tocSize-length );
+
+	// Write region and return to RTF document end
+	ULONGLONG end = rtf_file_tell(rtfFile);
+	if ( !rtf_file_seek( rtfFile, rtfToc.tocOffset ) || fwrite( toc, 1, rtfToc.tocSize, rtfFile ) < rtfToc.tocSize )
+		error = RTF_TOC_ERROR;
+	if ( !rtf_file_seek( rtfFile, end ) )
+		error = RTF_TOC_ERROR;
+	rtf_arena_release( &rtfArena, &mark );
+
+	// Return error flag
+	return error;
+}
+
+
+// Gets RTF document formatting properties
+RTF_DOCUMENT_FORMAT* rtf_get_documentformat()
+{
+	// Get current RTF document formatting properties
+	return &rtfDocFormat;
+}
+
+
+// Gets RTF section formatting properties
+RTF_SECTION_FORMAT* rtf_get_sectionformat()
+{
+	// Get current RTF section formatting properties
+	return &rtfSecFormat;
+}
+
+
+// Gets RTF paragraph formatting properties
+RTF_PARAGRAPH_FORMAT* rtf_get_paragraphformat()
+{
+	// Get current RTF paragraph formatting properties
+	return &rtfParFormat;
+}
+
+
+// Loads image from file
+int rtf_load_image(char* image, int width, int height)
+{
+	// Set error flag
+	int error = RTF_SUCCESS;
+	RTF_STATS_START();
+	RTF_TRACE_START(traceStart);
+
+	// Check image type
+	bool err = false;
+	if ( strstr(image,".bmp") == NULL )
+	{
+		if ( strstr(image,".jpg") == NULL )
+		{
+			if (strstr(image,".gif") == NULL )
+				err = true;
+		}
+	}
+
+	// If valid image type
+	if ( err == false )
+	{
+		// Free IPicture object
+		if ( rtfPicture != NULL )
+		{
+			rtfPicture->Release();
+			rtfPicture = NULL;
+		}
+
+		// Image file data must fit into memory budget (image is refused otherwise)
+		int imageFile = _open( image, _O_RDONLY | _O_BINARY );
+		struct _stat st;
+		_fstat( imageFile, &st );
+		DWORD nSize = st.st_size;
+		if ( !rtf_memory_reserve( RTF_MEMORY_IMAGE, nSize, false ) )
+			error = RTF_MEMORY_ERROR;
+		else
+		{
+			// Read image file directly into image data memory
+			HGLOBAL hGlobal = GlobalAlloc(GMEM_MOVEABLE, nSize);
+			void* pData = GlobalLock(hGlobal);
+			_read( imageFile, pData, nSize );
+			GlobalUnlock(hGlobal);
+			// Load image using OLE
+			IStream* pStream = NULL;
+			if ( CreateStreamOnHGlobal(hGlobal, TRUE, &pStream) == S_OK )
+			{
+				HRESULT hr;
+				if ((hr = OleLoadPicture( pStream, nSize, FALSE, IID_IPicture, (LPVOID *)&rtfPicture)) != S_OK)
+					error = RTF_IMAGE_ERROR;
+
+				pStream->Release();
+			}
+			rtf_memory_release( RTF_MEMORY_IMAGE, nSize );
+		}
+		_close(imageFile);
+		RTF_TRACE( rtf_trace_end( "image load", &traceStart, (int)nSize ) );
+
+		// If image is loaded
+		if ( rtfPicture != NULL )
+		{
+			// Calculate image size
+			long hmWidth;
+			long hmHeight;
+			rtfPicture->get_Width(&hmWidth);
+			rtfPicture->get_Height(&hmHeight);
+			int nWidth	= MulDiv( hmWidth, GetDeviceCaps(GetDC(NULL),LOGPIXELSX), 2540 );
+			int nHeight	= MulDiv( hmHeight, GetDeviceCaps(GetDC(NULL),LOGPIXELSY), 2540 );
+
+			// Create metafile;
+			RTF_TRACE_START(encodeStart);
+			HDC hdcMeta = CreateMetaFile(NULL);
+
+			// Render picture to metafile
+			rtfPicture->Render( hdcMeta, 0, 0, nWidth, nHeight, 0, hmHeight, hmWidth, -hmHeight, NULL );
+
+			// Close metafile
+			HMETAFILE hmf = CloseMetaFile(hdcMeta);
+
+			// Get metafile data (heap buffer must fit into memory budget, it is freed after picture is written)
+			UINT size = GetMetaFileBitsEx( hmf, 0, NULL );
+			if ( !rtf_memory_reserve( RTF_MEMORY_IMAGE, size, false ) )
+			{
+				DeleteMetaFile(hmf);
+				error = RTF_MEMORY_ERROR;
+			}
+			else
+			{
+				BYTE* buffer = new BYTE[size];
+				GetMetaFileBitsEx( hmf, size, buffer );
+				DeleteMetaFile(hmf);
+
+				// Format picture paragraph
+				RTF_PARAGRAPH_FORMAT* pf = rtf_get_paragraphformat();
+				pf->paragraphText = "";
+				rtf_write_paragraphformat();
+
+				// Writes RTF picture data
+				char rtfText[1024];
+				sprintf( rtfText, "\n{\\pict\\wmetafile8\\picwgoal%d\\pichgoal%d\\picscalex%d\\picscaley%d\n", hmWidth, hmHeight, width, height );
+				if ( !rtf_write_data( rtfText, strlen(rtfText) ) )
+					error = RTF_IMAGE_ERROR;
+				rtf_write_hex( buffer, size );
+				RTF_STATS_ADD( imageBytes, 2*size );
+				RTF_STATS_ADD( imageCount, 1 );
+				strcpy( rtfText, "}" );
+				rtf_write_data( rtfText, strlen(rtfText) );
+				delete []buffer;
+				rtf_memory_release( RTF_MEMORY_IMAGE, size );
+				RTF_TRACE( rtf_trace_end( "image encode", &encodeStart, (int)(2*size) ) );
+			}
+		}
+	}
+	else
+	{
+		// Writes RTF picture data
+		char rtfText[1024];
+		strcpy( rtfText, "\n\\par\\pard *** Error! Wrong image format ***\\par" );
+		rtf_write_data( rtfText, strlen(rtfText) );
+	}
+
+	// Count entry point call
+	RTF_STATS_END(RTF_STATSCALL_IMAGE);
+
+	// Return error flag
+	return error;
+}
+
+
+// Writes binary data as hex to RTF document
+bool rtf_write_hex(const unsigned char* binary, size_t size)
+{
+	// Hex data is converted and written in fixed chunks
+	char hex[2*RTF_MEMORY_HEXCHUNK];
+	while ( size > 0 )
+	{
+		size_t length = ( size > RTF_MEMORY_HEXCHUNK ? RTF_MEMORY_HEXCHUNK : size );
+		for ( size_t i=0; i<length; i++ )
+		{
+			hex[2*i] = rtfHexDigits[binary[i] >> 4];
+			hex[2*i+1] = rtfHexDigits[binary[i] & 15];
+		}
+		if ( !rtf_write_data( hex, 2*length ) )
+			return false;
+		binary += length;
+		size -= length;
+	}
+
+	return true;
+}
+
+
+// Converts binary data to hex
+char* rtf_bin_hex_convert(unsigned char* binary, int size)
+{
+	char* result = (char*)rtf_arena_alloc( &rtfArena, 2*size+1 );
+	if ( result == NULL )
+		return NULL;
+
+	char part1, part2;
+	for ( int i=0; i<size; i++ )
+	{
+		part1 = binary[i] / 16;
+		if ( part1 < 10 )
+			part1 += 48;
+		else
+		{
+			if ( part1 == 10 )
+				part1 = 'a';
+			if ( part1 == 11 )
+				part1 = 'b';
+			if ( part1 == 12 )
+				part1 = 'c';
+			if ( part1 == 13 )
+				part1 = 'd';
+			if ( part1 == 14 )
+				part1 = 'e';
+			if ( part1 == 15 )
+				part1 = 'f';
+		}
+
+		part2 = binary[i] % 16;
+		if ( part2 < 10 )
+			part2 += 48;
+		else
+		{
+			if ( part2 == 10 )
+				part2 = 'a';
+			if ( part2 == 11 )
+				part2 = 'b';
+			if ( part2 == 12 )
+				part2 = 'c';
+			if ( part2 == 13 )
+				part2 = 'd';
+			if ( part2 == 14 )
+				part2 = 'e';
+			if ( part2 == 15 )
+				part2 = 'f';
+		}
+
+		result[2*i] = part1;
+		result[2*i+1] = part2;
+	}
+
+	result[2*size] = '\0';
+
+	return result;
+}
+
+
+// Starts new RTF table row
+int rtf_start_tablerow()
+{
+	// Set error flag
+	int error = RTF_SUCCESS;
+	RTF_STATS_START();
+	RTF_STATS_ADD( rowCount, 1 );
+	RTF_TRACE( rtf_trace_tablerow(false) );
+
+	char tblrw[20] = "";
+	// Format table row aligment
+	switch (rtfRowFormat.rowAligment)
+	{
+		// Left align
+		case RTF_ROWTEXTALIGN_LEFT:
+			strcat( tblrw, "\\trql" );
+			break;
+
+		// Center align
+		case RTF_ROWTEXTALIGN_CENTER:
+			strcat( tblrw, "\\trqc" );
+			break;
+
+		// Right align
+		case RTF_ROWTEXTALIGN_RIGHT:
+			strcat( tblrw, "\\trqr" );
+			break;
+	}
+
+	// Add section index entry (row not directly after previous row starts new table)
+	if ( rtfIndex != NULL )
+	{
+		if ( rtfIndex->rowCount == 0 || rtfIndex->rowEnd != rtfIndex->writtenSize )
+			rtfIndex->tableCount++;
+		rtfIndex->rowCount++;
+		rtf_index_add( RTF_INDEXENTRY_TABLEROW, rtfIndex->writtenSize );
+	}
+
+	// Writes RTF table data
+	char rtfText[1024];
+	sprintf( rtfText, "\n\\trowd\\trgaph115%s\\trleft%d\\trrh%d\\trpaddb%d\\trpaddfb3\\trpaddl%d\\trpaddfl3\\trpaddr%d\\trpaddfr3\\trpaddt%d\\trpaddft3", 
+		tblrw, rtfRowFormat.rowLeftMargin, rtfRowFormat.rowHeight, rtfRowFormat.marginTop, rtfRowFormat.marginBottom, rtfRowFormat.marginLeft, rtfRowFormat.marginRight );
+	if ( !rtf_write_data( rtfText, strlen(rtfText) ) )
+		error = RTF_TABLE_ERROR;
+
+	// Count entry point call
+	RTF_STATS_END(RTF_STATSCALL_TABLEROW);
+
+	// Return error flag
+	return error;
+}
+
+
+// Ends RTF table row
+int rtf_end_tablerow()
+{
+	// Set error flag
+	int error = RTF_SUCCESS;
+	RTF_STATS_START();
+
+	// Writes RTF table data
+	char rtfText[1024];
+	sprintf( rtfText, "\n\\trgaph115\\row\\pard" );
+	if ( !rtf_write_data( rtfText, strlen(rtfText) ) )
+		error = RTF_TABLE_ERROR;
+
+	// Next row at this offset continues table
+	if ( rtfIndex != NULL )
+		rtfIndex->rowEnd = rtfIndex->writtenSize;
+
+	// Traced table ends with last row
+	RTF_TRACE( rtf_trace_tablerow(true) );
+
+	// Count entry point call
+	RTF_STATS_END(RTF_STATSCALL_TABLEROW);
+
+	// Return error flag
+	return error;
+}
+
+
+// Starts new RTF table cell
+int rtf_start_tablecell(int rightMargin)
+{
+	// Set error flag
+	int error = RTF_SUCCESS;
+	RTF_STATS_START();
+	RTF_STATS_ADD( cellCount, 1 );
+
+	char tblcla[20];
+	// Format table cell text aligment
+	switch (rtfCellFormat.textVerticalAligment)
+	{
+		// Top align
+		case RTF_CELLTEXTALIGN_TOP:
+			strcpy( tblcla, "\\clvertalt" );
+			break;
+
+		// Center align
+		case RTF_CELLTEXTALIGN_CENTER:
+			strcpy( tblcla, "\\clvertalc" );
+			break;
+
+		// Bottom align
+		case RTF_CELLTEXTALIGN_BOTTOM:
+			strcpy( tblcla, "\\clvertalb" );
+			break;
+	}
+
+	char tblcld[20];
+	// Format table cell text direction
+	switch (rtfCellFormat.textDirection)
+	{
+		// Left to right, top to bottom
+		case RTF_CELLTEXTDIRECTION_LRTB:
+			strcpy( tblcld, "\\cltxlrtb" );
+			break;
+
+		// Right to left, top to bottom
+		case RTF_CELLTEXTDIRECTION_RLTB:
+			strcpy( tblcld, "\\cltxtbrl" );
+			break;
+
+		// Left to right, bottom to top
+		case RTF_CELLTEXTDIRECTION_LRBT:
+			strcpy( tblcld, "\\cltxbtlr" );
+			break;
+
+		// Left to right, top to bottom, vertical
+		case RTF_CELLTEXTDIRECTION_LRTBV:
+			strcpy( tblcld, "\\cltxlrtbv" );
+			break;
+
+		// Right to left, top to bottom, vertical
+		case RTF_CELLTEXTDIRECTION_RLTBV:
+			strcpy( tblcld, "\\cltxtbrlv" );
+			break;
+	}
+
+	char tbclbrb[1024]="", tbclbrl[1024]="", tbclbrr[1024]="", tbclbrt[1024]="";
+	// Format table cell border
+	if ( rtfCellFormat.borderBottom.border == true )
+	{
+		// Bottom cell border
+		char tbclbt[20];
+		strcpy( tbclbt, "\\clbrdrb" );
+
+		const char* border = rtf_get_bordername(rtfCellFormat.borderBottom.BORDERS.borderType);
+
+		sprintf( tbclbrb, "%s%s\\brdrw%d\\brsp%d\\brdrcf%d", tbclbt, border, rtfCellFormat.borderBottom.BORDERS.borderWidth, 
+			rtfCellFormat.borderBottom.BORDERS.borderSpace, rtfCellFormat.borderBottom.BORDERS.borderColor );
+	}
+	if ( rtfCellFormat.borderLeft.border == true )
+	{
+		// Left cell border
+		char tbclbt[20];
+		strcpy( tbclbt, "\\clbrdrl" );
+
+		const char* border = rtf_get_bordername(rtfCellFormat.borderLeft.BORDERS.borderType);
+
+		sprintf( tbclbrl, "%s%s\\brdrw%d\\brsp%d\\brdrcf%d", tbclbt, border, rtfCellFormat.borderLeft.BORDERS.borderWidth, 
+		rtfCellFormat.borderLeft.BORDERS.borderSpace, rtfCellFormat.borderLeft.BORDERS.borderColor );
+	}
+	if ( rtfCellFormat.borderRight.border == true )
+	{
+		// Right cell border
+		char tbclbt[20];
+		strcpy( tbclbt, "\\clbrdrr" );
+
+		const char* border = rtf_get_bordername(rtfCellFormat.borderRight.BORDERS.borderType);
+
+		sprintf( tbclbrr, "%s%s\\brdrw%d\\brsp%d\\brdrcf%d", tbclbt, border, rtfCellFormat.borderRight.BORDERS.borderWidth, 
+		rtfCellFormat.borderRight.BORDERS.borderSpace, rtfCellFormat.borderRight.BORDERS.borderColor );
+	}
+	if ( rtfCellFormat.borderTop.border == true )
+	{
+		// Top cell border
+		char tbclbt[20];
+		strcpy( tbclbt, "\\clbrdrt" );
+
+		const char* border = rtf_get_bordername(rtfCellFormat.borderTop.BORDERS.borderType);
+
+		sprintf( tbclbrt, "%s%s\\brdrw%d\\brsp%d\\brdrcf%d", tbclbt, border, rtfCellFormat.borderTop.BORDERS.borderWidth, 
+		rtfCellFormat.borderTop.BORDERS.borderSpace, rtfCellFormat.borderTop.BORDERS.borderColor );
+	}
+
+	// Format table cell shading
+	char shading[100] = "";
+	if ( rtfCellFormat.cellShading == true )
+	{
+		const char* sh = rtf_get_shadingname( rtfCellFormat.SHADING.shadingType, true );
+
+		// Set paragraph shading color
+		sprintf( shading, "%s\\clshdgn%d\\clcfpat%d\\clcbpat%d", sh, rtfCellFormat.SHADING.shadingIntensity, rtfCellFormat.SHADING.shadingFillColor, rtfCellFormat.SHADING.shadingBkColor );
+	}
+
+	// Writes RTF table data
+	char rtfText[1024];
+	sprintf( rtfText, "\n\\tcelld%s%s%s%s%s%s%s\\cellx%d", tblcla, tblcld, tbclbrb, tbclbrl, tbclbrr, tbclbrt, shading, rightMargin );
+	if ( !rtf_write_data( rtfText, strlen(rtfText) ) )
+		error = RTF_TABLE_ERROR;
+
+	// Count entry point call
+	RTF_STATS_END(RTF_STATSCALL_TABLECELL);
+
+	// Return error flag
+	return error;
+}
+
+
+// Ends RTF table cell
+int rtf_end_tablecell()
+{
+	// Set error flag
+	int error = RTF_SUCCESS;
+	RTF_STATS_START();
+
+	// Writes RTF table data
+	char rtfText[1024];
+	strcpy( rtfText, "\n\\cell " );
+	if ( !rtf_write_data( rtfText, strlen(rtfText) ) )
+		error = RTF_TABLE_ERROR;
+
+	// Count entry point call
+	RTF_STATS_END(RTF_STATSCALL_TABLECELL);
+
+	// Return error flag
+	return error;
+}
+
+
+// Gets RTF table row formatting properties
+RTF_TABLEROW_FORMAT* rtf_get_tablerowformat()
+{
+	// Get current RTF table row formatting properties
+	return &rtfRowFormat;
+}
+
+
+// Sets RTF table row formatting properties
+void rtf_set_tablerowformat(RTF_TABLEROW_FORMAT* rf)
+{
+	// Set new RTF table row formatting properties
+	memcpy( &rtfRowFormat, rf, sizeof(RTF_TABLEROW_FORMAT) );
+}
+
+
+// Gets RTF table cell formatting properties
+RTF_TABLECELL_FORMAT* rtf_get_tablecellformat()
+{
+	// Get current RTF table cell formatting properties
+	return &rtfCellFormat;
+}
+
+
+// Sets RTF table cell formatting properties
+void rtf_set_tablecellformat(RTF_TABLECELL_FORMAT* cf)
+{
+	// Set new RTF table cell formatting properties
+	memcpy( &rtfCellFormat, cf, sizeof(RTF_TABLECELL_FORMAT) );
+}
+
+
+// Gets border name
+const char* rtf_get_bordername(int border_type)
+{
+	const char* border = "";
+
+	switch (border_type)
+	{
+		// Single-thickness border
+		case RTF_PARAGRAPHBORDERTYPE_STHICK:
+			border = "\\brdrs";
+			break;
+
+		// Double-thickness border
+		case RTF_PARAGRAPHBORDERTYPE_DTHICK:
+			border = "\\brdrth";
+			break;
+
+		// Shadowed border
+		case RTF_PARAGRAPHBORDERTYPE_SHADOW:
+			border = "\\brdrsh";
+			break;
+
+		// Double border
+		case RTF_PARAGRAPHBORDERTYPE_DOUBLE:
+			border = "\\brdrdb";
+			break;
+
+		// Dotted border
+		case RTF_PARAGRAPHBORDERTYPE_DOT:
+			border = "\\brdrdot";
+			break;
+
+		// Dashed border
+		case RTF_PARAGRAPHBORDERTYPE_DASH:
+			border = "\\brdrdash";
+			break;
+
+		// Hairline border
+		case RTF_PARAGRAPHBORDERTYPE_HAIRLINE:
+			border = "\\brdrhair";
+			break;
+
+		// Inset border
+		case RTF_PARAGRAPHBORDERTYPE_INSET:
+			border = "\\brdrinset";
+			break;
+
+		// Dashed border (small)
+		case RTF_PARAGRAPHBORDERTYPE_SDASH:
+			border = "\\brdrdashsm";
+			break;
+
+		// Dot-dashed border
+		case RTF_PARAGRAPHBORDERTYPE_DOTDASH:
+			border = "\\brdrdashd";
+			break;
+
+		// Dot-dot-dashed border
+		case RTF_PARAGRAPHBORDERTYPE_DOTDOTDASH:
+			border = "\\brdrdashdd";
+			break;
+
+		// Outset border
+		case RTF_PARAGRAPHBORDERTYPE_OUTSET:
+			border = "\\brdroutset";
+			break;
+
+		// Triple border
+		case RTF_PARAGRAPHBORDERTYPE_TRIPLE:
+			border = "\\brdrtriple";
+			break;
+
+		// Wavy border
+		case RTF_PARAGRAPHBORDERTYPE_WAVY:
+			border = "\\brdrwavy";
+			break;
+
+		// Double wavy border
+		case RTF_PARAGRAPHBORDERTYPE_DWAVY:
+			border = "\\brdrwavydb";
+			break;
+
+		// Striped border
+		case RTF_PARAGRAPHBORDERTYPE_STRIPED:
+			border = "\\brdrdashdotstr";
+			break;
+
+		// Embossed border
+		case RTF_PARAGRAPHBORDERTYPE_EMBOSS:
+			border = "\\brdremboss";
+			break;
+
+		// Engraved border
+		case RTF_PARAGRAPHBORDERTYPE_ENGRAVE:
+			border = "\\brdrengrave";
+			break;
+	}
+
+	return border;
+}
+
+
+// Gets shading name
+const char* rtf_get_shadingname(int shading_type, bool cell)
+{
+	const char* shading = "";
+
+	if ( cell == false )
+	{
+		switch (shading_type)
+		{
+			// Fill shading
+			case RTF_PARAGRAPHSHADINGTYPE_FILL:
+				shading = "";
+				break;
+
+			// Horizontal background pattern
+			case RTF_PARAGRAPHSHADINGTYPE_HORIZ:
+				shading = "\\bghoriz";
+				break;
+
+			// Vertical background pattern
+			case RTF_PARAGRAPHSHADINGTYPE_VERT:
+				shading = "\\bgvert";
+				break;
+
+			// Forward diagonal background pattern
+			case RTF_PARAGRAPHSHADINGTYPE_FDIAG:
+				shading = "\\bgfdiag";
+				break;
+
+			// Backward diagonal background pattern
+			case RTF_PARAGRAPHSHADINGTYPE_BDIAG:
+				shading = "\\bgbdiag";
+				break;
+
+			// Cross background pattern
+			case RTF_PARAGRAPHSHADINGTYPE_CROSS:
+				shading = "\\bgcross";
+				break;
+
+			// Diagonal cross background pattern
+			case RTF_PARAGRAPHSHADINGTYPE_CROSSD:
+				shading = "\\bgdcross";
+				break;
+
+			// Dark horizontal background pattern
+			case RTF_PARAGRAPHSHADINGTYPE_DHORIZ:
+				shading = "\\bgdkhoriz";
+				break;
+
+			// Dark vertical background pattern
+			case RTF_PARAGRAPHSHADINGTYPE_DVERT:
+				shading = "\\bgdkvert";
+				break;
+
+			// Dark forward diagonal background pattern
+			case RTF_PARAGRAPHSHADINGTYPE_DFDIAG:
+				shading = "\\bgdkfdiag";
+				break;
+
+			// Dark backward diagonal background pattern
+			case RTF_PARAGRAPHSHADINGTYPE_DBDIAG:
+				shading = "\\bgdkbdiag";
+				break;
+
+			// Dark cross background pattern
+			case RTF_PARAGRAPHSHADINGTYPE_DCROSS:
+				shading = "\\bgdkcross";
+				break;
+
+			// Dark diagonal cross background pattern
+			case RTF_PARAGRAPHSHADINGTYPE_DCROSSD:
+				shading = "\\bgdkdcross";
+				break;
+		}
+	}
+	else
+	{
+		switch (shading_type)
+		{
+			// Fill shading
+			case RTF_CELLSHADINGTYPE_FILL:
+				shading = "";
+				break;
+
+			// Horizontal background pattern
+			case RTF_CELLSHADINGTYPE_HORIZ:
+				shading = "\\clbghoriz";
+				break;
+
+			// Vertical background pattern
+			case RTF_CELLSHADINGTYPE_VERT:
+				shading = "\\clbgvert";
+				break;
+
+			// Forward diagonal background pattern
+			case RTF_CELLSHADINGTYPE_FDIAG:
+				shading = "\\clbgfdiag";
+				break;
+
+			// Backward diagonal background pattern
+			case RTF_CELLSHADINGTYPE_BDIAG:
+				shading = "\\clbgbdiag";
+				break;
+
+			// Cross background pattern
+			case RTF_CELLSHADINGTYPE_CROSS:
+				shading = "\\clbgcross";
+				break;
+
+			// Diagonal cross background pattern
+			case RTF_CELLSHADINGTYPE_CROSSD:
+				shading = "\\clbgdcross";
+				break;
+
+			// Dark horizontal background pattern
+			case RTF_CELLSHADINGTYPE_DHORIZ:
+				shading = "\\clbgdkhoriz";
+				break;
+
+			// Dark vertical background pattern
+			case RTF_CELLSHADINGTYPE_DVERT:
+				shading = "\\clbgdkvert";
+				break;
+
+			// Dark forward diagonal background pattern
+			case RTF_CELLSHADINGTYPE_DFDIAG:
+				shading = "\\clbgdkfdiag";
+				break;
+
+			// Dark backward diagonal background pattern
+			case RTF_CELLSHADINGTYPE_DBDIAG:
+				shading = "\\clbgdkbdiag";
+				break;
+
+			// Dark cross background pattern
+			case RTF_CELLSHADINGTYPE_DCROSS:
+				shading = "\\clbgdkcross";
+				break;
+
+			// Dark diagonal cross background pattern
+			case RTF_CELLSHADINGTYPE_DCROSSD:
+				shading = "\\clbgdkdcross";
+				break;
+		}
+	}
+
+	return shading;
+}
+
+
+// Gets underline name
+const char* rtf_get_underlinename(int underline_type)
+{
+	const char* underline = "";
+
+	switch (underline_type)
+	{
+		// None underline
+		case 0:
+			underline = "\\ulnone";
+			break;
+
+		// Continuous underline
+		case 1:
+			underline = "\\ul";
+			break;
+
+		// Dotted underline
+		case 2:
+			underline = "\\uld";
+			break;
+
+		// Dashed underline
+		case 3:
+			underline = "\\uldash";
+			break;
+
+		// Dash-dotted underline
+		case 4:
+			underline = "\\uldashd";
+			break;
+
+		// Dash-dot-dotted underline
+		case 5:
+			underline = "\\uldashdd";
+			break;
+
+		// Double underline
+		case 6:
+			underline = "\\uldb";
+			break;
+
+		// Heavy wave underline
+		case 7:
+			underline = "\\ulhwave";
+			break;
+
+		// Long dashed underline
+		case 8:
+			underline = "\\ulldash";
+			break;
+
+		// Thick underline
+		case 9:
+			underline = "\\ulth";
+			break;
+
+		// Thick dotted underline
+		case 10:
+			underline = "\\ulthd";
+			break;
+
+		// Thick dashed underline
+		case 11:
+			underline = "\\ulthdash";
+			break;
+
+		// Thick dash-dotted underline
+		case 12:
+			underline = "\\ulthdashd";
+			break;
+
+		// Thick dash-dot-dotted underline
+		case 13:
+			underline = "\\ulthdashdd";
+			break;
+
+		// Thick long dashed underline
+		case 14:
+			underline = "\\ulthldash";
+			break;
+
+		// Double wave underline
+		case 15:
+			underline = "\\ululdbwave";
+			break;
+
+		// Word underline
+		case 16:
+			underline = "\\ulw";
+			break;
+
+		// Wave underline
+		case 17:
+			underline = "\\ulwave";
+			break;
+	}
+
+	return underline;
+}
+
+
+// Writes raw data to RTF document
+bool rtf_write_data(const char* data, size_t size)
+{
+	// Set error flag
+	bool result = true;
+	RTF_STATS_ADD( bytesWritten, size );
+	RTF_TRACE( rtfTraceSpans.writeCount++ );
+
+	// Record RTF template constant data
+	if ( rtfTemplate != NULL )
+		result = rtf_template_append( data, size );
+	// Spool RTF document body until header is written (spooled body reaches text extractor and analyzer when it is copied)
+	else if ( rtfDeferred )
+	{
+		result = rtf_spool_data( data, size );
+		if ( rtfIndex != NULL )
+			rtf_index_count( data, size );
+	}
+	else
+	{
+		// Writes data to RTF document
+		RTF_STATS_ADD( writeCalls, 1 );
+		if ( fwrite( data, 1, size, rtfFile ) < size )
+			result = false;
+
+		// Extract plain text of written data
+		if ( rtfExtractor != NULL && !rtf_extract_data( rtfExtractor, data, size, false ) )
+			result = false;
+
+		// Attribute written data to control word families
+		if ( rtfAnalyzer != NULL )
+			rtf_analyze_data( rtfAnalyzer, data, size, false );
+
+		// Count written data for section index
+		if ( rtfIndex != NULL )
+			rtf_index_count( data, size );
+	}
+
+	// Return error flag
+	return result;
+}
+
+
+// Writes data to RTF document body spool
+bool rtf_spool_data(const char* data, size_t size)
+{
+	// Spool is already moved to temporary file
+	if ( rtfFile != NULL )
+		return ( fwrite( data, 1, size, rtfFile ) == size );
+
+	// Spool limit is reached or memory budget refuses to grow spool
+	bool spill = ( rtfSpoolSize + size > rtfSpoolLimit );
+	size_t capacity = rtfSpoolCapacity;
+	if ( !spill && rtfSpoolSize + size > rtfSpoolCapacity )
+	{
+		capacity = 2*rtfSpoolCapacity + size + 65536;
+		if ( capacity > rtfSpoolLimit )
+			capacity = rtfSpoolLimit;
+		if ( !rtf_memory_reserve( RTF_MEMORY_SPOOL, capacity - rtfSpoolCapacity, false ) )
+		{
+			rtfMemory.spillCount++;
+			spill = true;
+		}
+	}
+
+	// Move spooled body to temporary file
+	if ( spill )
+	{
+		RTF_TRACE_START(traceStart);
+		rtfFile = tmpfile();
+		if ( rtfFile == NULL )
+			return false;
+		if ( fwrite( rtfSpoolData, 1, rtfSpoolSize, rtfFile ) < rtfSpoolSize )
+			return false;
+		RTF_TRACE( rtf_trace_end( "spool to file", &traceStart, (int)rtfSpoolSize ) );
+		rtfSpoolSize = 0;
+
+		if ( fwrite( data, 1, size, rtfFile ) < size )
+			return false;
+		return true;
+	}
+
+	// Grow memory spool
+	if ( capacity > rtfSpoolCapacity )
+	{
+		char* buffer = new char[capacity];
+		RTF_STATS_ADD( allocationCount, 1 );
+		memcpy( buffer, rtfSpoolData, rtfSpoolSize );
+		delete []rtfSpoolData;
+		rtfSpoolData = buffer;
+		rtfSpoolCapacity = capacity;
+	}
+
+	// Append data to memory spool
+	memcpy( rtfSpoolData + rtfSpoolSize, data, size );
+	rtfSpoolSize += size;
+
+	return true;
+}
+
+
+// Writes deferred RTF document header and spooled body
+int rtf_write_deferred()
+{
+	// Set error flag
+	int error = RTF_SUCCESS;
+	RTF_TRACE_START(traceStart);
+
+	// Create RTF document
+	FILE* spool = rtfFile;
+	rtfDeferred = false;
+	rtfFile = fopen( rtfFileName, "w" );
+	if ( rtfFile == NULL )
+	{
+		if ( spool != NULL )
+			fclose(spool);
+		return RTF_OPEN_ERROR;
+	}
+
+	// Section index offsets of spooled body are counted from body start
+	RTF_INDEX* index = rtfIndex;
+	ULONGLONG spooled = 0;
+	if ( index != NULL )
+	{
+		spooled = index->writtenSize;
+		index->writtenSize = 0;
+	}
+
+	// Write RTF document header with final font and color table
+	if ( !rtf_write_header() )
+		error = RTF_HEADER_ERROR;
+
+	// Write RTF document formatting properties
+	if ( !rtf_write_documentformat() )
+		error = RTF_DOCUMENTFORMAT_ERROR;
+
+	// Move section index offsets after header (spooled body is already counted)
+	if ( index != NULL )
+	{
+		ULONGLONG bodyStart = index->writtenSize;
+		for ( int i=0; i<index->entryCount; i++ )
+			index->indexEntries[i].entryOffset += bodyStart;
+		index->bodyEnd += bodyStart;
+		index->rowEnd += bodyStart;
+		index->writtenSize = bodyStart + spooled;
+		rtfIndex = NULL;
+	}
+
+	// Build table of contents spliced into spooled body at reserved offset
+	RTF_ARENA_MARK mark;
+	rtf_arena_mark( &rtfArena, &mark );
+	size_t tocLength = 0;
+	char* toc = NULL;
+	ULONGLONG tocOffset = (ULONGLONG)-1;
+	if ( rtfToc.tocReserved )
+	{
+		// Table of contents refused by memory budget is left out
+		tocLength = rtf_toc_copy(NULL);
+		toc = (char*)rtf_arena_alloc( &rtfArena, tocLength );
+		if ( toc == NULL )
+		{
+			error = RTF_MEMORY_ERROR;
+			tocLength = 0;
+		}
+		else
+			rtf_toc_copy(toc);
+		tocOffset = rtfToc.tocOffset;
+
+		// Move section index offsets after table of contents
+		if ( index != NULL )
+		{
+			ULONGLONG bodyStart = index->writtenSize - spooled;
+			for ( int i=0; i<index->entryCount; i++ )
+			{
+				if ( index->indexEntries[i].entryOffset >= bodyStart + tocOffset )
+					index->indexEntries[i].entryOffset += tocLength;
+			}
+			if ( index->rowEnd >= bodyStart + tocOffset )
+				index->rowEnd += tocLength;
+			index->bodyEnd += tocLength;
+			index->writtenSize += tocLength;
+		}
+	}
+
+	// Write spooled RTF document body (spooled bytes are already counted)
+	ULONGLONG bytesWritten = rtfStats.bytesWritten;
+	if ( spool == NULL )
+	{
+		size_t first = ( tocOffset < rtfSpoolSize ? (size_t)tocOffset : rtfSpoolSize );
+		if ( !rtf_write_data( rtfSpoolData, first ) || ( tocLength > 0 && !rtf_write_data( toc, tocLength ) ) || !rtf_write_data( rtfSpoolData + first, rtfSpoolSize - first ) )
+			error = RTF_HEADER_ERROR;
+	}
+	else
+	{
+		// Copy temporary file in large blocks (table of contents is written when its offset is reached)
+		char* buffer = (char*)rtf_arena_alloc( &rtfArena, 65536 );
+		if ( buffer == NULL )
+			error = RTF_MEMORY_ERROR;
+		rewind(spool);
+		ULONGLONG copied = 0;
+		while ( buffer != NULL )
+		{
+			if ( copied == tocOffset && tocLength > 0 && !rtf_write_data( toc, tocLength ) )
+				error = RTF_HEADER_ERROR;
+			size_t block = 65536;
+			if ( copied < tocOffset && tocOffset - copied < block )
+				block = (size_t)( tocOffset - copied );
+			size_t size = fread( buffer, 1, block, spool );
+			if ( size == 0 )
+				break;
+			if ( !rtf_write_data( buffer, size ) )
+			{
+				error = RTF_HEADER_ERROR;
+				break;
+			}
+			copied += size;
+		}
+		fclose(spool);
+	}
+	rtf_arena_release( &rtfArena, &mark );
+	rtfSpoolSize = 0;
+	rtfIndex = index;
+	rtfStats.bytesWritten = bytesWritten + tocLength;
+	RTF_TRACE( rtf_trace_end( "deferred header", &traceStart, 0 ) );
+
+	// Return error flag
+	return error;
+}
+
+
+// Sets plain text file written with RTF document
+int rtf_set_textfile(char* filename, bool append)
+{
+	// Set error flag
+	int error = RTF_SUCCESS;
+
+	// Close previous plain text file
+	if ( rtfExtractor != NULL )
+		error = rtf_close_textfile();
+
+	// Create or open plain text file
+	FILE* file = fopen( filename, append ? "ab" : "wb" );
+	if ( file == NULL )
+		return RTF_TEXTFILE_ERROR;
+
+	// Plain text is extracted from data written to RTF document
+	rtfExtractor = new RTF_EXTRACTOR;
+	rtf_extract_init( rtfExtractor, file );
+
+	// Return error flag
+	return error;
+}
+
+
+// Closes plain text file written with RTF document
+int rtf_close_textfile()
+{
+	// Set error flag
+	int error = RTF_SUCCESS;
+
+	// Extract remaining data and flush plain text
+	rtf_extract_data( rtfExtractor, NULL, 0, true );
+	if ( !rtf_extract_flush( rtfExtractor ) )
+		error = RTF_TEXTFILE_ERROR;
+	if ( fclose( rtfExtractor->textFile ) )
+		error = RTF_TEXTFILE_ERROR;
+	rtf_extract_free( rtfExtractor );
+	delete rtfExtractor;
+	rtfExtractor = NULL;
+
+	// Return error flag
+	return error;
+}
+
+
+// Sets output size analysis report written with RTF document
+int rtf_set_analysisfile(char* filename)
+{
+	// Set error flag
+	int error = RTF_SUCCESS;
+
+	// Write report of previous analysis
+	if ( rtfAnalyzer != NULL )
+		error = rtf_close_analysisfile();
+	if ( strlen(filename) >= sizeof(rtfAnalysisName) )
+		return RTF_ANALYSIS_ERROR;
+
+	// Output bytes are attributed to control word families as RTF document is written
+	strcpy( rtfAnalysisName, filename );
+	rtfAnalyzer = new RTF_ANALYZER;
+	rtf_analyze_init( rtfAnalyzer );
+
+	// Return error flag
+	return error;
+}
+
+
+// Writes output size analysis report of RTF document
+int rtf_close_analysisfile()
+{
+	// Set error flag
+	int error = RTF_SUCCESS;
+
+	// Analyze remaining data and write report
+	rtf_analyze_data( rtfAnalyzer, NULL, 0, true );
+#ifndef RTF_NO_STATS
+	// Report must account for each RTF document byte once (spooled body is analyzed when it is copied)
+	if ( rtfAnalyzer->totalSize != rtfStats.bytesWritten )
+		error = RTF_ANALYSIS_ERROR;
+#endif
+	FILE* file = fopen( rtfAnalysisName, "w" );
+	if ( file == NULL )
+		error = RTF_ANALYSIS_ERROR;
+	else
+	{
+		if ( !rtf_analyze_report( rtfAnalyzer, file ) )
+			error = RTF_ANALYSIS_ERROR;
+		if ( fclose(file) )
+			error = RTF_ANALYSIS_ERROR;
+	}
+	rtf_analyze_free( rtfAnalyzer );
+	delete rtfAnalyzer;
+	rtfAnalyzer = NULL;
+
+	// Return error flag
+	return error;
+}
+
+
+// Sets section index file written with next RTF document
+int rtf_set_indexfile(char* filename)
+{
+	// Set error flag
+	int error = RTF_SUCCESS;
+
+	if ( strlen(filename) >= sizeof(rtfIndex->indexName) )
+		return RTF_INDEX_ERROR;
+
+	// Section index is written at close of next created RTF document
+	if ( rtfIndex == NULL )
+	{
+		rtfIndex = new RTF_INDEX;
+		rtfIndex->indexEntries = NULL;
+		rtfIndex->entryCapacity = 0;
+	}
+	strcpy( rtfIndex->indexName, filename );
+	rtfIndex->entryCount = 0;
+	rtfIndex->writtenSize = 0;
+	rtfIndex->rowEnd = 0;
+	rtfIndex->bodyEnd = 0;
+	rtfIndex->sectionCount = 0;
+	rtfIndex->tableCount = 0;
+	rtfIndex->rowCount = 0;
+	rtfIndex->paragraphCount = 0;
+	rtfIndex->sectionEntry = 0;
+	rtfIndex->checkpointEntries = 0;
+	rtfIndex->checkpointSection = 0;
+
+	// Return error flag
+	return error;
+}
+
+
+// Counts RTF document bytes written
+void rtf_index_count(const char* data, size_t size)
+{
+	rtfIndex->writtenSize += size;
+
+#ifdef _WIN32
+	// RTF document is text mode file, line breaks are stored as CR LF
+	const char* end = data + size;
+	for ( const char* c = (const char*)memchr( data, '\n', size ); c != NULL; c = (const char*)memchr( c + 1, '\n', end - c - 1 ) )
+		rtfIndex->writtenSize++;
+#endif
+}
+
+
+// Adds section index entry at current RTF document offset
+void rtf_index_add(int type, ULONGLONG breakStart)
+{
+	if ( rtfIndex == NULL )
+		return;
+
+	if ( type == RTF_INDEXENTRY_SECTION )
+	{
+		rtfIndex->sectionCount++;
+		rtfIndex->sectionEntry = rtfIndex->entryCount;
+	}
+
+	RTF_INDEX_ENTRY* entry = rtf_index_grow();
+	if ( entry == NULL )
+		return;
+	entry->entryOffset = rtfIndex->writtenSize;
+	entry->entryType = type;
+	entry->breakSize = (int)( rtfIndex->writtenSize - breakStart );
+	entry->sectionNumber = rtfIndex->sectionCount - 1;
+	entry->tableNumber = rtfIndex->tableCount;
+	entry->rowNumber = rtfIndex->rowCount;
+	entry->paragraphNumber = rtfIndex->paragraphCount;
+	entry->formatSize = 0;
+	entry->keyedSection = false;
+	entry->sectionKey = 0;
+	entry->sectionHash = 0;
+}
+
+
+// Gets next free section index entry
+RTF_INDEX_ENTRY* rtf_index_grow()
+{
+	// Grow index entries (section index refused by memory budget is dropped, its index file is not written)
+	if ( rtfIndex->entryCount == rtfIndex->entryCapacity )
+	{
+		int capacity = ( rtfIndex->entryCapacity == 0 ? 1024 : 2*rtfIndex->entryCapacity );
+		if ( !rtf_memory_reserve( RTF_MEMORY_INDEX, (capacity - rtfIndex->entryCapacity)*sizeof(RTF_INDEX_ENTRY), true ) )
+		{
+			rtf_free_index();
+			return NULL;
+		}
+		RTF_INDEX_ENTRY* entries = new RTF_INDEX_ENTRY[capacity];
+		RTF_STATS_ADD( allocationCount, 1 );
+		if ( rtfIndex->entryCount > 0 )
+			memcpy( entries, rtfIndex->indexEntries, rtfIndex->entryCount*sizeof(RTF_INDEX_ENTRY) );
+		delete []rtfIndex->indexEntries;
+		rtfIndex->indexEntries = entries;
+		rtfIndex->entryCapacity = capacity;
+	}
+
+	return &rtfIndex->indexEntries[rtfIndex->entryCount++];
+}
+
+
+// Writes and frees section index
+int rtf_close_indexfile()
+{
+	// Set error flag
+	int error = RTF_SUCCESS;
+
+	// Write index file header and entries
+	FILE* file = fopen( rtfIndex->indexName, "wb" );
+	if ( file == NULL )
+		error = RTF_INDEX_ERROR;
+	else
+	{
+		RTF_INDEX_HEADER header;
+		memset( &header, 0, sizeof(RTF_INDEX_HEADER) );
+		strcpy( header.indexMagic, "RTFIDX2" );
+		header.bodyEnd = rtfIndex->bodyEnd;
+		header.documentSize = rtfIndex->writtenSize;
+		header.entryCount = rtfIndex->entryCount;
+		header.sectionCount = rtfIndex->sectionCount;
+		header.tableCount = rtfIndex->tableCount;
+		header.rowCount = rtfIndex->rowCount;
+		header.paragraphCount = rtfIndex->paragraphCount;
+		if ( fwrite( &header, sizeof(RTF_INDEX_HEADER), 1, file ) < 1 )
+			error = RTF_INDEX_ERROR;
+		if ( rtfIndex->entryCount > 0 && fwrite( rtfIndex->indexEntries, sizeof(RTF_INDEX_ENTRY), rtfIndex->entryCount, file ) < (size_t)rtfIndex->entryCount )
+			error = RTF_INDEX_ERROR;
+		if ( fclose(file) )
+			error = RTF_INDEX_ERROR;
+	}
+
+	// Next RTF document is not indexed
+	rtf_free_index();
+
+	// Return error flag
+	return error;
+}
+
+
+// Frees section index
+void rtf_free_index()
+{
+	rtf_memory_release( RTF_MEMORY_INDEX, rtfIndex->entryCapacity*sizeof(RTF_INDEX_ENTRY) );
+	delete []rtfIndex->indexEntries;
+	delete rtfIndex;
+	rtfIndex = NULL;
+}
+
+
+// Reads section index file
+RTF_INDEX_ENTRY* rtf_read_index(char* indexname, RTF_INDEX_HEADER* header)
+{
+	FILE* file = fopen( indexname, "rb" );
+	if ( file == NULL )
+		return NULL;
+
+	// Check index file header and read entries
+	RTF_INDEX_ENTRY* entries = NULL;
+	if ( fread( header, sizeof(RTF_INDEX_HEADER), 1, file ) == 1 && strcmp( header->indexMagic, "RTFIDX2" ) == 0 && header->entryCount >= 0 )
+	{
+		entries = new RTF_INDEX_ENTRY[header->entryCount+1];
+		if ( fread( entries, sizeof(RTF_INDEX_ENTRY), header->entryCount, file ) < (size_t)header->entryCount )
+		{
+			delete []entries;
+			entries = NULL;
+		}
+	}
+	fclose(file);
+
+	return entries;
+}
+
+
+// Copies RTF document sections as new RTF document
+int rtf_copy_sections(char* filename, char* indexname, int first, int last, char* outname)
+{
+	// Set error flag
+	int error = RTF_SUCCESS;
+
+	// Read section index
+	RTF_INDEX_HEADER header;
+	RTF_INDEX_ENTRY* entries = rtf_read_index( indexname, &header );
+	if ( entries == NULL )
+		return RTF_INDEX_ERROR;
+
+	// Find document header end and section range
+	ULONGLONG headerEnd = 0, start = 0, end = header.bodyEnd;
+	bool found = false;
+	int i;
+	for ( i=0; i<header.entryCount; i++ )
+	{
+		RTF_INDEX_ENTRY* entry = &entries[i];
+		if ( entry->entryType != RTF_INDEXENTRY_SECTION )
+			continue;
+		if ( entry->sectionNumber == 0 )
+			headerEnd = entry->entryOffset;
+		if ( entry->sectionNumber == first )
+		{
+			start = entry->entryOffset;
+			found = true;
+		}
+		if ( entry->sectionNumber == last+1 )
+			end = entry->entryOffset - entry->breakSize;
+	}
+	delete []entries;
+	if ( first < 0 || last < first || last >= header.sectionCount || !found )
+		return RTF_INDEX_ERROR;
+
+	// Open RTF document (index must belong to it)
+	FILE* file = fopen( filename, "rb" );
+	if ( file == NULL )
+		return RTF_OPEN_ERROR;
+	if ( rtf_file_size(file) != header.documentSize )
+	{
+		fclose(file);
+		return RTF_INDEX_ERROR;
+	}
+
+	// Create RTF document
+	FILE* output = fopen( outname, "wb" );
+	if ( output == NULL )
+	{
+		fclose(file);
+		return RTF_OPEN_ERROR;
+	}
+
+	// Copy document header and section range in large blocks
+	char* buffer = new char[65536];
+	ULONGLONG ranges[2][2] = { { 0, headerEnd }, { start, end } };
+	for ( i=0; i<2 && error==RTF_SUCCESS; i++ )
+	{
+		if ( !rtf_file_seek( file, ranges[i][0] ) )
+		{
+			error = RTF_INDEX_ERROR;
+			break;
+		}
+		ULONGLONG left = ranges[i][1] - ranges[i][0];
+		while ( left > 0 )
+		{
+			size_t size = ( left < 65536 ? (size_t)left : 65536 );
+			if ( fread( buffer, 1, size, file ) < size || fwrite( buffer, 1, size, output ) < size )
+			{
+				error = RTF_INDEX_ERROR;
+				break;
+			}
+			left -= size;
+		}
+	}
+	delete []buffer;
+
+	// Write RTF document end part
+	char rtfText[1024];
+	strcpy( rtfText, "\n\\par}" );
+	if ( fwrite( rtfText, 1, strlen(rtfText), output ) < strlen(rtfText) )
+		error = RTF_INDEX_ERROR;
+
+	// Close RTF documents
+	fclose(file);
+	if ( fclose(output) )
+		error = RTF_CLOSE_ERROR;
+
+	// Return error flag
+	return error;
+}
+
+
+// Sets previous RTF document for incremental regeneration
+int rtf_set_previous(char* filename, char* indexname)
+{
+	// Set error flag
+	int error = RTF_SUCCESS;
+
+	if ( rtfPrevious != NULL )
+		rtf_free_previous();
+
+	// Read previous section index
+	RTF_PREVIOUS* previous = new RTF_PREVIOUS;
+	memset( previous, 0, sizeof(RTF_PREVIOUS) );
+	previous->indexEntries = rtf_read_index( indexname, &previous->indexHeader );
+	if ( previous->indexEntries == NULL || previous->indexHeader.entryCount == 0 )
+		error = RTF_INDEX_ERROR;
+
+	// Open previous RTF document (index must belong to it)
+	if ( error == RTF_SUCCESS )
+	{
+		previous->previousFile = fopen( filename, "rb" );
+		if ( previous->previousFile == NULL )
+			error = RTF_OPEN_ERROR;
+		else
+		{
+			if ( rtf_file_size(previous->previousFile) != previous->indexHeader.documentSize )
+				error = RTF_INDEX_ERROR;
+		}
+	}
+
+	// Read previous RTF document font and color table (header ends at first section)
+	if ( error == RTF_SUCCESS )
+	{
+		size_t headerSize = (size_t)previous->indexEntries[0].entryOffset;
+		char* header = new char[headerSize+1];
+		previous->fontTable = new char[headerSize+1];
+		previous->colorTable = new char[headerSize+1];
+		if ( !rtf_file_seek( previous->previousFile, 0 ) || fread( header, 1, headerSize, previous->previousFile ) < headerSize )
+			error = RTF_INDEX_ERROR;
+		header[headerSize] = '\0';
+		if ( error == RTF_SUCCESS && ( !rtf_read_table( header, "{\\fonttbl", previous->fontTable, headerSize+1 ) ||
+			!rtf_read_table( header, "{\\colortbl", previous->colorTable, headerSize+1 ) ) )
+			error = RTF_INDEX_ERROR;
+		delete []header;
+	}
+
+	// Index keyed sections (first section wins for duplicated keys)
+	if ( error == RTF_SUCCESS )
+	{
+		char name[16];
+		for ( int i=0; i<previous->indexHeader.entryCount; i++ )
+		{
+			RTF_INDEX_ENTRY* entry = &previous->indexEntries[i];
+			if ( entry->entryType != RTF_INDEXENTRY_SECTION || !entry->keyedSection )
+				continue;
+			sprintf( name, "%08x", entry->sectionKey );
+			if ( rtf_hash_find( &previous->sectionHash, name ) < 0 )
+				rtf_hash_insert( &previous->sectionHash, name, i );
+		}
+	}
+
+	// Previous RTF document is used until close of created RTF document
+	rtfPrevious = previous;
+	if ( error != RTF_SUCCESS )
+		rtf_free_previous();
+
+	// Return error flag
+	return error;
+}
+
+
+// Frees previous RTF document
+void rtf_free_previous()
+{
+	if ( rtfPrevious->previousFile != NULL )
+		fclose( rtfPrevious->previousFile );
+	delete []rtfPrevious->indexEntries;
+	rtf_hash_clear( &rtfPrevious->sectionHash );
+	delete []rtfPrevious->sectionHash.tableEntries;
+	delete []rtfPrevious->fontTable;
+	delete []rtfPrevious->colorTable;
+	delete rtfPrevious;
+	rtfPrevious = NULL;
+}
+
+
+// Starts new RTF section with content key and hash
+int rtf_start_keyed_section(char* key, unsigned int hash, bool* copied)
+{
+	// Set error flag
+	int error = RTF_SUCCESS;
+
+	// Keyed sections are recorded in section index
+	*copied = false;
+	if ( rtfIndex == NULL || rtfIndex->sectionCount == 0 )
+		return RTF_INDEX_ERROR;
+
+	// First section is started by rtf_open (it is keyed before any content is written)
+	if ( rtfIndex->sectionCount > 1 || rtfIndex->paragraphCount > 0 || rtfIndex->rowCount > 0 ||
+		rtfIndex->indexEntries[rtfIndex->sectionEntry].keyedSection )
+		error = rtf_start_section();
+	if ( error != RTF_SUCCESS )
+		return error;
+
+	// Tag section index entry
+	RTF_INDEX_ENTRY* entry = &rtfIndex->indexEntries[rtfIndex->sectionEntry];
+	entry->keyedSection = true;
+	entry->sectionKey = rtf_hash( key, strlen(key) );
+	entry->sectionHash = hash;
+
+	// Copy unchanged section content of previous RTF document (its headings would be missing from table of contents)
+	if ( rtfPrevious != NULL && !rtfToc.tocReserved )
+	{
+		char name[16];
+		sprintf( name, "%08x", entry->sectionKey );
+		int section = rtf_hash_find( &rtfPrevious->sectionHash, name );
+		if ( section >= 0 && rtfPrevious->indexEntries[section].sectionHash == hash && rtf_previous_tables() )
+		{
+			if ( rtf_copy_previous(section) )
+			{
+				rtfPrevious->copiedSections++;
+				*copied = true;
+			}
+			else
+				error = RTF_INDEX_ERROR;
+		}
+	}
+
+	// Return error flag
+	return error;
+}
+
+
+// Checks if previous RTF document uses same font and color numbers
+bool rtf_previous_tables()
+{
+	// Same font and color table
+	if ( strcmp( rtfFontTable, rtfPrevious->fontTable ) == 0 && strlen(rtfPrevious->colorTable) == rtfColorTableLength &&
+		memcmp( rtfColorTable, rtfPrevious->colorTable, rtfColorTableLength ) == 0 )
+		return true;
+
+	// Deferred header tables can be extended with previous tables (same numbers for existing entries)
+	if ( rtfHeaderWritten || strlen(rtfPrevious->fontTable) >= sizeof(rtfFontTable) ||
+		strncmp( rtfPrevious->fontTable, rtfFontTable, strlen(rtfFontTable) ) != 0 ||
+		strlen(rtfPrevious->colorTable) < rtfColorTableLength || memcmp( rtfPrevious->colorTable, rtfColorTable, rtfColorTableLength ) != 0 )
+		return false;
+
+	strcpy( rtfFontTable, rtfPrevious->fontTable );
+	rtfColorTableLength = 0;
+	rtf_append_colortable( rtfPrevious->colorTable );
+	rtf_hash_clear( &rtfFontHash );
+	rtf_hash_clear( &rtfColorHash );
+	return true;
+}
+
+
+// Copies section content of previous RTF document
+bool rtf_copy_previous(int section)
+{
+	RTF_INDEX_HEADER* header = &rtfPrevious->indexHeader;
+	RTF_INDEX_ENTRY* entries = rtfPrevious->indexEntries;
+
+	// Section content ends before next section break
+	int next = section + 1;
+	while ( next < header->entryCount && entries[next].entryType != RTF_INDEXENTRY_SECTION )
+		next++;
+	ULONGLONG start = entries[section].entryOffset + entries[section].formatSize;
+	ULONGLONG end = ( next < header->entryCount ? entries[next].entryOffset - entries[next].breakSize : header->bodyEnd );
+	if ( end < start )
+		return false;
+
+	// Copy table row entries of section with offsets and counts of created RTF document
+	ULONGLONG base = rtfIndex->writtenSize;
+	for ( int i=section+1; i<next; i++ )
+	{
+		RTF_INDEX_ENTRY* entry = rtf_index_grow();
+		if ( entry == NULL )
+			return false;
+		*entry = entries[i];
+		entry->entryOffset = base + ( entries[i].entryOffset - start );
+		entry->sectionNumber = rtfIndex->sectionCount - 1;
+		entry->tableNumber += rtfIndex->tableCount - entries[section].tableNumber;
+		entry->rowNumber += rtfIndex->rowCount - entries[section].rowNumber;
+		entry->paragraphNumber += rtfIndex->paragraphCount - entries[section].paragraphNumber;
+	}
+	rtfIndex->tableCount += ( next < header->entryCount ? entries[next].tableNumber : header->tableCount ) - entries[section].tableNumber;
+	rtfIndex->rowCount += ( next < header->entryCount ? entries[next].rowNumber : header->rowCount ) - entries[section].rowNumber;
+	rtfIndex->paragraphCount += ( next < header->entryCount ? entries[next].paragraphNumber : header->paragraphCount ) - entries[section].paragraphNumber;
+
+	// Copy section content in large blocks
+	bool result = true;
+	RTF_ARENA_MARK mark;
+	rtf_arena_mark( &rtfArena, &mark );
+	char* buffer = (char*)rtf_arena_alloc( &rtfArena, 65536 );
+	if ( buffer == NULL || !rtf_file_seek( rtfPrevious->previousFile, start ) )
+		result = false;
+	ULONGLONG left = end - start;
+	while ( left > 0 && result )
+	{
+		size_t size = ( left < 65536 ? (size_t)left : 65536 );
+		if ( fread( buffer, 1, size, rtfPrevious->previousFile ) < size )
+		{
+			result = false;
+			break;
+		}
+		left -= size;
+
+#ifdef _WIN32
+		// Line breaks are written as CR LF again by text mode RTF document
+		if ( buffer[size-1] == '\r' && left > 0 )
+		{
+			ungetc( '\r', rtfPrevious->previousFile );
+			left++;
+			size--;
+		}
+		size_t length = 0;
+		for ( size_t i=0; i<size; i++ )
+		{
+			if ( buffer[i] != '\r' || i+1 >= size || buffer[i+1] != '\n' )
+				buffer[length++] = buffer[i];
+		}
+		size = length;
+#endif
+
+		if ( !rtf_write_data( buffer, size ) )
+			result = false;
+	}
+	rtf_arena_release( &rtfArena, &mark );
+
+	// Next table row starts new table
+	rtfIndex->rowEnd = 0;
+
+	return result;
+}
+
+
+// Sets file position (buffered data is flushed)
+bool rtf_file_seek(FILE* file, ULONGLONG offset)
+{
+	// Stream buffer is emptied first, so 64-bit seek of file descriptor is valid for reading and writing
+	if ( fflush(file) )
+		return false;
+	return ( _lseeki64( _fileno(file), (LONGLONG)offset, SEEK_SET ) == (LONGLONG)offset );
+}
+
+
+// Gets position of written file
+ULONGLONG rtf_file_tell(FILE* file)
+{
+	// Written data is flushed first, so file descriptor position is stream position
+	fflush(file);
+	return (ULONGLONG)_telli64( _fileno(file) );
+}
+
+
+// Gets file size (buffered writes are not counted)
+ULONGLONG rtf_file_size(FILE* file)
+{
+	return (ULONGLONG)_filelengthi64( _fileno(file) );
+}
+
+
+// Truncates file and sets position to its end
+bool rtf_file_truncate(FILE* file, ULONGLONG size)
+{
+	if ( !rtf_file_seek( file, size ) )
+		return false;
+	return ( SetEndOfFile( (HANDLE)_get_osfhandle( _fileno(file) ) ) != FALSE );
+}
+
+
+// Writes RTF writer checkpoint
+int rtf_checkpoint(char* filename)
+{
+	// Set error flag
+	int error = RTF_SUCCESS;
+
+	// Only directly written RTF document can be resumed (spooled body, template and plain text extractor state are not stored)
+	if ( rtfFile == NULL || rtfDeferred || rtfTemplate != NULL || rtfExtractor != NULL || rtfAnalyzer != NULL || rtfToc.tocReserved || strcmp( rtfFileName, "" ) == 0 )
+		return RTF_CHECKPOINT_ERROR;
+	char name[1024];
+	if ( strlen(filename) + strlen(".entries") >= sizeof(name) )
+		return RTF_CHECKPOINT_ERROR;
+
+	// RTF document with memory refused by memory budget is already failed (resumed RTF document would not report it)
+	if ( rtfMemoryRefused )
+		return RTF_MEMORY_ERROR;
+
+	// Paragraph text appended in chunks and text runs are not stored (checkpoint is written between paragraphs)
+	if ( rtfTextStarted || rtfRunStarted )
+		return RTF_CHECKPOINT_ERROR;
+
+	// Flush RTF document, it is truncated to current size at resume
+	RTF_STATS_ADD( flushCalls, 1 );
+	RTF_TRACE_START(traceStart);
+	if ( fflush(rtfFile) )
+		return RTF_CHECKPOINT_ERROR;
+	RTF_TRACE( rtf_trace_end( "flush", &traceStart, 0 ) );
+
+	// Store RTF writer state
+	RTF_CHECKPOINT* checkpoint = new RTF_CHECKPOINT;
+	memset( checkpoint, 0, sizeof(RTF_CHECKPOINT) );
+	strcpy( checkpoint->checkpointMagic, "RTFCKP1" );
+	strcpy( checkpoint->fileName, rtfFileName );
+	checkpoint->binaryFile = rtfBinaryFile;
+	checkpoint->fileOffset = rtf_file_tell(rtfFile);
+	checkpoint->documentFormat = rtfDocFormat;
+	checkpoint->sectionFormat = rtfSecFormat;
+	checkpoint->paragraphFormat = rtfParFormat;
+	checkpoint->paragraphFormat.paragraphText = NULL;
+	checkpoint->rowFormat = rtfRowFormat;
+	checkpoint->cellFormat = rtfCellFormat;
+	strcpy( checkpoint->fontTable, rtfFontTable );
+	checkpoint->colorTableLength = rtfColorTableLength;
+	checkpoint->colorLevels = rtfColorLevels;
+	memcpy( checkpoint->lists, rtfLists, rtfListCount*sizeof(RTF_NUMS_FORMAT) );
+	checkpoint->listCount = rtfListCount;
+
+	if ( rtfIndex != NULL )
+	{
+		// Store section index state
+		checkpoint->indexed = true;
+		checkpoint->index = *rtfIndex;
+		checkpoint->index.indexEntries = NULL;
+		checkpoint->index.entryCapacity = 0;
+		if ( rtfIndex->entryCount > 0 )
+			checkpoint->sectionEntry = rtfIndex->indexEntries[rtfIndex->sectionEntry];
+
+		// Entries file is written incrementally (only section entry current at last checkpoint can change after it is written)
+		if ( strcmp( filename, rtfCheckpointName ) != 0 )
+			rtfIndex->checkpointEntries = 0;
+		int first = rtfIndex->checkpointEntries;
+		int section = rtfIndex->checkpointSection;
+
+		// Write section index entries changed or added since last checkpoint
+		sprintf( name, "%s.entries", filename );
+		FILE* file = fopen( name, first == 0 ? "wb" : "r+b" );
+		if ( file == NULL )
+			error = RTF_CHECKPOINT_ERROR;
+		else
+		{
+			if ( section < first && ( !rtf_file_seek( file, (ULONGLONG)section*sizeof(RTF_INDEX_ENTRY) ) ||
+				fwrite( rtfIndex->indexEntries + section, sizeof(RTF_INDEX_ENTRY), 1, file ) < 1 ) )
+				error = RTF_CHECKPOINT_ERROR;
+			else if ( !rtf_file_seek( file, (ULONGLONG)first*sizeof(RTF_INDEX_ENTRY) ) )
+				error = RTF_CHECKPOINT_ERROR;
+			else if ( rtfIndex->entryCount > first && fwrite( rtfIndex->indexEntries + first, sizeof(RTF_INDEX_ENTRY), rtfIndex->entryCount - first, file ) < (size_t)( rtfIndex->entryCount - first ) )
+				error = RTF_CHECKPOINT_ERROR;
+			if ( fclose(file) )
+				error = RTF_CHECKPOINT_ERROR;
+		}
+	}
+
+	// Write checkpoint file (previous checkpoint is replaced only by complete checkpoint)
+	if ( error == RTF_SUCCESS )
+	{
+		sprintf( name, "%s.tmp", filename );
+		FILE* file = fopen( name, "wb" );
+		if ( file == NULL )
+			error = RTF_CHECKPOINT_ERROR;
+		else
+		{
+			if ( fwrite( checkpoint, sizeof(RTF_CHECKPOINT), 1, file ) < 1 )
+				error = RTF_CHECKPOINT_ERROR;
+			if ( rtfColorTableLength > 0 && fwrite( rtfColorTable, 1, rtfColorTableLength, file ) < rtfColorTableLength )
+				error = RTF_CHECKPOINT_ERROR;
+			if ( fclose(file) )
+				error = RTF_CHECKPOINT_ERROR;
+		}
+
+		if ( error == RTF_SUCCESS && !MoveFileEx( name, filename, MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH ) )
+			error = RTF_CHECKPOINT_ERROR;
+		if ( error != RTF_SUCCESS )
+			remove(name);
+	}
+
+	// Next checkpoint appends entries added after this one
+	if ( error == RTF_SUCCESS && rtfIndex != NULL )
+	{
+		rtfIndex->checkpointEntries = rtfIndex->entryCount;
+		rtfIndex->checkpointSection = rtfIndex->sectionEntry;
+		strcpy( rtfCheckpointName, filename );
+	}
+	delete checkpoint;
+
+	// Return error flag
+	return error;
+}
+
+
+// Resumes RTF document from writer checkpoint
+int rtf_resume(char* filename)
+{
+	// Set error flag
+	int error = RTF_SUCCESS;
+
+	char name[1024];
+	if ( strlen(filename) + strlen(".entries") >= sizeof(name) )
+		return RTF_CHECKPOINT_ERROR;
+
+	// Read checkpoint file
+	FILE* file = fopen( filename, "rb" );
+	if ( file == NULL )
+		return RTF_CHECKPOINT_ERROR;
+	RTF_CHECKPOINT* checkpoint = new RTF_CHECKPOINT;
+	char* colorTable = NULL;
+	if ( fread( checkpoint, sizeof(RTF_CHECKPOINT), 1, file ) < 1 || strcmp( checkpoint->checkpointMagic, "RTFCKP1" ) != 0 )
+		error = RTF_CHECKPOINT_ERROR;
+	else
+	{
+		colorTable = new char[checkpoint->colorTableLength+1];
+		if ( fread( colorTable, 1, checkpoint->colorTableLength, file ) < checkpoint->colorTableLength )
+			error = RTF_CHECKPOINT_ERROR;
+		colorTable[checkpoint->colorTableLength] = '\0';
+	}
+	fclose(file);
+
+	// Read section index entries
+	RTF_INDEX_ENTRY* entries = NULL;
+	if ( error == RTF_SUCCESS && checkpoint->indexed && checkpoint->index.entryCount > 0 )
+	{
+		int count = checkpoint->index.entryCount;
+		entries = new RTF_INDEX_ENTRY[count];
+		sprintf( name, "%s.entries", filename );
+		file = fopen( name, "rb" );
+		if ( file == NULL )
+			error = RTF_CHECKPOINT_ERROR;
+		else
+		{
+			if ( fread( entries, sizeof(RTF_INDEX_ENTRY), count, file ) < (size_t)count )
+				error = RTF_CHECKPOINT_ERROR;
+			fclose(file);
+		}
+
+		// Current section entry is stored with checkpoint
+		entries[checkpoint->index.sectionEntry] = checkpoint->sectionEntry;
+	}
+
+	// Open RTF document and truncate it to checkpoint size
+	FILE* document = NULL;
+	if ( error == RTF_SUCCESS )
+	{
+		document = fopen( checkpoint->fileName, checkpoint->binaryFile ? "r+b" : "r+" );
+		if ( document == NULL )
+			error = RTF_OPEN_ERROR;
+		else
+		{
+			if ( rtf_file_size(document) < checkpoint->fileOffset || !rtf_file_truncate( document, checkpoint->fileOffset ) )
+			{
+				fclose(document);
+				error = RTF_CHECKPOINT_ERROR;
+			}
+		}
+	}
+
+	// Restored section index entries must fit into memory budget
+	if ( error == RTF_SUCCESS && checkpoint->indexed && !rtf_memory_reserve( RTF_MEMORY_INDEX, checkpoint->index.entryCount*sizeof(RTF_INDEX_ENTRY), true ) )
+	{
+		fclose(document);
+		error = RTF_MEMORY_ERROR;
+	}
+
+	if ( error == RTF_SUCCESS )
+	{
+		// Restore RTF document tables (header is already written)
+		rtf_init();
+		strcpy( rtfFontTable, checkpoint->fontTable );
+		rtfColorTableLength = 0;
+		rtf_append_colortable( colorTable );
+		rtf_set_colorquantization( checkpoint->colorLevels*checkpoint->colorLevels*checkpoint->colorLevels );
+		memcpy( rtfLists, checkpoint->lists, checkpoint->listCount*sizeof(RTF_NUMS_FORMAT) );
+		rtfListCount = checkpoint->listCount;
+		rtfHeaderWritten = true;
+
+		// Restore formatting params
+		rtfDocFormat = checkpoint->documentFormat;
+		rtfSecFormat = checkpoint->sectionFormat;
+		rtfParFormat = checkpoint->paragraphFormat;
+		rtfRowFormat = checkpoint->rowFormat;
+		rtfCellFormat = checkpoint->cellFormat;
+
+		// Restore section index
+		if ( rtfIndex != NULL )
+			rtf_free_index();
+		if ( checkpoint->indexed )
+		{
+			rtfIndex = new RTF_INDEX;
+			*rtfIndex = checkpoint->index;
+			rtfIndex->indexEntries = entries;
+			rtfIndex->entryCapacity = rtfIndex->entryCount;
+			rtfIndex->checkpointEntries = rtfIndex->entryCount;
+			rtfIndex->checkpointSection = rtfIndex->sectionEntry;
+			entries = NULL;
+		}
+
+		// Continue RTF document at checkpoint
+		rtfFile = document;
+		strcpy( rtfFileName, checkpoint->fileName );
+		rtfBinaryFile = checkpoint->binaryFile;
+		strcpy( rtfCheckpointName, filename );
+	}
+	delete []entries;
+	delete []colorTable;
+	delete checkpoint;
+
+	// Return error flag
+	return error;
+}
+
+
+// Gets RTF document or process-wide writer statistics
+void rtf_get_stats(RTF_STATS* stats, bool process)
+{
+	// Process-wide statistics are added up with current RTF document on read
+	*stats = rtfStats;
+	if ( process )
+		rtf_stats_add( stats, &rtfProcessStats );
+
+	// Control word bytes are all bytes except text and image data
+	stats->controlBytes = stats->bytesWritten - stats->textBytes - stats->imageBytes;
+
+	// Call time is counted in performance counter ticks
+	LARGE_INTEGER frequency;
+	QueryPerformanceFrequency(&frequency);
+	for ( int i=0; i<RTF_STATS_CALLS; i++ )
+		stats->callTime[i] = (ULONGLONG)( (double)(LONGLONG)stats->callTime[i] * 1000000.0 / (double)frequency.QuadPart );
+}
+
+
+// Resets RTF document and process-wide writer statistics
+void rtf_reset_stats()
+{
+	memset( &rtfStats, 0, sizeof(RTF_STATS) );
+	memset( &rtfProcessStats, 0, sizeof(RTF_STATS) );
+}
+
+
+// Gets statistics entry point name
+char* rtf_get_statsname(int call)
+{
+	// Entry point names (metrics names)
+	static char* names[RTF_STATS_CALLS] = { "open", "close", "section", "paragraph", "image", "tablerow", "tablecell" };
+	if ( call < 0 || call >= RTF_STATS_CALLS )
+		return "";
+	return names[call];
+}
+
+
+// Counts entry point call and time
+void rtf_stats_call(int call, LARGE_INTEGER* start)
+{
+	LARGE_INTEGER end;
+	QueryPerformanceCounter(&end);
+	rtfStats.callCount[call]++;
+	rtfStats.callTime[call] += end.QuadPart - start->QuadPart;
+}
+
+
+// Adds statistics counters
+void rtf_stats_add(RTF_STATS* stats, RTF_STATS* add)
+{
+	// Statistics structure contains only counters
+	ULONGLONG* counters = (ULONGLONG*)stats;
+	ULONGLONG* values = (ULONGLONG*)add;
+	for ( size_t i=0; i<sizeof(RTF_STATS)/sizeof(ULONGLONG); i++ )
+		counters[i] += values[i];
+}
+
+
+// Sets trace file and enables tracing (NULL disables it)
+int rtf_set_tracefile(char* filename)
+{
+	// Set error flag
+	int error = RTF_SUCCESS;
+
+	// Disable tracing
+	if ( filename == NULL )
+	{
+		rtfTraceEnabled = false;
+		strcpy( rtfTraceName, "" );
+		return error;
+	}
+	if ( strlen(filename) >= sizeof(rtfTraceName) )
+		return RTF_TRACE_ERROR;
+
+	// Trace buffer slots are claimed under lock (it is created once and kept for process lifetime)
+	if ( !rtfTraceLockReady )
+	{
+		InitializeCriticalSection( &rtfTraceLock );
+		rtfTraceLockReady = true;
+	}
+
+	// Trace is written at RTF document close (events recorded before are not written)
+	strcpy( rtfTraceName, filename );
+	LARGE_INTEGER start;
+	QueryPerformanceCounter(&start);
+	rtfTraceStart = start.QuadPart;
+	memset( &rtfTraceSpans, 0, sizeof(RTF_TRACE_SPANS) );
+	rtfTraceEnabled = true;
+
+	// Return error flag
+	return error;
+}
+
+
+// Writes recorded trace events as Chrome trace JSON
+int rtf_write_trace(char* filename)
+{
+	// Set error flag
+	int error = RTF_SUCCESS;
+
+	FILE* file = fopen( filename, "w" );
+	if ( file == NULL )
+		return RTF_TRACE_ERROR;
+
+	// Event times are written in microseconds from trace start
+	LARGE_INTEGER frequency;
+	QueryPerformanceFrequency(&frequency);
+	double scale = 1000000.0 / (double)frequency.QuadPart;
+	unsigned long process = GetCurrentProcessId();
+
+	// Write complete events of all thread buffers (events written during dump can be missing)
+	fprintf( file, "{\"traceEvents\":[" );
+	const char* separator = "\n";
+	EnterCriticalSection( &rtfTraceLock );
+	for ( int i=0; i<RTF_TRACE_MAXBUFFERS && rtfTraceBuffers[i] != NULL; i++ )
+	{
+		RTF_TRACE_BUFFER* buffer = rtfTraceBuffers[i];
+		LONG count = buffer->eventCount;
+		LONG first = ( count > RTF_TRACE_BUFFERSIZE ? count - RTF_TRACE_BUFFERSIZE : 0 );
+		for ( LONG j=first; j<count; j++ )
+		{
+			RTF_TRACE_EVENT* event = &buffer->traceEvents[j & (RTF_TRACE_BUFFERSIZE-1)];
+			if ( event->eventStart < rtfTraceStart )
+				continue;
+			fprintf( file, "%s{\"name\":\"%s\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":%lu,\"tid\":%lu,\"args\":{\"value\":%d}}",
+				separator, event->eventName, ( event->eventStart - rtfTraceStart ) * scale, ( event->eventEnd - event->eventStart ) * scale,
+				process, (unsigned long)event->threadId, event->eventValue );
+			separator = ",\n";
+		}
+	}
+	LeaveCriticalSection( &rtfTraceLock );
+	fprintf( file, "\n],\"displayTimeUnit\":\"ms\"}\n" );
+	if ( fclose(file) )
+		error = RTF_TRACE_ERROR;
+
+	// Return error flag
+	return error;
+}
+
+
+// Records trace event of calling thread
+void rtf_trace_event(const char* name, LONGLONG start, LONGLONG end, int value)
+{
+	RTF_TRACE_BUFFER* buffer = rtfTraceBuffer;
+	if ( buffer == NULL && ( buffer = rtf_trace_buffer() ) == NULL )
+		return;
+
+	// Only owner thread writes buffer, oldest events are overwritten
+	LONG count = buffer->eventCount;
+	RTF_TRACE_EVENT* event = &buffer->traceEvents[count & (RTF_TRACE_BUFFERSIZE-1)];
+	event->eventName = name;
+	event->eventStart = start;
+	event->eventEnd = end;
+	event->threadId = GetCurrentThreadId();
+	event->eventValue = value;
+
+	// Publish event
+	InterlockedIncrement( (LONG*)&buffer->eventCount );
+}
+
+
+// Records trace event ending now
+void rtf_trace_end(const char* name, LARGE_INTEGER* start, int value)
+{
+	LARGE_INTEGER end;
+	QueryPerformanceCounter(&end);
+	rtf_trace_event( name, start->QuadPart, end.QuadPart, value );
+}
+
+
+// Gets trace buffer of calling thread
+RTF_TRACE_BUFFER* rtf_trace_buffer()
+{
+	// Slots are claimed under trace lock (it exists once tracing was enabled)
+	if ( !rtfTraceLockReady )
+		return NULL;
+	LONG thread = (LONG)GetCurrentThreadId();
+	RTF_TRACE_BUFFER* result = NULL;
+	EnterCriticalSection( &rtfTraceLock );
+	for ( int i=0; i<RTF_TRACE_MAXBUFFERS && result == NULL; i++ )
+	{
+		// Create buffer in free slot
+		RTF_TRACE_BUFFER* buffer = rtfTraceBuffers[i];
+		if ( buffer == NULL )
+		{
+			buffer = new RTF_TRACE_BUFFER;
+			buffer->bufferOwner = 0;
+			buffer->eventCount = 0;
+			rtfTraceBuffers[i] = buffer;
+		}
+
+		// Reuse buffer released by finished worker thread (its events are kept)
+		if ( buffer->bufferOwner == 0 )
+		{
+			buffer->bufferOwner = thread;
+			result = buffer;
+		}
+	}
+	LeaveCriticalSection( &rtfTraceLock );
+
+	// All buffers are used, events of calling thread are not recorded
+	rtfTraceBuffer = result;
+	return result;
+}
+
+
+// Releases trace buffer of finished worker thread
+void rtf_trace_release()
+{
+	if ( rtfTraceBuffer != NULL )
+	{
+		EnterCriticalSection( &rtfTraceLock );
+		rtfTraceBuffer->bufferOwner = 0;
+		LeaveCriticalSection( &rtfTraceLock );
+		rtfTraceBuffer = NULL;
+	}
+}
+
+
+// Traces RTF section start
+void rtf_trace_section()
+{
+	// Previous section ends where new one starts
+	rtf_trace_endspans(true);
+	LARGE_INTEGER start;
+	QueryPerformanceCounter(&start);
+	rtfTraceSpans.sectionStart = start.QuadPart;
+	rtfTraceSpans.sectionCount++;
+}
+
+
+// Traces RTF table row start or end
+void rtf_trace_tablerow(bool end)
+{
+	LARGE_INTEGER now;
+	QueryPerformanceCounter(&now);
+	if ( end )
+	{
+		rtfTraceSpans.rowEnd = now.QuadPart;
+		rtfTraceSpans.rowWrites = rtfTraceSpans.writeCount;
+		return;
+	}
+
+	// Row not directly after previous row starts new table
+	if ( rtfTraceSpans.tableStart != 0 && rtfTraceSpans.writeCount != rtfTraceSpans.rowWrites )
+		rtf_trace_endspans(false);
+	if ( rtfTraceSpans.tableStart == 0 )
+	{
+		rtfTraceSpans.tableStart = now.QuadPart;
+		rtfTraceSpans.rowCount = 0;
+	}
+	rtfTraceSpans.rowCount++;
+}
+
+
+// Ends traced RTF table and section
+void rtf_trace_endspans(bool sections)
+{
+	LARGE_INTEGER now;
+	QueryPerformanceCounter(&now);
+
+	// Table ends with its last row
+	if ( rtfTraceSpans.tableStart != 0 )
+	{
+		LONGLONG end = ( rtfTraceSpans.rowEnd > rtfTraceSpans.tableStart ? rtfTraceSpans.rowEnd : now.QuadPart );
+		rtf_trace_event( "table", rtfTraceSpans.tableStart, end, rtfTraceSpans.rowCount );
+		rtfTraceSpans.tableStart = 0;
+	}
+
+	if ( sections && rtfTraceSpans.sectionStart != 0 )
+	{
+		rtf_trace_event( "section", rtfTraceSpans.sectionStart, now.QuadPart, rtfTraceSpans.sectionCount - 1 );
+		rtfTraceSpans.sectionStart = 0;
+	}
+}
+
+
+// Sets RTF document body memory spool limit
+void rtf_set_spoollimit(size_t size)
+{
+	rtfSpoolLimit = size;
+}
+
+
+// Sets writer memory budget (0 is unlimited) and resets high-water marks
+void rtf_set_memorybudget(size_t budget)
+{
+	rtfMemory.memoryBudget = budget;
+
+	// Free idle body spool (kept for reuse) if it does not fit into new budget
+	if ( budget > 0 && rtfMemory.memoryUsed > budget && !rtfDeferred && rtfSpoolData != NULL )
+	{
+		rtf_memory_release( RTF_MEMORY_SPOOL, rtfSpoolCapacity );
+		delete []rtfSpoolData;
+		rtfSpoolData = NULL;
+		rtfSpoolCapacity = 0;
+		rtfSpoolSize = 0;
+	}
+
+	// Reset high-water marks
+	rtfMemory.memoryPeak = rtfMemory.memoryUsed;
+	for ( int i=0; i<RTF_MEMORY_SUBSYSTEMS; i++ )
+		rtfMemory.subsystemPeak[i] = rtfMemory.subsystemUsed[i];
+	rtfMemory.spillCount = 0;
+	rtfMemory.deniedCount = 0;
+	rtfMemory.refusedCount = 0;
+}
+
+
+// Gets writer memory usage and high-water marks
+void rtf_get_memoryusage(RTF_MEMORY_USAGE* usage)
+{
+	*usage = rtfMemory;
+}
+
+
+// Gets memory budget subsystem name
+char* rtf_get_memoryname(int subsystem)
+{
+	// Subsystem names (metrics names)
+	static char* names[RTF_MEMORY_SUBSYSTEMS] = { "arena", "spool", "tables", "cache", "index", "image" };
+	if ( subsystem < 0 || subsystem >= RTF_MEMORY_SUBSYSTEMS )
+		return "";
+	return names[subsystem];
+}
+
+
+// Charges memory to budget (memory over budget is refused, refused required memory fails RTF document)
+bool rtf_memory_reserve(int subsystem, size_t size, bool required)
+{
+	// Check memory budget (budget is never exceeded)
+	if ( rtfMemory.memoryBudget > 0 && rtfMemory.memoryUsed + size > rtfMemory.memoryBudget )
+	{
+		if ( required )
+		{
+			rtfMemory.refusedCount++;
+			rtfMemoryRefused = true;
+		}
+		else
+			rtfMemory.deniedCount++;
+		return false;
+	}
+
+	// Update usage and high-water marks
+	rtfMemory.memoryUsed += size;
+	if ( rtfMemory.memoryUsed > rtfMemory.memoryPeak )
+		rtfMemory.memoryPeak = rtfMemory.memoryUsed;
+	rtfMemory.subsystemUsed[subsystem] += size;
+	if ( rtfMemory.subsystemUsed[subsystem] > rtfMemory.subsystemPeak[subsystem] )
+		rtfMemory.subsystemPeak[subsystem] = rtfMemory.subsystemUsed[subsystem];
+
+	return true;
+}
+
+
+// Returns memory to budget
+void rtf_memory_release(int subsystem, size_t size)
+{
+	rtfMemory.memoryUsed -= size;
+	rtfMemory.subsystemUsed[subsystem] -= size;
+}
+
+
+// Gets data hash value
+unsigned int rtf_hash(const void* data, size_t size)
+{
+	// FNV-1a hash
+	const unsigned char* bytes = (const unsigned char*)data;
+	unsigned int result = 2166136261u;
+	for ( size_t i=0; i<size; i++ )
+	{
+		result ^= bytes[i];
+		result *= 16777619u;
+	}
+
+	return result;
+}
+
+
+// Finds hash table entry value
+int rtf_hash_find(RTF_HASH_TABLE* hash, char* key)
+{
+	if ( hash->entryCount == 0 )
+		return -1;
+
+	// Probe hash table entries
+	unsigned int keyHash = rtf_hash( key, strlen(key) );
+	int mask = hash->tableSize - 1;
+	for ( int i=keyHash & mask; hash->tableEntries[i].entryKey != NULL; i=(i+1) & mask )
+	{
+		RTF_HASH_ENTRY* entry = &hash->tableEntries[i];
+		if ( entry->entryHash == keyHash && strcmp( entry->entryKey, key ) == 0 )
+			return entry->entryValue;
+	}
+
+	return -1;
+}
+
+
+// Inserts hash table entry
+bool rtf_hash_insert(RTF_HASH_TABLE* hash, char* key, int value)
+{
+	// Grow hash table (keep it at most half full)
+	if ( 2*(hash->entryCount+1) > hash->tableSize )
+	{
+		RTF_HASH_ENTRY* entries = hash->tableEntries;
+		int size = hash->tableSize;
+
+		// Writer font and color tables (arena keyed) are charged to memory budget
+		if ( hash->keyArena != NULL && !rtf_memory_reserve( RTF_MEMORY_TABLES, ( size == 0 ? 64 : 2*size )*sizeof(RTF_HASH_ENTRY), true ) )
+			return false;
+		hash->tableSize = ( size == 0 ? 64 : 2*size );
+		hash->tableEntries = new RTF_HASH_ENTRY[hash->tableSize];
+		memset( hash->tableEntries, 0, hash->tableSize*sizeof(RTF_HASH_ENTRY) );
+
+		// Move old entries
+		int mask = hash->tableSize - 1;
+		for ( int i=0; i<size; i++ )
+		{
+			if ( entries[i].entryKey != NULL )
+			{
+				int j = entries[i].entryHash & mask;
+				while ( hash->tableEntries[j].entryKey != NULL )
+					j = (j+1) & mask;
+				hash->tableEntries[j] = entries[i];
+			}
+		}
+		delete []entries;
+		if ( hash->keyArena != NULL )
+			rtf_memory_release( RTF_MEMORY_TABLES, size*sizeof(RTF_HASH_ENTRY) );
+	}
+
+	// Insert new entry
+	char* entryKey;
+	if ( hash->keyArena != NULL )
+		entryKey = (char*)rtf_arena_alloc( hash->keyArena, strlen(key)+1 );
+	else
+		entryKey = new char[strlen(key)+1];
+	if ( entryKey == NULL )
+		return false;
+	strcpy( entryKey, key );
+	unsigned int keyHash = rtf_hash( key, strlen(key) );
+	int mask = hash->tableSize - 1;
+	int k = keyHash & mask;
+	while ( hash->tableEntries[k].entryKey != NULL )
+		k = (k+1) & mask;
+	hash->tableEntries[k].entryHash = keyHash;
+	hash->tableEntries[k].entryKey = entryKey;
+	hash->tableEntries[k].entryValue = value;
+	hash->entryCount++;
+
+	return true;
+}
+
+
+// Clears hash table
+void rtf_hash_clear(RTF_HASH_TABLE* hash)
+{
+	// Free entry keys, table itself is reused (arena keys are released with arena)
+	for ( int i=0; i<hash->tableSize; i++ )
+	{
+		if ( hash->keyArena == NULL )
+			delete []hash->tableEntries[i].entryKey;
+		hash->tableEntries[i].entryKey = NULL;
+	}
+	hash->entryCount = 0;
+}
+
+
+// Allocates memory from arena
+void* rtf_arena_alloc(RTF_ARENA* arena, size_t size)
+{
+	size = ( size + RTF_ARENA_ALIGNMENT - 1 ) & ~(size_t)( RTF_ARENA_ALIGNMENT - 1 );
+
+	// Find first block with enough space (blocks after current block are unused)
+	RTF_ARENA_BLOCK* block = arena->currentBlock;
+	size_t used = arena->currentUsed;
+	if ( block == NULL )
+	{
+		block = arena->firstBlock;
+		used = 0;
+	}
+	RTF_ARENA_BLOCK* last = NULL;
+	while ( block != NULL && used + size > block->blockSize )
+	{
+		last = block;
+		block = block->nextBlock;
+		used = 0;
+	}
+
+	// Add block at arena end (large allocations get own block, block refused by memory budget fails allocation)
+	if ( block == NULL )
+	{
+		size_t blockSize = ( size > RTF_ARENA_BLOCKSIZE ? size : RTF_ARENA_BLOCKSIZE );
+		if ( !rtf_memory_reserve( RTF_MEMORY_ARENA, sizeof(RTF_ARENA_BLOCK) + blockSize, true ) )
+			return NULL;
+		block = (RTF_ARENA_BLOCK*)new char[sizeof(RTF_ARENA_BLOCK) + blockSize];
+		RTF_STATS_ADD( allocationCount, 1 );
+		block->nextBlock = NULL;
+		block->blockSize = blockSize;
+		if ( last != NULL )
+			last->nextBlock = block;
+		else
+			arena->firstBlock = block;
+	}
+
+	arena->currentBlock = block;
+	arena->currentUsed = used + size;
+	return (char*)( block + 1 ) + used;
+}
+
+
+// Marks arena position
+void rtf_arena_mark(RTF_ARENA* arena, RTF_ARENA_MARK* mark)
+{
+	mark->markBlock = arena->currentBlock;
+	mark->markUsed = arena->currentUsed;
+}
+
+
+// Releases arena memory allocated after mark
+void rtf_arena_release(RTF_ARENA* arena, RTF_ARENA_MARK* mark)
+{
+	arena->currentBlock = mark->markBlock;
+	arena->currentUsed = mark->markUsed;
+}
+
+
+// Releases all arena memory (blocks are reused)
+void rtf_arena_reset(RTF_ARENA* arena)
+{
+	arena->currentBlock = NULL;
+	arena->currentUsed = 0;
+}
+
+
+// Checks if text character needs no escaping
+bool rtf_escape_plain(unsigned char c)
+{
+	return ( c >= 0x20 && c < 0x80 && c != '\\' && c != '{' && c != '}' );
+}
+
+
+// Escapes single text character
+int rtf_escape_char(unsigned char c, int field_type, char* dest)
+{
+	char rtfText[20];
+	int length = 0;
+
+	switch (c)
+	{
+		// RTF special characters
+		case '\\':
+		case '{':
+		case '}':
+			rtfText[0] = '\\';
+			rtfText[1] = c;
+			length = 2;
+			break;
+
+		// Line feed
+		case '\n':
+			if ( field_type == RTF_FIELDTYPE_PARAGRAPHS )
+				strcpy( rtfText, "\\par " );
+			else
+				strcpy( rtfText, "\\line " );
+			length = strlen(rtfText);
+			break;
+
+		// Tab
+		case '\t':
+			strcpy( rtfText, "\\tab " );
+			length = strlen(rtfText);
+			break;
+
+		default:
+			// Non-ASCII characters are written as hexadecimal codes
+			if ( c >= 0x80 )
+			{
+				rtfText[0] = '\\';
+				rtfText[1] = '\'';
+				rtfText[2] = rtfHexDigits[c / 16];
+				rtfText[3] = rtfHexDigits[c % 16];
+				length = 4;
+			}
+			// Other control characters are skipped
+			else if ( c >= 0x20 )
+			{
+				rtfText[0] = c;
+				length = 1;
+			}
+			break;
+	}
+
+	// Copy escaped character
+	if ( dest != NULL )
+		memcpy( dest, rtfText, length );
+
+	return length;
+}
+
+
+// Gets escaped text size
+size_t rtf_escape_size(const char* text, size_t size, int field_type)
+{
+	// Raw text is not escaped
+	if ( field_type == RTF_FIELDTYPE_RAW )
+		return size;
+
+	size_t result = 0;
+	for ( size_t i=0; i<size; i++ )
+	{
+		unsigned char c = (unsigned char)text[i];
+		if ( rtf_escape_plain(c) )
+			result++;
+		else
+			result += rtf_escape_char( c, field_type, NULL );
+	}
+
+	return result;
+}
+
+
+// Copies escaped text
+size_t rtf_escape_copy(char* dest, const char* text, size_t size, int field_type)
+{
+	// Raw text is copied as is
+	if ( field_type == RTF_FIELDTYPE_RAW )
+	{
+		memcpy( dest, text, size );
+		return size;
+	}
+
+	size_t length = 0, start = 0;
+	for ( size_t i=0; i<size; i++ )
+	{
+		unsigned char c = (unsigned char)text[i];
+		if ( !rtf_escape_plain(c) )
+		{
+			// Copy plain text run
+			memcpy( dest+length, text+start, i-start );
+			length += i-start;
+
+			// Copy escaped character
+			length += rtf_escape_char( c, field_type, dest+length );
+			start = i+1;
+		}
+	}
+
+	// Copy last plain text run
+	memcpy( dest+length, text+start, size-start );
+	length += size-start;
+
+	return length;
+}
+
+
+// Writes escaped text to RTF document
+bool rtf_write_escaped(const char* text, size_t size, int field_type)
+{
+	bool result = true;
+	char escaped[RTF_ESCAPE_BUFFERSIZE];
+	size_t escapedSize = 0;
+	size_t start = 0;
+	RTF_STATS_ADD( textBytes, size );
+
+	// Raw text is written as is
+	if ( field_type == RTF_FIELDTYPE_RAW )
+		return rtf_write_data( text, size );
+
+	for ( size_t i=0; i<size; i++ )
+	{
+		unsigned char c = (unsigned char)text[i];
+		if ( !rtf_escape_plain(c) )
+		{
+			// Write plain text run directly from caller memory (after escaped characters before it)
+			if ( i > start )
+			{
+				if ( escapedSize > 0 && !rtf_write_data( escaped, escapedSize ) )
+					result = false;
+				escapedSize = 0;
+				if ( !rtf_write_data( text+start, i-start ) )
+					result = false;
+			}
+
+			// Collect consecutive escaped characters
+			if ( escapedSize + 8 > sizeof(escaped) )
+			{
+				if ( !rtf_write_data( escaped, escapedSize ) )
+					result = false;
+				escapedSize = 0;
+			}
+			int length = rtf_escape_char( c, field_type, escaped+escapedSize );
+			RTF_STATS_ADD( textBytes, length - 1 );
+			escapedSize += length;
+			start = i+1;
+		}
+	}
+
+	// Write last escaped characters and plain text run
+	if ( escapedSize > 0 && !rtf_write_data( escaped, escapedSize ) )
+		result = false;
+	if ( size > start && !rtf_write_data( text+start, size-start ) )
+		result = false;
+
+	return result;
+}
+
+
+// Starts recording new RTF template
+int rtf_template_open(char* fonts, char* colors)
+{
+	// Set error flag
+	int error = RTF_SUCCESS;
+
+	// Initialize global params
+	rtf_init();
+
+	// Set RTF document font table
+	if ( fonts != NULL )
+	{
+		if ( strcmp( fonts, "" ) != 0 )
+			rtf_set_fonttable(fonts);
+	}
+
+	// Set RTF document color table
+	if ( colors != NULL )
+	{
+		if ( strcmp( colors, "" ) != 0 )
+			rtf_set_colortable(colors);
+	}
+
+	// Create RTF template
+	rtfTemplate = new RTF_TEMPLATE;
+	memset( rtfTemplate, 0, sizeof(RTF_TEMPLATE) );
+
+	// Write RTF document header
+	if ( !rtf_write_header() )
+		error = RTF_HEADER_ERROR;
+
+	// Write RTF document formatting properties
+	if ( !rtf_write_documentformat() )
+		error = RTF_DOCUMENTFORMAT_ERROR;
+
+	// Create first RTF document section with default formatting
+	rtf_write_sectionformat();
+
+	// Return error flag
+	return error;
+}
+
+
+// Inserts named field into RTF template
+int rtf_template_field(char* name, int field_type)
+{
+	// Set error flag
+	int error = RTF_SUCCESS;
+
+	// Check if RTF template is recorded
+	if ( rtfTemplate == NULL )
+		return RTF_TEMPLATE_ERROR;
+
+	// Grow RTF template field slots
+	if ( rtfTemplate->fieldCount == rtfTemplate->fieldCapacity )
+	{
+		int capacity = 2*rtfTemplate->fieldCapacity + 16;
+		RTF_TEMPLATE_FIELD* fields = new RTF_TEMPLATE_FIELD[capacity];
+		if ( rtfTemplate->fieldCount > 0 )
+			memcpy( fields, rtfTemplate->templateFields, rtfTemplate->fieldCount*sizeof(RTF_TEMPLATE_FIELD) );
+		delete []rtfTemplate->templateFields;
+		rtfTemplate->templateFields = fields;
+		rtfTemplate->fieldCapacity = capacity;
+	}
+
+	// Fields with same name share field value
+	int index = rtf_template_findfield( rtfTemplate, name );
+	if ( index < 0 )
+		index = rtfTemplate->valueCount++;
+
+	// Set field slot at current template position
+	RTF_TEMPLATE_FIELD* field = &rtfTemplate->templateFields[rtfTemplate->fieldCount];
+	strncpy( field->fieldName, name, sizeof(field->fieldName)-1 );
+	field->fieldName[sizeof(field->fieldName)-1] = '\0';
+	field->fieldType = field_type;
+	field->fieldIndex = index;
+	field->fieldOffset = rtfTemplate->dataSize;
+	rtfTemplate->fieldCount++;
+
+	// Return error flag
+	return error;
+}
+
+
+// Ends recording of RTF template
+RTF_TEMPLATE* rtf_template_close()
+{
+	// Check if RTF template is recorded
+	if ( rtfTemplate == NULL )
+		return NULL;
+
+	// Free IPicture object
+	if ( rtfPicture != NULL )
+	{
+		rtfPicture->Release();
+		rtfPicture = NULL;
+	}
+
+	// Write RTF document end part
+	char rtfText[1024];
+	strcpy( rtfText, "\n\\par}" );
+	rtf_write_data( rtfText, strlen(rtfText) );
+
+	// Stop recording RTF template (lists of next RTF document are added again)
+	RTF_TEMPLATE* result = rtfTemplate;
+	rtfTemplate = NULL;
+	rtfHeaderWritten = false;
+	rtfListCount = 0;
+
+	return result;
+}
+
+
+// Appends constant data to RTF template
+bool rtf_template_append(const char* data, size_t size)
+{
+	// Grow RTF template constant data
+	if ( rtfTemplate->dataSize + size > rtfTemplate->dataCapacity )
+	{
+		size_t capacity = 2*rtfTemplate->dataCapacity + size + 4096;
+		char* buffer = new char[capacity];
+		if ( buffer == NULL )
+			return false;
+		memcpy( buffer, rtfTemplate->templateData, rtfTemplate->dataSize );
+		delete []rtfTemplate->templateData;
+		rtfTemplate->templateData = buffer;
+		rtfTemplate->dataCapacity = capacity;
+	}
+
+	// Append constant data
+	memcpy( rtfTemplate->templateData + rtfTemplate->dataSize, data, size );
+	rtfTemplate->dataSize += size;
+
+	return true;
+}
+
+
+// Gets RTF template field index
+int rtf_template_findfield(RTF_TEMPLATE* tmpl, char* name)
+{
+	for ( int i=0; i<tmpl->fieldCount; i++ )
+	{
+		if ( strcmp( tmpl->templateFields[i].fieldName, name ) == 0 )
+			return tmpl->templateFields[i].fieldIndex;
+	}
+
+	return -1;
+}
+
+
+// Renders RTF template instance to memory
+char* rtf_template_render_buffer(RTF_TEMPLATE* tmpl, char** values, size_t* size)
+{
+	// Calculate maximal rendered instance size (escaped character takes up to 6 bytes)
+	size_t maxSize = tmpl->dataSize;
+	for ( int i=0; i<tmpl->fieldCount; i++ )
+	{
+		char* value = values[tmpl->templateFields[i].fieldIndex];
+		if ( value != NULL )
+			maxSize += 6*strlen(value);
+	}
+
+	// Grow rendered instance buffer
+	if ( maxSize > tmpl->renderCapacity )
+	{
+		delete []tmpl->renderBuffer;
+		tmpl->renderBuffer = new char[maxSize];
+		tmpl->renderCapacity = maxSize;
+	}
+
+	// Copy constant segments and escaped field values
+	char* dest = tmpl->renderBuffer;
+	size_t offset = 0;
+	for ( int j=0; j<tmpl->fieldCount; j++ )
+	{
+		RTF_TEMPLATE_FIELD* field = &tmpl->templateFields[j];
+
+		// Copy constant segment
+		memcpy( dest, tmpl->templateData + offset, field->fieldOffset - offset );
+		dest += field->fieldOffset - offset;
+		offset = field->fieldOffset;
+
+		// Copy escaped field value
+		char* value = values[field->fieldIndex];
+		if ( value != NULL )
+			dest += rtf_escape_copy( dest, value, strlen(value), field->fieldType );
+	}
+
+	// Copy last constant segment
+	memcpy( dest, tmpl->templateData + offset, tmpl->dataSize - offset );
+	dest += tmpl->dataSize - offset;
+
+	*size = dest - tmpl->renderBuffer;
+	return tmpl->renderBuffer;
+}
+
+
+// Renders RTF template instance to file
+int rtf_template_render(RTF_TEMPLATE* tmpl, char** values, char* filename)
+{
+	// Set error flag
+	int error = RTF_SUCCESS;
+
+	// Render RTF template instance
+	size_t size = 0;
+	char* data = rtf_template_render_buffer( tmpl, values, &size );
+
+	// Create RTF document
+	FILE* file = fopen( filename, "w" );
+	if ( file != NULL )
+	{
+		// Writes rendered instance in one piece
+		if ( fwrite( data, 1, size, file ) < size )
+			error = RTF_TEMPLATE_ERROR;
+
+		// Close RTF document
+		if ( fclose(file) )
+			error = RTF_CLOSE_ERROR;
+	}
+	else
+		error = RTF_OPEN_ERROR;
+
+	// Return error flag
+	return error;
+}
+
+
+// Exports RTF template as specialized C++ header
+int rtf_template_export(RTF_TEMPLATE* tmpl, char* name, char* filename)
+{
+	// Set error flag
+	int error = RTF_SUCCESS;
+
+	// Create header file
+	FILE* file = fopen( filename, "w" );
+	if ( file == NULL )
+		return RTF_OPEN_ERROR;
+
+	fprintf( file, "// RTF layout \"%s\" (generated by rtfgen, do not edit)\n", name );
+	fprintf( file, "// Include errors.h, globals.h and rtflib.h before this file\n\n\n\n" );
+
+	// Write field indices
+	fprintf( file, "// %s field indices\n", name );
+	int values = 0;
+	for ( int i=0; i<tmpl->fieldCount; i++ )
+	{
+		if ( tmpl->templateFields[i].fieldIndex == values )
+		{
+			fprintf( file, "#define %s_FIELD_%s\t%d\n", name, tmpl->templateFields[i].fieldName, values );
+			values++;
+		}
+	}
+	fprintf( file, "#define %s_FIELD_COUNT\t%d\n\n\n\n", name, tmpl->valueCount );
+
+	// Write constant segments as byte arrays
+	size_t offset = 0;
+	for ( int j=0; j<=tmpl->fieldCount; j++ )
+	{
+		size_t end = ( j < tmpl->fieldCount ? tmpl->templateFields[j].fieldOffset : tmpl->dataSize );
+
+		fprintf( file, "// %s constant segment %d\n", name, j );
+		fprintf( file, "static const char %s_segment%d[%d] = {", name, j, (int)(end - offset) );
+		for ( size_t k=offset; k<end; k++ )
+		{
+			if ( (k - offset) % 16 == 0 )
+				fprintf( file, "\n\t" );
+			fprintf( file, "0x%02x,", (unsigned char)tmpl->templateData[k] );
+		}
+		fprintf( file, "\n};\n\n" );
+
+		offset = end;
+	}
+
+	// Write specialized render function
+	fprintf( file, "\n\n// Renders %s instance to memory\n", name );
+	fprintf( file, "static char* %s_render(char** values, size_t* size)\n{\n", name );
+	fprintf( file, "\tstatic char* buffer = NULL;\n\tstatic size_t capacity = 0;\n\n" );
+	fprintf( file, "\t// Get field value sizes\n\tsize_t length[%d];\n", tmpl->valueCount + 1 );
+	for ( int k=0; k<tmpl->valueCount; k++ )
+		fprintf( file, "\tlength[%d] = ( values[%d] != NULL ? strlen(values[%d]) : 0 );\n", k, k, k );
+	fprintf( file, "\tsize_t maxSize = %d;\n", (int)tmpl->dataSize );
+	for ( int l=0; l<tmpl->fieldCount; l++ )
+		fprintf( file, "\tmaxSize += %d*length[%d];\n", tmpl->templateFields[l].fieldType == RTF_FIELDTYPE_RAW ? 1 : 6, tmpl->templateFields[l].fieldIndex );
+	fprintf( file, "\n\t// Grow rendered instance buffer\n\tif ( maxSize > capacity )\n\t{\n" );
+	fprintf( file, "\t\tdelete []buffer;\n\t\tbuffer = new char[maxSize];\n\t\tcapacity = maxSize;\n\t}\n\n" );
+	fprintf( file, "\t// Copy constant segments and escaped field values\n\tchar* dest = buffer;\n" );
+	for ( int m=0; m<=tmpl->fieldCount; m++ )
+	{
+		fprintf( file, "\tmemcpy( dest, %s_segment%d, sizeof(%s_segment%d) );\n", name, m, name, m );
+		fprintf( file, "\tdest += sizeof(%s_segment%d);\n", name, m );
+		if ( m == tmpl->fieldCount )
+			break;
+
+		int index = tmpl->templateFields[m].fieldIndex;
+		switch ( tmpl->templateFields[m].fieldType )
+		{
+			// Raw field values are copied as is
+			case RTF_FIELDTYPE_RAW:
+				fprintf( file, "\tmemcpy( dest, values[%d], length[%d] );\n\tdest += length[%d];\n", index, index, index );
+				break;
+
+			// Text field values are escaped
+			case RTF_FIELDTYPE_TEXT:
+				fprintf( file, "\tdest += rtf_escape_copy( dest, values[%d], length[%d], RTF_FIELDTYPE_TEXT );\n", index, index );
+				break;
+
+			// Paragraphs field values are escaped
+			case RTF_FIELDTYPE_PARAGRAPHS:
+				fprintf( file, "\tdest += rtf_escape_copy( dest, values[%d], length[%d], RTF_FIELDTYPE_PARAGRAPHS );\n", index, index );
+				break;
+		}
+	}
+	fprintf( file, "\n\t*size = dest - buffer;\n\treturn buffer;\n}\n" );
+
+	// Write file render function
+	fprintf( file, "\n\n// Renders %s instance to file\n", name );
+	fprintf( file, "static int %s_render_file(char** values, FILE* file)\n{\n", name );
+	fprintf( file, "\tsize_t size = 0;\n\tchar* data = %s_render( values, &size );\n\n", name );
+	fprintf( file, "\tif ( fwrite( data, 1, size, file ) < size )\n\t\treturn RTF_TEMPLATE_ERROR;\n\n" );
+	fprintf( file, "\treturn RTF_SUCCESS;\n}\n" );
+
+	// Close header file
+	if ( fclose(file) )
+		error = RTF_CLOSE_ERROR;
+
+	// Return error flag
+	return error;
+}
+
+
+// Frees RTF template
+void rtf_template_free(RTF_TEMPLATE* tmpl)
+{
+	if ( tmpl != NULL )
+	{
+		delete []tmpl->templateData;
+		delete []tmpl->templateFields;
+		delete []tmpl->renderBuffer;
+		delete tmpl;
+	}
+}
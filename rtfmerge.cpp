@@ -0,0 +1,962 @@
+#include "errors.h"
+#include "globals.h"
+#include "rtflib.h"
+
+
+
+// RTF merge global params
+RTF_MERGE_WORD rtfMergeWords[] = {
+	// Font numbers
+	{ "f", RTF_MERGEWORD_FONT },
+	{ "af", RTF_MERGEWORD_FONT },
+	{ "deff", RTF_MERGEWORD_FONT },
+
+	// Color numbers
+	{ "cf", RTF_MERGEWORD_COLOR },
+	{ "cb", RTF_MERGEWORD_COLOR },
+	{ "chcfpat", RTF_MERGEWORD_COLOR },
+	{ "chcbpat", RTF_MERGEWORD_COLOR },
+	{ "highlight", RTF_MERGEWORD_COLOR },
+	{ "ulc", RTF_MERGEWORD_COLOR },
+	{ "brdrcf", RTF_MERGEWORD_COLOR },
+	{ "cfpat", RTF_MERGEWORD_COLOR },
+	{ "cbpat", RTF_MERGEWORD_COLOR },
+	{ "clcfpat", RTF_MERGEWORD_COLOR },
+	{ "clcbpat", RTF_MERGEWORD_COLOR },
+	{ "trcfpat", RTF_MERGEWORD_COLOR },
+	{ "trcbpat", RTF_MERGEWORD_COLOR },
+
+	// Character formatting reset (sets default font)
+	{ "plain", RTF_MERGEWORD_PLAIN },
+
+	// List override numbers
+	{ "ls", RTF_MERGEWORD_LIST },
+
+	// Paragraph, character, section and table style numbers
+	{ "s", RTF_MERGEWORD_STYLE },
+	{ "cs", RTF_MERGEWORD_STYLE },
+	{ "ds", RTF_MERGEWORD_STYLE },
+	{ "ts", RTF_MERGEWORD_STYLE },
+	{ NULL, 0 } };
+RTF_HASH_TABLE rtfMergeHash = {NULL, 0, 0};
+extern bool rtfTraceEnabled;						// Tracing is enabled (rtflib.cpp)
+
+
+
+// Initializes RTF merge tables
+void rtf_merge_init(RTF_MERGER* merger)
+{
+	// Index font, color, list and style control words
+	if ( rtfMergeHash.entryCount == 0 )
+	{
+		for ( int i=0; rtfMergeWords[i].wordName != NULL; i++ )
+			rtf_hash_insert( &rtfMergeHash, (char*)rtfMergeWords[i].wordName, i );
+	}
+
+	memset( merger, 0, sizeof(RTF_MERGER) );
+	rtf_merge_append( &merger->fontTable, "{\\fonttbl", 9 );
+	rtf_merge_append( &merger->colorTable, "{\\colortbl", 10 );
+	rtf_merge_append( &merger->listTable, "{\\*\\listtable", 13 );
+	rtf_merge_append( &merger->overrideTable, "{\\*\\listoverridetable", 21 );
+	merger->defaultFont = -1;
+}
+
+
+// Appends data to RTF merge buffer
+void rtf_merge_append(RTF_MERGE_BUFFER* buffer, const char* data, size_t size)
+{
+	// Grow buffer
+	if ( buffer->bufferSize + size > buffer->bufferCapacity )
+	{
+		size_t capacity = ( buffer->bufferCapacity == 0 ? 4096 : 2*buffer->bufferCapacity );
+		while ( capacity < buffer->bufferSize + size )
+			capacity *= 2;
+		char* data = new char[capacity];
+		if ( buffer->bufferSize > 0 )
+			memcpy( data, buffer->bufferData, buffer->bufferSize );
+		delete []buffer->bufferData;
+		buffer->bufferData = data;
+		buffer->bufferCapacity = capacity;
+	}
+
+	memcpy( buffer->bufferData + buffer->bufferSize, data, size );
+	buffer->bufferSize += size;
+}
+
+
+// Reads RTF document header tables
+bool rtf_merge_header(RTF_MERGE_DOCUMENT* document)
+{
+	// Open RTF file
+	FILE* file = fopen( document->fileName, "rb" );
+	if ( file == NULL )
+	{
+		document->documentError = RTF_OPEN_ERROR;
+		return false;
+	}
+
+	// Read RTF document header (up to document content, tables can be large)
+	RTF_READER_HEADER header;
+	RTF_READER reader;
+	size_t headerSize = 0, headerCapacity = 0;
+	char* data = NULL;
+	bool last = false;
+	do
+	{
+		headerCapacity += RTF_MERGE_HEADERSIZE;
+		char* buffer = new char[headerCapacity+1];
+		if ( headerSize > 0 )
+			memcpy( buffer, data, headerSize );
+		delete []data;
+		data = buffer;
+		headerSize += fread( data + headerSize, 1, headerCapacity - headerSize, file );
+		data[headerSize] = '\0';
+		last = ( headerSize < headerCapacity );
+
+		header.headerSize = 0;
+		header.groupStart = false;
+		header.tableGroup = false;
+		rtf_reader_init( &reader, rtf_reader_headerevent, &header );
+		rtf_reader_parse( &reader, data, headerSize, last );
+	}
+	while ( !reader.readerStopped && !last );
+
+	// Close RTF file
+	fclose(file);
+
+	// Read RTF document font, color and list tables
+	document->fontTable = new char[headerSize+1];
+	document->colorTable = new char[headerSize+1];
+	document->listTable = new char[headerSize+1];
+	document->overrideTable = new char[headerSize+1];
+	if ( strncmp( data, "{\\rtf1", 6 ) != 0 || header.headerSize == 0 )
+		document->documentError = RTF_MERGE_ERROR;
+	else if ( !rtf_read_table( data, "{\\fonttbl", document->fontTable, headerSize+1 ) )
+	{
+		// Merged font table replaces font table of first document
+		if ( document->documentIndex == 0 )
+			document->documentError = RTF_MERGE_ERROR;
+		strcpy( document->fontTable, "" );
+	}
+	if ( !rtf_read_table( data, "{\\colortbl", document->colorTable, headerSize+1 ) )
+		strcpy( document->colorTable, "" );
+	if ( !rtf_read_table( data, "{\\*\\listtable", document->listTable, headerSize+1 ) )
+		strcpy( document->listTable, "" );
+	if ( !rtf_read_table( data, "{\\*\\listoverridetable", document->overrideTable, headerSize+1 ) )
+		strcpy( document->overrideTable, "" );
+
+	// Read RTF document default font
+	char* deff = strstr( data, "\\deff" );
+	document->defaultFont = ( deff != NULL ? atoi( deff + 5 ) : 0 );
+	document->bodyStart = header.headerSize;
+	delete []data;
+
+	return ( document->documentError == RTF_SUCCESS );
+}
+
+
+// Registers RTF document tables in merged tables
+void rtf_merge_tables(RTF_MERGER* merger, RTF_MERGE_DOCUMENT* document)
+{
+	// Count font and color table entries
+	int fontCapacity = 0, colorCapacity = 0;
+	char* c;
+	for ( c = document->fontTable; *c != '\0'; c++ )
+	{
+		if ( *c == '{' )
+			fontCapacity++;
+	}
+	for ( c = document->colorTable; *c != '\0'; c++ )
+	{
+		if ( *c == ';' )
+			colorCapacity++;
+	}
+	document->fontNumbers = new int[fontCapacity+1];
+	document->fontIndexes = new int[fontCapacity+1];
+	document->colorIndexes = new int[colorCapacity+1];
+	document->fontCount = 0;
+	document->colorCount = 0;
+
+	// Font entry key is text after "{\fN" up to matching "}"
+	char* entry = document->fontTable;
+	while ( ( entry = strchr( entry, '{' ) ) != NULL )
+	{
+		int depth = 0;
+		char* end = entry + 1;
+		while ( *end != '\0' )
+		{
+			if ( *end == '\\' && end[1] != '\0' )
+				end++;
+			else if ( *end == '{' )
+				depth++;
+			else if ( *end == '}' )
+			{
+				if ( depth == 0 )
+					break;
+				depth--;
+			}
+			end++;
+		}
+		if ( *end != '}' )
+			break;
+
+		char* start = entry + 1;
+		int number = document->fontCount;
+		if ( strncmp( start, "\\f", 2 ) == 0 && start[2] >= '0' && start[2] <= '9' )
+		{
+			number = atoi( start + 2 );
+			start += 2;
+			while ( *start >= '0' && *start <= '9' )
+				start++;
+		}
+
+		// Line breaks are not part of key
+		char* key = new char[end-start+1];
+		int length = 0;
+		for ( char* c = start; c < end; c++ )
+		{
+			if ( *c != '\r' && *c != '\n' )
+				key[length++] = *c;
+		}
+		key[length] = '\0';
+
+		// Add new font to merged font table
+		int index = rtf_hash_find( &merger->fontHash, key );
+		if ( index < 0 )
+		{
+			index = merger->fontCount++;
+			rtf_hash_insert( &merger->fontHash, key, index );
+
+			char font[32];
+			sprintf( font, "{\\f%d", index );
+			rtf_merge_append( &merger->fontTable, font, strlen(font) );
+			rtf_merge_append( &merger->fontTable, key, length );
+			rtf_merge_append( &merger->fontTable, "}", 1 );
+		}
+		delete []key;
+
+		document->fontNumbers[document->fontCount] = number;
+		document->fontIndexes[document->fontCount] = index;
+		document->fontCount++;
+		entry = end + 1;
+	}
+
+	// Color entry key is text up to ";"
+	entry = document->colorTable;
+	char* end = NULL;
+	while ( ( end = strchr( entry, ';' ) ) != NULL )
+	{
+		char* key = new char[end-entry+1];
+		int length = 0;
+		for ( char* c = entry; c < end; c++ )
+		{
+			if ( *c != '\r' && *c != '\n' )
+				key[length++] = *c;
+		}
+		key[length] = '\0';
+
+		// Add new color to merged color table
+		int index = rtf_hash_find( &merger->colorHash, key );
+		if ( index < 0 )
+		{
+			index = merger->colorCount++;
+			rtf_hash_insert( &merger->colorHash, key, index );
+			rtf_merge_append( &merger->colorTable, key, length );
+			rtf_merge_append( &merger->colorTable, ";", 1 );
+		}
+		delete []key;
+
+		document->colorIndexes[document->colorCount++] = index;
+		entry = end + 1;
+	}
+
+	// Merged default font is default font of first document
+	int defaultFont = -1;
+	for ( int i=0; i<document->fontCount; i++ )
+	{
+		if ( document->fontNumbers[i] == document->defaultFont )
+		{
+			defaultFont = document->fontIndexes[i];
+			break;
+		}
+	}
+	if ( document->documentIndex == 0 )
+		merger->defaultFont = defaultFont;
+	document->plainFont = ( defaultFont != merger->defaultFont ? defaultFont : -1 );
+
+	delete []document->fontTable;
+	document->fontTable = NULL;
+	delete []document->colorTable;
+	document->colorTable = NULL;
+
+	rtf_merge_lists( merger, document );
+}
+
+
+// Copies RTF list group to key without line breaks and numbers of named control words
+void rtf_merge_listkey(char* start, char* end, char* key, const char** names, int* numbers)
+{
+	for ( int i=0; names[i] != NULL; i++ )
+		numbers[i] = -1;
+
+	int length = 0;
+	char* c = start;
+	while ( c < end )
+	{
+		if ( *c == '\\' && c+1 < end && ( ( c[1] >= 'a' && c[1] <= 'z' ) || ( c[1] >= 'A' && c[1] <= 'Z' ) ) )
+		{
+			// Copy control word name
+			char* word = c + 1;
+			key[length++] = *c++;
+			while ( c < end && ( ( *c >= 'a' && *c <= 'z' ) || ( *c >= 'A' && *c <= 'Z' ) ) )
+				key[length++] = *c++;
+
+			// Named control word number is not part of key
+			for ( int i=0; names[i] != NULL; i++ )
+			{
+				if ( (size_t)(c - word) == strlen(names[i]) && strncmp( word, names[i], c - word ) == 0 )
+				{
+					numbers[i] = atoi(c);
+					if ( c < end && *c == '-' )
+						c++;
+					while ( c < end && *c >= '0' && *c <= '9' )
+						c++;
+					break;
+				}
+			}
+		}
+		else if ( *c == '\\' && c+1 < end )
+		{
+			// Control symbol
+			key[length++] = *c++;
+			key[length++] = *c++;
+		}
+		else if ( *c != '\r' && *c != '\n' )
+			key[length++] = *c++;
+		else
+			c++;
+	}
+	key[length] = '\0';
+}
+
+
+// Appends RTF list group key with numbers of named control words
+void rtf_merge_listgroup(RTF_MERGE_BUFFER* buffer, char* key, const char** names, int* numbers)
+{
+	char* copy = key;
+	char* c = key;
+	while ( *c != '\0' )
+	{
+		if ( *c == '\\' && ( ( c[1] >= 'a' && c[1] <= 'z' ) || ( c[1] >= 'A' && c[1] <= 'Z' ) ) )
+		{
+			char* word = ++c;
+			while ( ( *c >= 'a' && *c <= 'z' ) || ( *c >= 'A' && *c <= 'Z' ) )
+				c++;
+
+			// Write number after named control word
+			for ( int i=0; names[i] != NULL; i++ )
+			{
+				if ( (size_t)(c - word) == strlen(names[i]) && strncmp( word, names[i], c - word ) == 0 )
+				{
+					char number[32];
+					sprintf( number, "%d", numbers[i] );
+					rtf_merge_append( buffer, copy, c - copy );
+					rtf_merge_append( buffer, number, strlen(number) );
+					copy = c;
+					break;
+				}
+			}
+		}
+		else if ( *c == '\\' && c[1] != '\0' )
+			c += 2;
+		else
+			c++;
+	}
+	rtf_merge_append( buffer, copy, c - copy );
+}
+
+
+// Registers RTF document list tables in merged list tables
+void rtf_merge_lists(RTF_MERGER* merger, RTF_MERGE_DOCUMENT* document)
+{
+	// List is numbered by list id (and template id), list override by list id and list override number
+	const char* listNames[] = { "listid", "listtemplateid", NULL };
+	const char* overrideNames[] = { "listid", "ls", NULL };
+
+	// Count list and list override table entries
+	int listCapacity = 0, overrideCapacity = 0;
+	char* c;
+	for ( c = document->listTable; *c != '\0'; c++ )
+	{
+		if ( *c == '{' )
+			listCapacity++;
+	}
+	for ( c = document->overrideTable; *c != '\0'; c++ )
+	{
+		if ( *c == '{' )
+			overrideCapacity++;
+	}
+	int* listIds = new int[listCapacity+1];
+	int* listIndexes = new int[listCapacity+1];
+	int listCount = 0;
+	document->overrideNumbers = new int[overrideCapacity+1];
+	document->overrideIndexes = new int[overrideCapacity+1];
+	document->overrideCount = 0;
+
+	for ( int table=0; table<2; table++ )
+	{
+		char* entry = ( table == 0 ? document->listTable : document->overrideTable );
+		while ( ( entry = strchr( entry, '{' ) ) != NULL )
+		{
+			int depth = 0;
+			char* end = entry + 1;
+			while ( *end != '\0' )
+			{
+				if ( *end == '\\' && end[1] != '\0' )
+					end++;
+				else if ( *end == '{' )
+					depth++;
+				else if ( *end == '}' )
+				{
+					if ( depth == 0 )
+						break;
+					depth--;
+				}
+				end++;
+			}
+			if ( *end != '}' )
+				break;
+
+			char* key = new char[end-entry+32];
+			int numbers[2];
+			if ( table == 0 )
+			{
+				// List entry key is list group without list id
+				rtf_merge_listkey( entry, end+1, key, listNames, numbers );
+				int index = rtf_hash_find( &merger->listHash, key );
+				if ( index < 0 )
+				{
+					index = merger->listCount++;
+					rtf_hash_insert( &merger->listHash, key, index );
+
+					int ids[2] = { index+1, index+1 };
+					rtf_merge_listgroup( &merger->listTable, key, listNames, ids );
+				}
+				listIds[listCount] = numbers[0];
+				listIndexes[listCount] = index;
+				listCount++;
+			}
+			else
+			{
+				// List override entry key is list override group without numbers (and merged list id)
+				rtf_merge_listkey( entry, end+1, key, overrideNames, numbers );
+				int list = -1;
+				for ( int i=0; i<listCount; i++ )
+				{
+					if ( listIds[i] == numbers[0] )
+					{
+						list = listIndexes[i];
+						break;
+					}
+				}
+
+				// List override of unknown list is dropped
+				if ( list >= 0 )
+				{
+					size_t length = strlen(key);
+					sprintf( key + length, "%d", list+1 );
+					int index = rtf_hash_find( &merger->overrideHash, key );
+					if ( index < 0 )
+					{
+						index = merger->overrideCount++;
+						rtf_hash_insert( &merger->overrideHash, key, index );
+
+						key[length] = '\0';
+						int ids[2] = { list+1, index+1 };
+						rtf_merge_listgroup( &merger->overrideTable, key, overrideNames, ids );
+					}
+					document->overrideNumbers[document->overrideCount] = numbers[1];
+					document->overrideIndexes[document->overrideCount] = index+1;
+					document->overrideCount++;
+				}
+			}
+			delete []key;
+			entry = end + 1;
+		}
+	}
+
+	delete []listIds;
+	delete []listIndexes;
+	delete []document->listTable;
+	document->listTable = NULL;
+	delete []document->overrideTable;
+	document->overrideTable = NULL;
+}
+
+
+// Rewrites RTF reader event of merged document
+bool rtf_merge_event(RTF_READER_EVENT* event, void* param)
+{
+	RTF_MERGE_DOCUMENT* document = (RTF_MERGE_DOCUMENT*)param;
+
+	// Merged list tables follow header tables of first document
+	if ( document->documentIndex == 0 && !document->listsWritten && event->eventOffset >= document->bodyStart )
+		rtf_merge_listtables( document );
+
+	// Skip replaced group
+	if ( document->skipDepth > 0 )
+	{
+		if ( event->eventType == RTF_READEREVENT_GROUPCLOSE && event->groupDepth < document->skipDepth )
+		{
+			document->skipDepth = 0;
+			document->copyPosition = event->eventOffset + 1;
+		}
+		return true;
+	}
+
+	// Top-level group is named by its first control word (after \*)
+	if ( event->eventType == RTF_READEREVENT_GROUPOPEN && event->groupDepth == 2 )
+	{
+		document->groupStart = true;
+		document->groupPosition = event->eventOffset;
+		return true;
+	}
+	if ( event->eventType == RTF_READEREVENT_CONTROLSYMBOL && event->eventData[0] == '*' && document->groupStart )
+		return true;
+	bool groupStart = document->groupStart;
+	document->groupStart = false;
+	if ( event->eventType != RTF_READEREVENT_CONTROLWORD )
+		return true;
+
+	if ( groupStart )
+	{
+		// Header tables of first document are replaced by merged tables, other documents have no header groups
+		RTF_MERGER* merger = document->documentMerger;
+		bool tables = false, skip = false;
+		if ( document->documentIndex == 0 && event->eventSize == 7 && strncmp( event->eventData, "fonttbl", 7 ) == 0 )
+		{
+			tables = true;
+			skip = true;
+		}
+		else if ( document->documentIndex == 0 && event->eventSize == 8 && strncmp( event->eventData, "colortbl", 8 ) == 0 )
+			skip = true;
+		else if ( document->documentIndex == 0 && event->eventSize == 9 && strncmp( event->eventData, "listtable", 9 ) == 0 )
+			skip = true;
+		else if ( document->documentIndex == 0 && event->eventSize == 17 && strncmp( event->eventData, "listoverridetable", 17 ) == 0 )
+			skip = true;
+		else if ( document->documentIndex > 0 && event->eventSize == 4 && strncmp( event->eventData, "info", 4 ) == 0 )
+			skip = true;
+		else if ( document->documentIndex > 0 && event->eventSize == 9 && strncmp( event->eventData, "generator", 9 ) == 0 )
+			skip = true;
+
+		if ( skip )
+		{
+			rtf_merge_copy( document, document->groupPosition );
+			if ( tables )
+			{
+				rtf_merge_append( &document->documentOutput, merger->fontTable.bufferData, merger->fontTable.bufferSize );
+				rtf_merge_append( &document->documentOutput, merger->colorTable.bufferData, merger->colorTable.bufferSize );
+			}
+			document->skipDepth = 2;
+			return true;
+		}
+	}
+
+	// Control word ends after parameter (delimiter is copied)
+	size_t end = event->eventOffset + 1 + event->eventSize;
+	while ( end < document->fileSize && ( document->fileData[end] == '-' || ( document->fileData[end] >= '0' && document->fileData[end] <= '9' ) ) )
+		end++;
+	bool afterWord = ( document->wordEnd == event->eventOffset );
+	document->wordEnd = end;
+
+	// Find font, color, list or style control word
+	char name[64];
+	if ( event->eventSize >= sizeof(name) )
+		return true;
+	memcpy( name, event->eventData, event->eventSize );
+	name[event->eventSize] = '\0';
+	int word = rtf_hash_find( &rtfMergeHash, name );
+	if ( word < 0 )
+		return true;
+
+	int number = -1;
+	if ( rtfMergeWords[word].wordKind == RTF_MERGEWORD_STYLE )
+	{
+		// Style sheet of first document is kept, style references of other documents are dropped with their style sheets
+		if ( document->documentIndex == 0 )
+			return true;
+
+		// Delimiter is dropped too, unless it ends preceding control word (it then ends at dropped word end)
+		if ( !afterWord && end < document->fileSize && document->fileData[end] == ' ' )
+			end++;
+		document->wordEnd = ( afterWord ? end : 0 );
+		strcpy( name, "" );
+	}
+	else if ( rtfMergeWords[word].wordKind == RTF_MERGEWORD_PLAIN )
+	{
+		// Default font of document differs from merged default font
+		if ( document->plainFont < 0 )
+			return true;
+		sprintf( name, "\\plain\\f%d", document->plainFont );
+	}
+	else
+	{
+		if ( !event->hasParameter || event->eventParameter < 0 )
+			return true;
+		if ( rtfMergeWords[word].wordKind == RTF_MERGEWORD_FONT && event->eventParameter < document->fontMapSize )
+			number = document->fontMap[event->eventParameter];
+		else if ( rtfMergeWords[word].wordKind == RTF_MERGEWORD_COLOR && event->eventParameter < document->colorCount )
+			number = document->colorIndexes[event->eventParameter];
+		else if ( rtfMergeWords[word].wordKind == RTF_MERGEWORD_LIST && event->eventParameter < document->overrideMapSize )
+			number = document->overrideMap[event->eventParameter];
+
+		// Unknown or unchanged number is copied
+		if ( number < 0 || number == event->eventParameter )
+			return true;
+		sprintf( name, "\\%s%d", rtfMergeWords[word].wordName, number );
+	}
+
+	// Copy data before control word and write rewritten control word
+	rtf_merge_copy( document, event->eventOffset );
+	rtf_merge_append( &document->documentOutput, name, strlen(name) );
+	document->copyPosition = end;
+
+	return true;
+}
+
+
+// Writes merged list tables after header tables of first document
+void rtf_merge_listtables(RTF_MERGE_DOCUMENT* document)
+{
+	RTF_MERGER* merger = document->documentMerger;
+	rtf_merge_copy( document, document->bodyStart );
+	if ( merger->listCount > 0 )
+	{
+		rtf_merge_append( &document->documentOutput, merger->listTable.bufferData, merger->listTable.bufferSize );
+		rtf_merge_append( &document->documentOutput, merger->overrideTable.bufferData, merger->overrideTable.bufferSize );
+	}
+	document->listsWritten = true;
+}
+
+
+// Copies RTF document data up to position
+void rtf_merge_copy(RTF_MERGE_DOCUMENT* document, size_t position)
+{
+	if ( position > document->copyPosition )
+		rtf_merge_append( &document->documentOutput, document->fileData + document->copyPosition, position - document->copyPosition );
+	document->copyPosition = position;
+}
+
+
+// Rewrites RTF document with merged font, color and list numbers
+bool rtf_merge_body(RTF_MERGE_DOCUMENT* document)
+{
+	// Read RTF file
+	FILE* file = fopen( document->fileName, "rb" );
+	if ( file == NULL )
+	{
+		document->documentError = RTF_OPEN_ERROR;
+		return false;
+	}
+	fseek( file, 0, SEEK_END );
+	document->fileSize = ftell(file);
+	fseek( file, 0, SEEK_SET );
+	document->fileData = new char[document->fileSize+1];
+	if ( fread( document->fileData, 1, document->fileSize, file ) < document->fileSize )
+		document->documentError = RTF_READER_ERROR;
+	fclose(file);
+
+	// Document ends with "}" (and white space)
+	size_t end = document->fileSize;
+	while ( end > 0 && ( document->fileData[end-1] == '\r' || document->fileData[end-1] == '\n' || document->fileData[end-1] == ' ' || document->fileData[end-1] == '\0' ) )
+		end--;
+	if ( document->documentError == RTF_SUCCESS && ( end == 0 || document->fileData[end-1] != '}' || end-1 < document->bodyStart ) )
+		document->documentError = RTF_MERGE_ERROR;
+	if ( document->documentError != RTF_SUCCESS )
+		return false;
+	end--;
+
+	// Build font number map
+	int i;
+	document->fontMapSize = 0;
+	for ( i=0; i<document->fontCount; i++ )
+	{
+		if ( document->fontNumbers[i] >= document->fontMapSize && document->fontNumbers[i] <= RTF_MERGE_MAXFONTNUMBER )
+			document->fontMapSize = document->fontNumbers[i] + 1;
+	}
+	document->fontMap = new int[document->fontMapSize+1];
+	for ( i=0; i<document->fontMapSize; i++ )
+		document->fontMap[i] = -1;
+	for ( i=0; i<document->fontCount; i++ )
+	{
+		if ( document->fontNumbers[i] >= 0 && document->fontNumbers[i] < document->fontMapSize && document->fontMap[document->fontNumbers[i]] < 0 )
+			document->fontMap[document->fontNumbers[i]] = document->fontIndexes[i];
+	}
+
+	// Build list override number map
+	document->overrideMapSize = 0;
+	for ( i=0; i<document->overrideCount; i++ )
+	{
+		if ( document->overrideNumbers[i] >= document->overrideMapSize && document->overrideNumbers[i] <= RTF_MERGE_MAXLISTNUMBER )
+			document->overrideMapSize = document->overrideNumbers[i] + 1;
+	}
+	document->overrideMap = new int[document->overrideMapSize+1];
+	for ( i=0; i<document->overrideMapSize; i++ )
+		document->overrideMap[i] = -1;
+	for ( i=0; i<document->overrideCount; i++ )
+	{
+		if ( document->overrideNumbers[i] >= 0 && document->overrideNumbers[i] < document->overrideMapSize && document->overrideMap[document->overrideNumbers[i]] < 0 )
+			document->overrideMap[document->overrideNumbers[i]] = document->overrideIndexes[i];
+	}
+
+	// First document is rewritten from start, other documents from end of header tables (inside document group)
+	size_t start = ( document->documentIndex == 0 ? 0 : document->bodyStart );
+	RTF_READER reader;
+	rtf_reader_init( &reader, rtf_merge_event, document );
+	reader.readerOffset = start;
+	reader.groupDepth = ( document->documentIndex == 0 ? 0 : 1 );
+	document->copyPosition = start;
+	document->skipDepth = 0;
+	document->groupStart = false;
+	document->wordEnd = 0;
+	document->documentOutput.bufferSize = 0;
+	document->listsWritten = false;
+
+	// Rewrite document content (without closing "}") and copy rest
+	rtf_reader_parse( &reader, document->fileData + start, end - start, true );
+	if ( document->documentIndex == 0 && !document->listsWritten )
+		rtf_merge_listtables( document );
+	if ( document->skipDepth == 0 )
+		rtf_merge_copy( document, end );
+
+	delete []document->fileData;
+	document->fileData = NULL;
+	delete []document->fontMap;
+	document->fontMap = NULL;
+	delete []document->overrideMap;
+	document->overrideMap = NULL;
+
+	return true;
+}
+
+
+// Reads RTF document headers on worker thread
+DWORD WINAPI rtf_merge_headerjob(LPVOID param)
+{
+	RTF_MERGE_WORKER* worker = (RTF_MERGE_WORKER*)param;
+	for ( int i=0; i<worker->documentCount; i+=worker->documentStep )
+	{
+		RTF_TRACE_START(traceStart);
+		rtf_merge_header( &worker->workerDocuments[i] );
+		RTF_TRACE( rtf_trace_end( "merge header", &traceStart, worker->workerDocuments[i].documentIndex ) );
+	}
+	rtf_trace_release();
+	return 0;
+}
+
+
+// Rewrites RTF documents on worker thread
+DWORD WINAPI rtf_merge_bodyjob(LPVOID param)
+{
+	RTF_MERGE_WORKER* worker = (RTF_MERGE_WORKER*)param;
+	for ( int i=0; i<worker->documentCount; i+=worker->documentStep )
+	{
+		RTF_TRACE_START(traceStart);
+		rtf_merge_body( &worker->workerDocuments[i] );
+		RTF_TRACE( rtf_trace_end( "merge body", &traceStart, worker->workerDocuments[i].documentIndex ) );
+	}
+	rtf_trace_release();
+	return 0;
+}
+
+
+// Runs RTF merge jobs on worker threads
+void rtf_merge_run(LPTHREAD_START_ROUTINE job, RTF_MERGE_DOCUMENT* documents, int count, int threads)
+{
+	// Worker takes every n-th document of batch
+	RTF_MERGE_WORKER workers[RTF_READER_MAXTHREADS];
+	HANDLE handles[RTF_READER_MAXTHREADS];
+	if ( threads > count )
+		threads = count;
+	int i;
+	for ( i=0; i<threads; i++ )
+	{
+		workers[i].workerDocuments = documents + i;
+		workers[i].documentCount = count - i;
+		workers[i].documentStep = threads;
+	}
+
+	// Single worker runs on calling thread
+	if ( threads == 1 )
+	{
+		job( &workers[0] );
+		return;
+	}
+
+	for ( i=0; i<threads; i++ )
+		handles[i] = CreateThread( NULL, 0, job, &workers[i], 0, NULL );
+	for ( i=0; i<threads; i++ )
+	{
+		// Run job on calling thread if thread could not be created
+		if ( handles[i] == NULL )
+			job( &workers[i] );
+	}
+	for ( i=0; i<threads; i++ )
+	{
+		if ( handles[i] != NULL )
+		{
+			WaitForSingleObject( handles[i], INFINITE );
+			CloseHandle( handles[i] );
+		}
+	}
+}
+
+
+// Frees RTF merge document data
+void rtf_merge_free(RTF_MERGE_DOCUMENT* document)
+{
+	delete []document->fontTable;
+	document->fontTable = NULL;
+	delete []document->colorTable;
+	document->colorTable = NULL;
+	delete []document->listTable;
+	document->listTable = NULL;
+	delete []document->overrideTable;
+	document->overrideTable = NULL;
+	delete []document->fontNumbers;
+	document->fontNumbers = NULL;
+	delete []document->fontIndexes;
+	document->fontIndexes = NULL;
+	delete []document->colorIndexes;
+	document->colorIndexes = NULL;
+	delete []document->fontMap;
+	document->fontMap = NULL;
+	delete []document->overrideNumbers;
+	document->overrideNumbers = NULL;
+	delete []document->overrideIndexes;
+	document->overrideIndexes = NULL;
+	delete []document->overrideMap;
+	document->overrideMap = NULL;
+	delete []document->fileData;
+	document->fileData = NULL;
+	delete []document->documentOutput.bufferData;
+	document->documentOutput.bufferData = NULL;
+	document->documentOutput.bufferSize = 0;
+	document->documentOutput.bufferCapacity = 0;
+}
+
+
+// Merges RTF files with unified font, color and list tables
+int rtf_merge(char** filenames, int count, char* outname, int threads)
+{
+	// Set error flag
+	int error = RTF_SUCCESS;
+	int i, first;
+
+	if ( count <= 0 )
+		return RTF_MERGE_ERROR;
+
+	// Get number of threads
+	if ( threads <= 0 )
+	{
+		SYSTEM_INFO info;
+		GetSystemInfo( &info );
+		threads = info.dwNumberOfProcessors;
+	}
+	if ( threads > RTF_READER_MAXTHREADS )
+		threads = RTF_READER_MAXTHREADS;
+
+	// Create merged RTF file
+	FILE* file = fopen( outname, "wb" );
+	if ( file == NULL )
+		return RTF_OPEN_ERROR;
+
+	RTF_MERGER merger;
+	rtf_merge_init( &merger );
+	RTF_MERGE_DOCUMENT* documents = new RTF_MERGE_DOCUMENT[count];
+	memset( documents, 0, count*sizeof(RTF_MERGE_DOCUMENT) );
+	for ( i=0; i<count; i++ )
+	{
+		documents[i].fileName = filenames[i];
+		documents[i].documentIndex = i;
+		documents[i].documentError = RTF_SUCCESS;
+		documents[i].documentMerger = &merger;
+	}
+
+	// Read document headers in parallel batches and register tables in document order
+	int batch = threads*RTF_MERGE_BATCHSIZE;
+	for ( first=0; first<count && error==RTF_SUCCESS; first+=batch )
+	{
+		int size = ( count - first < batch ? count - first : batch );
+		rtf_merge_run( rtf_merge_headerjob, documents + first, size, threads );
+		for ( i=first; i<first+size && error==RTF_SUCCESS; i++ )
+		{
+			if ( documents[i].documentError != RTF_SUCCESS )
+				error = documents[i].documentError;
+			else
+				rtf_merge_tables( &merger, &documents[i] );
+		}
+	}
+	rtf_merge_append( &merger.fontTable, "}", 1 );
+	rtf_merge_append( &merger.colorTable, "}", 1 );
+	rtf_merge_append( &merger.listTable, "}", 1 );
+	rtf_merge_append( &merger.overrideTable, "}", 1 );
+
+	// Rewrite documents in parallel batches and write them in document order
+	for ( first=0; first<count && error==RTF_SUCCESS; first+=batch )
+	{
+		int size = ( count - first < batch ? count - first : batch );
+		rtf_merge_run( rtf_merge_bodyjob, documents + first, size, threads );
+		for ( i=first; i<first+size; i++ )
+		{
+			RTF_MERGE_DOCUMENT* document = &documents[i];
+			if ( error == RTF_SUCCESS && document->documentError != RTF_SUCCESS )
+				error = document->documentError;
+			if ( error == RTF_SUCCESS )
+			{
+				// Document starts new section with default formatting
+				if ( i > 0 )
+				{
+					char separator[64];
+					if ( document->plainFont >= 0 )
+						sprintf( separator, "\n\\sect\\sectd\\pard\\plain\\f%d ", document->plainFont );
+					else
+						strcpy( separator, "\n\\sect\\sectd\\pard\\plain " );
+					if ( fwrite( separator, 1, strlen(separator), file ) < strlen(separator) )
+						error = RTF_MERGE_ERROR;
+				}
+				if ( fwrite( document->documentOutput.bufferData, 1, document->documentOutput.bufferSize, file ) < document->documentOutput.bufferSize )
+					error = RTF_MERGE_ERROR;
+			}
+			rtf_merge_free( document );
+		}
+	}
+
+	// Write RTF document end part
+	if ( error == RTF_SUCCESS && fwrite( "}", 1, 1, file ) < 1 )
+		error = RTF_MERGE_ERROR;
+
+	// Close merged RTF file
+	if ( fclose(file) && error == RTF_SUCCESS )
+		error = RTF_MERGE_ERROR;
+
+	// Free merge data
+	for ( i=0; i<count; i++ )
+		rtf_merge_free( &documents[i] );
+	delete []documents;
+	rtf_hash_clear( &merger.fontHash );
+	delete []merger.fontHash.tableEntries;
+	rtf_hash_clear( &merger.colorHash );
+	delete []merger.colorHash.tableEntries;
+	rtf_hash_clear( &merger.listHash );
+	delete []merger.listHash.tableEntries;
+	rtf_hash_clear( &merger.overrideHash );
+	delete []merger.overrideHash.tableEntries;
+	delete []merger.fontTable.bufferData;
+	delete []merger.colorTable.bufferData;
+	delete []merger.listTable.bufferData;
+	delete []merger.overrideTable.bufferData;
+
+	// Return error flag
+	return error;
+}
@@ -0,0 +1,702 @@
+#include "errors.h"
+#include "globals.h"
+#include "rtflib.h"
+
+
+
+// RTF minifier global params
+RTF_MINIFY_WORD rtfMinifyWords[] = {
+	// Paragraph formatting
+	{ "pard", RTF_MINIFYPROPERTY_PARD, 0, 0 },
+	{ "ql", RTF_MINIFYPROPERTY_ALIGN, 0, 0 },
+	{ "qc", RTF_MINIFYPROPERTY_ALIGN, 1, 0 },
+	{ "qr", RTF_MINIFYPROPERTY_ALIGN, 2, 0 },
+	{ "qj", RTF_MINIFYPROPERTY_ALIGN, 3, 0 },
+	{ "qd", RTF_MINIFYPROPERTY_ALIGN, 4, 0 },
+	{ "fi", RTF_MINIFYPROPERTY_FI, RTF_MINIFYVALUE_PARAMETER, 0 },
+	{ "li", RTF_MINIFYPROPERTY_LI, RTF_MINIFYVALUE_PARAMETER, 0 },
+	{ "ri", RTF_MINIFYPROPERTY_RI, RTF_MINIFYVALUE_PARAMETER, 0 },
+	{ "sb", RTF_MINIFYPROPERTY_SB, RTF_MINIFYVALUE_PARAMETER, 0 },
+	{ "sa", RTF_MINIFYPROPERTY_SA, RTF_MINIFYVALUE_PARAMETER, 0 },
+	{ "sl", RTF_MINIFYPROPERTY_SL, RTF_MINIFYVALUE_PARAMETER, 0 },
+	{ "slmult", RTF_MINIFYPROPERTY_SLMULT, RTF_MINIFYVALUE_PARAMETER, 0 },
+	{ "intbl", RTF_MINIFYPROPERTY_INTBL, 1, 0 },
+
+	// Character formatting
+	{ "plain", RTF_MINIFYPROPERTY_PLAIN, 0, 0 },
+	{ "f", RTF_MINIFYPROPERTY_FONT, RTF_MINIFYVALUE_PARAMETER, 0 },
+	{ "fs", RTF_MINIFYPROPERTY_SIZE, RTF_MINIFYVALUE_PARAMETER, 24 },
+	{ "cf", RTF_MINIFYPROPERTY_COLOR, RTF_MINIFYVALUE_PARAMETER, 0 },
+	{ "cb", RTF_MINIFYPROPERTY_BACKCOLOR, RTF_MINIFYVALUE_PARAMETER, 0 },
+	{ "b", RTF_MINIFYPROPERTY_BOLD, RTF_MINIFYVALUE_TOGGLE, 1 },
+	{ "i", RTF_MINIFYPROPERTY_ITALIC, RTF_MINIFYVALUE_TOGGLE, 1 },
+	{ "caps", RTF_MINIFYPROPERTY_CAPS, RTF_MINIFYVALUE_TOGGLE, 1 },
+	{ "scaps", RTF_MINIFYPROPERTY_SCAPS, RTF_MINIFYVALUE_TOGGLE, 1 },
+	{ "strike", RTF_MINIFYPROPERTY_STRIKE, RTF_MINIFYVALUE_TOGGLE, 1 },
+	{ "striked", RTF_MINIFYPROPERTY_STRIKED, RTF_MINIFYVALUE_TOGGLE, 1 },
+	{ "outl", RTF_MINIFYPROPERTY_OUTLINE, RTF_MINIFYVALUE_TOGGLE, 1 },
+	{ "shad", RTF_MINIFYPROPERTY_SHADOW, RTF_MINIFYVALUE_TOGGLE, 1 },
+	{ "embo", RTF_MINIFYPROPERTY_EMBOSS, RTF_MINIFYVALUE_TOGGLE, 1 },
+	{ "impr", RTF_MINIFYPROPERTY_ENGRAVE, RTF_MINIFYVALUE_TOGGLE, 1 },
+	{ "v", RTF_MINIFYPROPERTY_HIDDEN, RTF_MINIFYVALUE_TOGGLE, 1 },
+	{ "animtext", RTF_MINIFYPROPERTY_ANIMTEXT, RTF_MINIFYVALUE_PARAMETER, 0 },
+	{ "expndtw", RTF_MINIFYPROPERTY_EXPANDTW, RTF_MINIFYVALUE_PARAMETER, 0 },
+	{ "kerning", RTF_MINIFYPROPERTY_KERNING, RTF_MINIFYVALUE_PARAMETER, 0 },
+	{ "charscalex", RTF_MINIFYPROPERTY_CHARSCALEX, RTF_MINIFYVALUE_PARAMETER, 100 },
+	{ "ulnone", RTF_MINIFYPROPERTY_UNDERLINE, 0, 0 },
+	{ "ul", RTF_MINIFYPROPERTY_UNDERLINE, 1, 0 },
+	{ "uld", RTF_MINIFYPROPERTY_UNDERLINE, 2, 0 },
+	{ "uldb", RTF_MINIFYPROPERTY_UNDERLINE, 3, 0 },
+	{ "ulw", RTF_MINIFYPROPERTY_UNDERLINE, 4, 0 },
+	{ "ulwave", RTF_MINIFYPROPERTY_UNDERLINE, 5, 0 },
+	{ "uldash", RTF_MINIFYPROPERTY_UNDERLINE, 6, 0 },
+	{ "uldashd", RTF_MINIFYPROPERTY_UNDERLINE, 7, 0 },
+	{ "uldashdd", RTF_MINIFYPROPERTY_UNDERLINE, 8, 0 },
+	{ "ulth", RTF_MINIFYPROPERTY_UNDERLINE, 9, 0 },
+	{ "ulthd", RTF_MINIFYPROPERTY_UNDERLINE, 10, 0 },
+	{ "ulthdash", RTF_MINIFYPROPERTY_UNDERLINE, 11, 0 },
+	{ "ulthdashd", RTF_MINIFYPROPERTY_UNDERLINE, 12, 0 },
+	{ "ulthdashdd", RTF_MINIFYPROPERTY_UNDERLINE, 13, 0 },
+	{ "ulhwave", RTF_MINIFYPROPERTY_UNDERLINE, 14, 0 },
+	{ "ululdbwave", RTF_MINIFYPROPERTY_UNDERLINE, 15, 0 },
+	{ "ulldash", RTF_MINIFYPROPERTY_UNDERLINE, 16, 0 },
+	{ "nosupersub", RTF_MINIFYPROPERTY_SCRIPT, 0, 0 },
+	{ "super", RTF_MINIFYPROPERTY_SCRIPT, 1, 0 },
+	{ "sub", RTF_MINIFYPROPERTY_SCRIPT, 2, 0 },
+
+	// Document content (formatting is written before it)
+	{ "par", RTF_MINIFYPROPERTY_NONE, 0, 0 },
+	{ "line", RTF_MINIFYPROPERTY_NONE, 0, 0 },
+	{ "tab", RTF_MINIFYPROPERTY_NONE, 0, 0 },
+	{ "cell", RTF_MINIFYPROPERTY_NONE, 0, 0 },
+	{ "row", RTF_MINIFYPROPERTY_NONE, 0, 0 },
+	{ "page", RTF_MINIFYPROPERTY_NONE, 0, 0 },
+	{ "column", RTF_MINIFYPROPERTY_NONE, 0, 0 },
+	{ "sect", RTF_MINIFYPROPERTY_NONE, 0, 0 },
+	{ "emdash", RTF_MINIFYPROPERTY_NONE, 0, 0 },
+	{ "endash", RTF_MINIFYPROPERTY_NONE, 0, 0 },
+	{ "bullet", RTF_MINIFYPROPERTY_NONE, 0, 0 },
+	{ "lquote", RTF_MINIFYPROPERTY_NONE, 0, 0 },
+	{ "rquote", RTF_MINIFYPROPERTY_NONE, 0, 0 },
+	{ "ldblquote", RTF_MINIFYPROPERTY_NONE, 0, 0 },
+	{ "rdblquote", RTF_MINIFYPROPERTY_NONE, 0, 0 },
+	{ "chpgn", RTF_MINIFYPROPERTY_NONE, 0, 0 },
+	{ "u", RTF_MINIFYPROPERTY_NONE, 0, 0 },
+	{ "uc", RTF_MINIFYPROPERTY_NONE, 0, 0 },
+	{ NULL, 0, 0, 0 } };
+RTF_HASH_TABLE rtfMinifyHash = {NULL, 0, 0};
+extern char rtfHexDigits[];							// Hexadecimal digits (rtflib.cpp)
+
+
+
+// Initializes RTF minifier
+void rtf_minify_init(RTF_MINIFIER* minifier, FILE* file, bool binaryPictures)
+{
+	// Index formatting control words
+	if ( rtfMinifyHash.entryCount == 0 )
+	{
+		for ( int i=0; rtfMinifyWords[i].wordName != NULL; i++ )
+			rtf_hash_insert( &rtfMinifyHash, (char*)rtfMinifyWords[i].wordName, i );
+	}
+
+	minifier->outputFile = file;
+	minifier->outputBuffer = new char[RTF_MINIFY_BUFFERSIZE];
+	minifier->outputSize = 0;
+	minifier->outputTotal = 0;
+	minifier->writeError = false;
+	minifier->needSpace = false;
+	minifier->binaryPictures = binaryPictures;
+
+	// Set formatting state after \pard and \plain (colors are automatic)
+	RTF_MINIFY_STATE* state = &minifier->defaultState;
+	memset( state, 0, sizeof(RTF_MINIFY_STATE) );
+	state->propertyValues[RTF_MINIFYPROPERTY_SIZE] = 24;
+	state->propertyValues[RTF_MINIFYPROPERTY_COLOR] = -1;
+	state->propertyValues[RTF_MINIFYPROPERTY_BACKCOLOR] = -1;
+	state->propertyValues[RTF_MINIFYPROPERTY_CHARSCALEX] = 100;
+	state->paragraphKnown = true;
+	state->characterKnown = true;
+
+	// Formatting state of document start is unknown
+	minifier->stateCapacity = 64;
+	minifier->groupStates = new RTF_MINIFY_STATE[minifier->stateCapacity];
+	minifier->groupStates[0] = minifier->defaultState;
+	minifier->groupStates[0].paragraphKnown = false;
+	minifier->groupStates[0].characterKnown = false;
+	minifier->groupDepth = 0;
+	minifier->groupStart = false;
+	minifier->pendingWords = false;
+	minifier->extrasStart = 0;
+	minifier->verbatimDepth = 0;
+	minifier->pictureDepth = 0;
+	minifier->pictureSafe = false;
+	minifier->pictureData = NULL;
+	minifier->pictureSize = 0;
+	minifier->pictureCapacity = 0;
+}
+
+
+// Minifies RTF reader event
+bool rtf_minify_event(RTF_READER_EVENT* event, void* param)
+{
+	RTF_MINIFIER* minifier = (RTF_MINIFIER*)param;
+	int depth = ( event->groupDepth > 0 ? event->groupDepth : 0 );
+
+	if ( minifier->pictureDepth > 0 )
+	{
+		// Buffer picture data
+		if ( event->eventType == RTF_READEREVENT_TEXT && event->groupDepth == minifier->pictureDepth && minifier->pictureSafe )
+		{
+			if ( minifier->pictureSize + event->eventSize > minifier->pictureCapacity )
+			{
+				size_t capacity = 2*( minifier->pictureSize + event->eventSize );
+				char* data = new char[capacity];
+				memcpy( data, minifier->pictureData, minifier->pictureSize );
+				delete []minifier->pictureData;
+				minifier->pictureData = data;
+				minifier->pictureCapacity = capacity;
+			}
+			memcpy( minifier->pictureData + minifier->pictureSize, event->eventData, event->eventSize );
+			minifier->pictureSize += event->eventSize;
+			return !minifier->writeError;
+		}
+
+		// Picture data must end with picture group, otherwise it is written unchanged
+		if ( minifier->pictureSize > 0 && ( event->eventType != RTF_READEREVENT_GROUPCLOSE || event->groupDepth >= minifier->pictureDepth ) )
+			minifier->pictureSafe = false;
+		rtf_minify_picture( minifier );
+		if ( event->eventType == RTF_READEREVENT_GROUPCLOSE && event->groupDepth < minifier->pictureDepth )
+			minifier->pictureDepth = 0;
+	}
+
+	// Destination group is written unchanged
+	if ( minifier->verbatimDepth > 0 )
+	{
+		rtf_minify_token( minifier, event );
+		if ( event->eventType == RTF_READEREVENT_GROUPCLOSE && event->groupDepth < minifier->verbatimDepth )
+		{
+			minifier->verbatimDepth = 0;
+			minifier->groupDepth = depth;
+		}
+		return !minifier->writeError;
+	}
+	bool groupStart = minifier->groupStart;
+	minifier->groupStart = false;
+
+	if ( event->eventType == RTF_READEREVENT_GROUPOPEN )
+	{
+		// Group starts with formatting state of enclosing group
+		rtf_minify_flush( minifier );
+		rtf_minify_token( minifier, event );
+		if ( depth >= minifier->stateCapacity )
+		{
+			RTF_MINIFY_STATE* states = new RTF_MINIFY_STATE[2*minifier->stateCapacity];
+			memcpy( states, minifier->groupStates, minifier->stateCapacity*sizeof(RTF_MINIFY_STATE) );
+			delete []minifier->groupStates;
+			minifier->groupStates = states;
+			minifier->stateCapacity *= 2;
+		}
+		if ( depth > 0 )
+			minifier->groupStates[depth] = minifier->groupStates[depth-1];
+		minifier->groupDepth = depth;
+		minifier->groupStart = true;
+	}
+	else if ( event->eventType == RTF_READEREVENT_GROUPCLOSE )
+	{
+		// Formatting at group end has no effect
+		minifier->pendingWords = false;
+		rtf_minify_token( minifier, event );
+		minifier->groupDepth = depth;
+	}
+	else if ( event->eventType == RTF_READEREVENT_CONTROLWORD )
+	{
+		int index = rtf_minify_lookup( event );
+		bool document = ( event->eventSize == 3 && strncmp( event->eventData, "rtf", 3 ) == 0 );
+
+		if ( groupStart && !document && ( index < 0 || rtfMinifyWords[index].wordProperty == RTF_MINIFYPROPERTY_NONE ) )
+		{
+			// Destination group (hexadecimal picture data is buffered for \bin)
+			minifier->verbatimDepth = event->groupDepth;
+			if ( minifier->binaryPictures && event->eventSize == 4 && strncmp( event->eventData, "pict", 4 ) == 0 )
+			{
+				minifier->pictureDepth = event->groupDepth;
+				minifier->pictureSafe = true;
+				minifier->pictureSize = 0;
+			}
+			rtf_minify_token( minifier, event );
+		}
+		else if ( index >= 0 && rtfMinifyWords[index].wordProperty == RTF_MINIFYPROPERTY_PARD )
+		{
+			// Reset paragraph formatting
+			rtf_minify_begin( minifier );
+			RTF_MINIFY_STATE* state = &minifier->pendingState;
+			for ( int i=0; i<RTF_MINIFY_PARAGRAPHPROPERTIES; i++ )
+			{
+				state->propertyValues[i] = minifier->defaultState.propertyValues[i];
+				minifier->pendingTouched[i] = false;
+			}
+			state->paragraphKnown = true;
+			state->paragraphExtras[0] = '\0';
+			minifier->extrasStart = 0;
+		}
+		else if ( index >= 0 && rtfMinifyWords[index].wordProperty == RTF_MINIFYPROPERTY_PLAIN )
+		{
+			// Reset character formatting
+			rtf_minify_begin( minifier );
+			RTF_MINIFY_STATE* state = &minifier->pendingState;
+			for ( int i=RTF_MINIFY_PARAGRAPHPROPERTIES; i<RTF_MINIFY_PROPERTIES; i++ )
+			{
+				state->propertyValues[i] = minifier->defaultState.propertyValues[i];
+				minifier->pendingTouched[i] = false;
+			}
+			state->characterKnown = true;
+		}
+		else if ( index >= 0 && rtfMinifyWords[index].wordProperty >= 0 )
+		{
+			// Set formatting property
+			RTF_MINIFY_WORD* word = &rtfMinifyWords[index];
+			int value = word->wordValue;
+			if ( value == RTF_MINIFYVALUE_PARAMETER )
+				value = ( event->hasParameter ? event->eventParameter : word->wordDefault );
+			else if ( value == RTF_MINIFYVALUE_TOGGLE )
+				value = ( !event->hasParameter || event->eventParameter != 0 ? 1 : 0 );
+			else if ( event->hasParameter && event->eventParameter == 0 )
+				value = 0;
+			rtf_minify_begin( minifier );
+			minifier->pendingState.propertyValues[word->wordProperty] = value;
+			minifier->pendingTouched[word->wordProperty] = true;
+		}
+		else if ( index < 0 && rtf_minify_extra( minifier, event ) )
+		{
+			// Tab, border or shading paragraph formatting
+		}
+		else
+		{
+			// Document content or other control word (formatting state is unknown after control words
+			// that are not table row or cell properties)
+			rtf_minify_flush( minifier );
+			if ( event->eventSize == 3 && strncmp( event->eventData, "par", 3 ) == 0 )
+				rtf_minify_write( minifier, "\n", 1 );
+			rtf_minify_token( minifier, event );
+			if ( index < 0 && !( event->eventSize >= 2 && ( strncmp( event->eventData, "tr", 2 ) == 0 || strncmp( event->eventData, "cl", 2 ) == 0 ) ) &&
+				!( event->eventSize == 5 && strncmp( event->eventData, "cellx", 5 ) == 0 ) &&
+				!( event->eventSize == 6 && strncmp( event->eventData, "tcelld", 6 ) == 0 ) )
+			{
+				minifier->groupStates[minifier->groupDepth].paragraphKnown = false;
+				minifier->groupStates[minifier->groupDepth].characterKnown = false;
+			}
+
+			// Default font is used by \plain
+			if ( event->eventSize == 4 && strncmp( event->eventData, "deff", 4 ) == 0 )
+				minifier->defaultState.propertyValues[RTF_MINIFYPROPERTY_FONT] = event->eventParameter;
+		}
+	}
+	else if ( event->eventType == RTF_READEREVENT_CONTROLSYMBOL && event->eventData[0] == '*' && groupStart )
+	{
+		// Ignorable destination group
+		minifier->verbatimDepth = event->groupDepth;
+		rtf_minify_token( minifier, event );
+	}
+	else
+	{
+		// Text, characters and binary data
+		rtf_minify_flush( minifier );
+		rtf_minify_token( minifier, event );
+	}
+
+	return !minifier->writeError;
+}
+
+
+// Finds formatting control word
+int rtf_minify_lookup(RTF_READER_EVENT* event)
+{
+	char name[64];
+	if ( event->eventSize >= sizeof(name) )
+		return -1;
+	memcpy( name, event->eventData, event->eventSize );
+	name[event->eventSize] = '\0';
+	return rtf_hash_find( &rtfMinifyHash, name );
+}
+
+
+// Starts pending formatting control words
+void rtf_minify_begin(RTF_MINIFIER* minifier)
+{
+	if ( !minifier->pendingWords )
+	{
+		minifier->pendingWords = true;
+		minifier->pendingState = minifier->groupStates[minifier->groupDepth];
+		memset( minifier->pendingTouched, 0, sizeof(minifier->pendingTouched) );
+		minifier->extrasStart = strlen( minifier->pendingState.paragraphExtras );
+	}
+}
+
+
+// Adds other paragraph control word to pending formatting
+bool rtf_minify_extra(RTF_MINIFIER* minifier, RTF_READER_EVENT* event)
+{
+	// Tab stops, paragraph borders and shading are reset by \pard
+	const char* name = event->eventData;
+	size_t size = event->eventSize;
+	bool extra = ( size == 2 && ( strncmp( name, "tx", 2 ) == 0 || strncmp( name, "tb", 2 ) == 0 ) ) ||
+		( size >= 3 && ( strncmp( name, "tq", 2 ) == 0 || strncmp( name, "tl", 2 ) == 0 || strncmp( name, "bg", 2 ) == 0 ) ) ||
+		( size >= 4 && ( strncmp( name, "brdr", 4 ) == 0 || strncmp( name, "brsp", 4 ) == 0 ) ) ||
+		( size == 3 && strncmp( name, "box", 3 ) == 0 ) ||
+		( size == 7 && strncmp( name, "shading", 7 ) == 0 ) ||
+		( size == 5 && ( strncmp( name, "cfpat", 5 ) == 0 || strncmp( name, "cbpat", 5 ) == 0 ) );
+	if ( !extra )
+		return false;
+
+	// Too many other control words are written unchanged
+	char word[64];
+	if ( size >= 48 )
+		return false;
+	word[0] = '\\';
+	memcpy( word + 1, name, size );
+	word[size+1] = '\0';
+	if ( event->hasParameter )
+		sprintf( word + size + 1, "%d", event->eventParameter );
+	rtf_minify_begin( minifier );
+	char* extras = minifier->pendingState.paragraphExtras;
+	if ( strlen(extras) + strlen(word) >= RTF_MINIFY_EXTRASIZE )
+		return false;
+	strcat( extras, word );
+	return true;
+}
+
+
+// Writes pending formatting control words
+void rtf_minify_flush(RTF_MINIFIER* minifier)
+{
+	if ( !minifier->pendingWords )
+		return;
+	minifier->pendingWords = false;
+
+	// Write paragraph and character formatting changes
+	RTF_MINIFY_STATE* state = &minifier->groupStates[minifier->groupDepth];
+	char words[2048] = "";
+	rtf_minify_part( minifier, state, &minifier->pendingState, true, words );
+	rtf_minify_part( minifier, state, &minifier->pendingState, false, words + strlen(words) );
+	if ( words[0] != '\0' )
+	{
+		rtf_minify_write( minifier, words, strlen(words) );
+		minifier->needSpace = true;
+	}
+
+	*state = minifier->pendingState;
+}
+
+
+// Gets shortest paragraph or character formatting change
+bool rtf_minify_part(RTF_MINIFIER* minifier, RTF_MINIFY_STATE* from, RTF_MINIFY_STATE* to, bool paragraph, char* words)
+{
+	int first = ( paragraph ? 0 : RTF_MINIFY_PARAGRAPHPROPERTIES );
+	int last = ( paragraph ? RTF_MINIFY_PARAGRAPHPROPERTIES : RTF_MINIFY_PROPERTIES );
+	bool fromKnown = ( paragraph ? from->paragraphKnown : from->characterKnown );
+	bool toKnown = ( paragraph ? to->paragraphKnown : to->characterKnown );
+
+	// Reset formatting and set properties that are not default
+	char reset[1024] = "";
+	bool resetValid = false;
+	if ( toKnown )
+	{
+		strcpy( reset, paragraph ? "\\pard" : "\\plain" );
+		resetValid = rtf_minify_diff( &minifier->defaultState, to, first, last, reset );
+		if ( paragraph )
+			strcat( reset, to->paragraphExtras );
+	}
+
+	// Change properties from written formatting
+	char change[1024] = "";
+	bool changeValid = false;
+	if ( fromKnown && toKnown )
+	{
+		changeValid = rtf_minify_diff( from, to, first, last, change );
+		if ( paragraph )
+		{
+			size_t extras = strlen( from->paragraphExtras );
+			if ( strncmp( from->paragraphExtras, to->paragraphExtras, extras ) == 0 )
+				strcat( change, to->paragraphExtras + extras );
+			else
+				changeValid = false;
+		}
+	}
+	else if ( !toKnown )
+	{
+		// Formatting is unknown, only properties set by pending control words are written
+		changeValid = true;
+		for ( int i=first; i<last; i++ )
+		{
+			if ( minifier->pendingTouched[i] && !rtf_minify_property( i, to->propertyValues[i], change + strlen(change) ) )
+				changeValid = false;
+		}
+		if ( paragraph )
+			strcat( change, to->paragraphExtras + minifier->extrasStart );
+	}
+
+	if ( changeValid && ( !resetValid || strlen(change) <= strlen(reset) ) )
+		strcat( words, change );
+	else if ( resetValid )
+		strcat( words, reset );
+	else
+		return false;
+
+	return true;
+}
+
+
+// Gets formatting property changes
+bool rtf_minify_diff(RTF_MINIFY_STATE* from, RTF_MINIFY_STATE* to, int first, int last, char* words)
+{
+	for ( int i=first; i<last; i++ )
+	{
+		if ( from->propertyValues[i] != to->propertyValues[i] && !rtf_minify_property( i, to->propertyValues[i], words + strlen(words) ) )
+			return false;
+	}
+
+	return true;
+}
+
+
+// Gets formatting property control word
+bool rtf_minify_property(int property, int value, char* words)
+{
+	for ( int i=0; rtfMinifyWords[i].wordName != NULL; i++ )
+	{
+		RTF_MINIFY_WORD* word = &rtfMinifyWords[i];
+		if ( word->wordProperty != property )
+			continue;
+
+		if ( word->wordValue == RTF_MINIFYVALUE_PARAMETER )
+		{
+			// Automatic color can only be set by \plain
+			if ( value < 0 && ( property == RTF_MINIFYPROPERTY_COLOR || property == RTF_MINIFYPROPERTY_BACKCOLOR ) )
+				return false;
+			sprintf( words, "\\%s%d", word->wordName, value );
+			return true;
+		}
+		if ( word->wordValue == RTF_MINIFYVALUE_TOGGLE )
+		{
+			sprintf( words, ( value ? "\\%s" : "\\%s0" ), word->wordName );
+			return true;
+		}
+		if ( word->wordValue == value )
+		{
+			sprintf( words, "\\%s", word->wordName );
+			return true;
+		}
+	}
+
+	// Property value can only be set by \pard or \plain (\intbl off, automatic color)
+	return false;
+}
+
+
+// Writes RTF reader event unchanged
+void rtf_minify_token(RTF_MINIFIER* minifier, RTF_READER_EVENT* event)
+{
+	char token[80];
+	switch ( event->eventType )
+	{
+		case RTF_READEREVENT_GROUPOPEN:
+			rtf_minify_write( minifier, "{", 1 );
+			minifier->needSpace = false;
+			break;
+
+		case RTF_READEREVENT_GROUPCLOSE:
+			rtf_minify_write( minifier, "}", 1 );
+			minifier->needSpace = false;
+			break;
+
+		case RTF_READEREVENT_CONTROLWORD:
+			token[0] = '\\';
+			rtf_minify_write( minifier, token, 1 );
+			rtf_minify_write( minifier, event->eventData, event->eventSize );
+			if ( event->hasParameter )
+			{
+				sprintf( token, "%d", event->eventParameter );
+				rtf_minify_write( minifier, token, strlen(token) );
+			}
+			minifier->needSpace = true;
+			break;
+
+		case RTF_READEREVENT_CONTROLSYMBOL:
+			token[0] = '\\';
+			token[1] = event->eventData[0];
+			rtf_minify_write( minifier, token, 2 );
+			minifier->needSpace = false;
+			break;
+
+		case RTF_READEREVENT_HEXCHAR:
+			token[0] = '\\';
+			token[1] = '\'';
+			token[2] = rtfHexDigits[(event->eventParameter >> 4) & 0x0F];
+			token[3] = rtfHexDigits[event->eventParameter & 0x0F];
+			rtf_minify_write( minifier, token, 4 );
+			minifier->needSpace = false;
+			break;
+
+		case RTF_READEREVENT_TEXT:
+			rtf_minify_text( minifier, event->eventData, event->eventSize );
+			break;
+
+		case RTF_READEREVENT_BINARY:
+			// Binary data follows \binN and its space delimiter
+			rtf_minify_write( minifier, " ", 1 );
+			rtf_minify_write( minifier, event->eventData, event->eventSize );
+			minifier->needSpace = false;
+			break;
+	}
+}
+
+
+// Writes RTF text
+void rtf_minify_text(RTF_MINIFIER* minifier, const char* text, size_t size)
+{
+	if ( size == 0 )
+		return;
+
+	// Text that would continue control word needs space delimiter
+	char c = text[0];
+	if ( minifier->needSpace && ( ( c >= 'a' && c <= 'z' ) || ( c >= 'A' && c <= 'Z' ) || ( c >= '0' && c <= '9' ) || c == ' ' || c == '-' ) )
+		rtf_minify_write( minifier, " ", 1 );
+	rtf_minify_write( minifier, text, size );
+	minifier->needSpace = false;
+}
+
+
+// Writes buffered picture data
+void rtf_minify_picture(RTF_MINIFIER* minifier)
+{
+	if ( minifier->pictureSize == 0 )
+		return;
+
+	// Only complete hexadecimal data (white space is allowed) is converted
+	const char* data = minifier->pictureData;
+	size_t digits = 0;
+	for ( size_t i=0; i<minifier->pictureSize && minifier->pictureSafe; i++ )
+	{
+		char c = data[i];
+		if ( ( c >= '0' && c <= '9' ) || ( c >= 'a' && c <= 'f' ) || ( c >= 'A' && c <= 'F' ) )
+			digits++;
+		else if ( c != ' ' && c != '\t' )
+			minifier->pictureSafe = false;
+	}
+	if ( digits % 2 != 0 )
+		minifier->pictureSafe = false;
+
+	if ( minifier->pictureSafe )
+	{
+		// Decode hexadecimal data in place
+		size_t size = 0;
+		int value = 0;
+		digits = 0;
+		for ( size_t i=0; i<minifier->pictureSize; i++ )
+		{
+			char c = data[i];
+			if ( c >= '0' && c <= '9' )
+				value = 16*value + ( c - '0' );
+			else if ( c >= 'a' && c <= 'f' )
+				value = 16*value + ( c - 'a' + 10 );
+			else if ( c >= 'A' && c <= 'F' )
+				value = 16*value + ( c - 'A' + 10 );
+			else
+				continue;
+			if ( ++digits % 2 == 0 )
+			{
+				minifier->pictureData[size++] = (char)value;
+				value = 0;
+			}
+		}
+
+		// Write binary picture data
+		char token[32];
+		sprintf( token, "\\bin%u ", (unsigned)size );
+		rtf_minify_write( minifier, token, strlen(token) );
+		rtf_minify_write( minifier, minifier->pictureData, size );
+		minifier->needSpace = false;
+	}
+	else
+	{
+		// Write picture data unchanged
+		rtf_minify_text( minifier, data, minifier->pictureSize );
+	}
+	minifier->pictureSize = 0;
+}
+
+
+// Writes minified RTF data
+void rtf_minify_write(RTF_MINIFIER* minifier, const char* data, size_t size)
+{
+	minifier->outputTotal += size;
+	if ( minifier->outputSize + size > RTF_MINIFY_BUFFERSIZE )
+	{
+		if ( minifier->outputSize > 0 && fwrite( minifier->outputBuffer, 1, minifier->outputSize, minifier->outputFile ) < minifier->outputSize )
+			minifier->writeError = true;
+		minifier->outputSize = 0;
+
+		// Write large data directly
+		if ( size > RTF_MINIFY_BUFFERSIZE )
+		{
+			if ( fwrite( data, 1, size, minifier->outputFile ) < size )
+				minifier->writeError = true;
+			return;
+		}
+	}
+
+	memcpy( minifier->outputBuffer + minifier->outputSize, data, size );
+	minifier->outputSize += size;
+}
+
+
+// Flushes and frees RTF minifier
+bool rtf_minify_close(RTF_MINIFIER* minifier)
+{
+	// Write data of unterminated picture group
+	if ( minifier->pictureDepth > 0 )
+	{
+		minifier->pictureSafe = false;
+		rtf_minify_picture( minifier );
+	}
+
+	if ( minifier->outputSize > 0 && fwrite( minifier->outputBuffer, 1, minifier->outputSize, minifier->outputFile ) < minifier->outputSize )
+		minifier->writeError = true;
+	minifier->outputSize = 0;
+
+	delete []minifier->outputBuffer;
+	minifier->outputBuffer = NULL;
+	delete []minifier->groupStates;
+	minifier->groupStates = NULL;
+	delete []minifier->pictureData;
+	minifier->pictureData = NULL;
+
+	return !minifier->writeError;
+}
+
+
+// Minifies RTF file
+int rtf_minify(char* filename, char* outname, bool binaryPictures)
+{
+	// Set error flag
+	int error = RTF_SUCCESS;
+
+	// Create minified RTF file
+	FILE* file = fopen( outname, "wb" );
+	if ( file == NULL )
+		return RTF_OPEN_ERROR;
+
+	// Rewrite RTF file in blocks (memory use is bounded by reader and output buffers and largest picture)
+	RTF_MINIFIER minifier;
+	rtf_minify_init( &minifier, file, binaryPictures );
+	error = rtf_read_file( filename, rtf_minify_event, &minifier );
+	if ( !rtf_minify_close( &minifier ) && error == RTF_SUCCESS )
+		error = RTF_MINIFY_ERROR;
+
+	// Close minified RTF file
+	if ( fclose(file) && error == RTF_SUCCESS )
+		error = RTF_MINIFY_ERROR;
+
+	// Return error flag
+	return error;
+}
@@ -0,0 +1,1101 @@
+#include "errors.h"
+#include "globals.h"
+#include "rtflib.h"
+
+#if defined(_M_X64) || defined(__SSE2__) || ( defined(_M_IX86_FP) && _M_IX86_FP >= 2 )
+#define RTF_READER_SSE2
+#include <emmintrin.h>
+// Index of lowest set bit of nonzero mask
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define RTF_READER_FIRSTBIT(bit, mask)		_BitScanForward( &bit, mask )
+#elif defined(__GNUC__)
+#define RTF_READER_FIRSTBIT(bit, mask)		( bit = __builtin_ctz( (unsigned int)(mask) ) )
+#else
+#undef RTF_READER_SSE2
+#endif
+#endif
+
+
+
+// RTF reader global params
+char rtfReaderSpecial[256] = "";				// RTF special characters (\, {, }, CR, LF)
+bool rtfReaderInitialized = false;
+unsigned short rtfCodePage1252[32] = {				// Windows-1252 characters 0x80-0x9F
+	0x20AC, 0x0081, 0x201A, 0x0192, 0x201E, 0x2026, 0x2020, 0x2021, 0x02C6, 0x2030, 0x0160, 0x2039, 0x0152, 0x008D, 0x017D, 0x008F,
+	0x0090, 0x2018, 0x2019, 0x201C, 0x201D, 0x2022, 0x2013, 0x2014, 0x02DC, 0x2122, 0x0161, 0x203A, 0x0153, 0x009D, 0x017E, 0x0178 };
+const char* rtfDestinations[] = {					// Destination groups without plain text
+	"fonttbl", "colortbl", "stylesheet", "info", "pict", "object", "fldinst", "listtable",
+	"listoverridetable", "revtbl", "rsidtbl", "xmlnstbl", "themedata", "datastore", NULL };
+extern bool rtfTraceEnabled;						// Tracing is enabled (rtflib.cpp)
+
+
+
+// Initializes RTF reader
+void rtf_reader_init(RTF_READER* reader, RTF_READER_CALLBACK callback, void* param)
+{
+	// Set RTF special characters
+	if ( !rtfReaderInitialized )
+	{
+		memset( rtfReaderSpecial, 0, sizeof(rtfReaderSpecial) );
+		rtfReaderSpecial['\\'] = 1;
+		rtfReaderSpecial['{'] = 1;
+		rtfReaderSpecial['}'] = 1;
+		rtfReaderSpecial['\r'] = 1;
+		rtfReaderSpecial['\n'] = 1;
+		rtfReaderInitialized = true;
+	}
+
+	// Set RTF reader params
+	reader->readerCallback = callback;
+	reader->readerParam = param;
+	reader->groupDepth = 0;
+	reader->readerOffset = 0;
+	reader->readerStopped = false;
+	reader->headerData = NULL;
+	reader->headerSize = 0;
+}
+
+
+// Finds next RTF special character
+size_t rtf_reader_scan(const char* data, size_t size)
+{
+	size_t i = 0;
+
+#ifdef RTF_READER_SSE2
+	// Compare 16 characters at once
+	const __m128i backslash = _mm_set1_epi8('\\');
+	const __m128i open = _mm_set1_epi8('{');
+	const __m128i close = _mm_set1_epi8('}');
+	const __m128i cr = _mm_set1_epi8('\r');
+	const __m128i lf = _mm_set1_epi8('\n');
+	for ( ; i+16<=size; i+=16 )
+	{
+		__m128i chunk = _mm_loadu_si128( (const __m128i*)(data + i) );
+		__m128i special = _mm_or_si128( _mm_or_si128( _mm_cmpeq_epi8( chunk, backslash ), _mm_cmpeq_epi8( chunk, open ) ),
+			_mm_or_si128( _mm_cmpeq_epi8( chunk, close ), _mm_or_si128( _mm_cmpeq_epi8( chunk, cr ), _mm_cmpeq_epi8( chunk, lf ) ) ) );
+		int mask = _mm_movemask_epi8(special);
+		if ( mask != 0 )
+		{
+			unsigned long bit;
+			RTF_READER_FIRSTBIT( bit, mask );
+			return i + bit;
+		}
+	}
+#endif
+
+	// Compare remaining characters
+	for ( ; i<size; i++ )
+	{
+		if ( rtfReaderSpecial[(unsigned char)data[i]] )
+			break;
+	}
+
+	return i;
+}
+
+
+// Parses RTF data and reports events
+size_t rtf_reader_parse(RTF_READER* reader, const char* data, size_t size, bool last)
+{
+	RTF_READER_EVENT event;
+	size_t position = 0;
+	event.eventReader = reader;
+
+	while ( position < size && !reader->readerStopped )
+	{
+		size_t start = position;
+		char c = data[position];
+
+		event.hasParameter = false;
+		event.eventParameter = 0;
+		event.eventOffset = reader->readerOffset + start;
+
+		if ( c == '{' )
+		{
+			// Group open
+			reader->groupDepth++;
+			event.eventType = RTF_READEREVENT_GROUPOPEN;
+			event.eventData = data + start;
+			event.eventSize = 1;
+			position++;
+		}
+		else if ( c == '}' )
+		{
+			// Group close
+			reader->groupDepth--;
+			event.eventType = RTF_READEREVENT_GROUPCLOSE;
+			event.eventData = data + start;
+			event.eventSize = 1;
+			position++;
+		}
+		else if ( c == '\r' || c == '\n' )
+		{
+			// Line breaks are ignored
+			position++;
+			continue;
+		}
+		else if ( c == '\\' )
+		{
+			// Control word or symbol needs at least one more character
+			if ( position+1 >= size )
+			{
+				if ( !last )
+					break;
+				position++;
+				continue;
+			}
+
+			char next = data[position+1];
+			if ( ( next >= 'a' && next <= 'z' ) || ( next >= 'A' && next <= 'Z' ) )
+			{
+				// Control word name
+				size_t name = position+1;
+				size_t end = name;
+				while ( end < size && ( ( data[end] >= 'a' && data[end] <= 'z' ) || ( data[end] >= 'A' && data[end] <= 'Z' ) ) )
+					end++;
+				event.eventType = RTF_READEREVENT_CONTROLWORD;
+				event.eventData = data + name;
+				event.eventSize = end - name;
+
+				// Control word parameter
+				bool negative = false;
+				if ( end < size && data[end] == '-' )
+				{
+					negative = true;
+					end++;
+				}
+				while ( end < size && data[end] >= '0' && data[end] <= '9' )
+				{
+					event.hasParameter = true;
+					event.eventParameter = 10*event.eventParameter + ( data[end] - '0' );
+					end++;
+				}
+				if ( negative )
+					event.eventParameter = -event.eventParameter;
+
+				// Control word must be delimited before data end
+				if ( end >= size && !last )
+					break;
+
+				// Space delimiter is part of control word
+				if ( end < size && data[end] == ' ' )
+					end++;
+
+				// Binary data follows \binN control word
+				if ( event.hasParameter && event.eventSize == 3 && strncmp( event.eventData, "bin", 3 ) == 0 && event.eventParameter > 0 )
+				{
+					if ( end + event.eventParameter > size )
+					{
+						if ( !last )
+							break;
+						event.eventParameter = size - end;
+					}
+
+					// Control word is reported first, then binary data
+					event.groupDepth = reader->groupDepth;
+					if ( !reader->readerCallback( &event, reader->readerParam ) )
+						reader->readerStopped = true;
+
+					event.eventType = RTF_READEREVENT_BINARY;
+					event.eventData = data + end;
+					event.eventSize = event.eventParameter;
+					event.eventOffset = reader->readerOffset + end;
+					end += event.eventParameter;
+				}
+
+				position = end;
+			}
+			else if ( next == '\'' )
+			{
+				// Hexadecimal character needs two more characters
+				if ( position+4 > size )
+				{
+					if ( !last )
+						break;
+					position = size;
+					continue;
+				}
+
+				int value = 0;
+				for ( int i=2; i<4; i++ )
+				{
+					char h = data[position+i];
+					value *= 16;
+					if ( h >= '0' && h <= '9' )
+						value += h - '0';
+					else if ( h >= 'a' && h <= 'f' )
+						value += h - 'a' + 10;
+					else if ( h >= 'A' && h <= 'F' )
+						value += h - 'A' + 10;
+				}
+
+				event.eventType = RTF_READEREVENT_HEXCHAR;
+				event.eventData = data + start;
+				event.eventSize = 4;
+				event.hasParameter = true;
+				event.eventParameter = value;
+				position += 4;
+			}
+			else
+			{
+				// Control symbol
+				event.eventType = RTF_READEREVENT_CONTROLSYMBOL;
+				event.eventData = data + position + 1;
+				event.eventSize = 1;
+				position += 2;
+			}
+		}
+		else
+		{
+			// Text run up to next special character (may be split at block end)
+			size_t length = rtf_reader_scan( data + position, size - position );
+			event.eventType = RTF_READEREVENT_TEXT;
+			event.eventData = data + start;
+			event.eventSize = length;
+			position += length;
+		}
+
+		event.groupDepth = reader->groupDepth;
+		if ( !reader->readerStopped && !reader->readerCallback( &event, reader->readerParam ) )
+			reader->readerStopped = true;
+	}
+
+	// Return number of parsed bytes (rest is incomplete token)
+	reader->readerOffset += position;
+	return position;
+}
+
+
+// Reads RTF file and reports events
+int rtf_read_file(char* filename, RTF_READER_CALLBACK callback, void* param)
+{
+	// Set error flag
+	int error = RTF_SUCCESS;
+
+	// Open RTF file
+	FILE* file = fopen( filename, "rb" );
+	if ( file == NULL )
+		return RTF_OPEN_ERROR;
+
+	// Initialize RTF reader
+	RTF_READER reader;
+	rtf_reader_init( &reader, callback, param );
+
+	// Parse RTF file in blocks (memory use is bounded by block size and largest \bin data)
+	size_t capacity = 1048576;
+	char* buffer = new char[capacity];
+	size_t size = 0;
+	bool last = false;
+	while ( !last && !reader.readerStopped )
+	{
+		// Read next block after unparsed data
+		size_t read = fread( buffer + size, 1, capacity - size, file );
+		size += read;
+		if ( read == 0 )
+		{
+			last = true;
+			if ( ferror(file) )
+				error = RTF_READER_ERROR;
+		}
+
+		// Parse block and keep unparsed data
+		size_t parsed = rtf_reader_parse( &reader, buffer, size, last );
+		memmove( buffer, buffer + parsed, size - parsed );
+		size -= parsed;
+
+		// Grow buffer for token larger than block
+		if ( size == capacity )
+		{
+			char* larger = new char[2*capacity];
+			memcpy( larger, buffer, size );
+			delete []buffer;
+			buffer = larger;
+			capacity *= 2;
+		}
+	}
+	delete []buffer;
+
+	// Close RTF file
+	fclose(file);
+
+	// Return error flag
+	return error;
+}
+
+
+// Reports RTF document header events
+bool rtf_reader_headerevent(RTF_READER_EVENT* event, void* param)
+{
+	RTF_READER_HEADER* header = (RTF_READER_HEADER*)param;
+
+	if ( event->eventType == RTF_READEREVENT_GROUPOPEN && event->groupDepth == 2 )
+	{
+		// Top-level group is named by its first control word (after \*)
+		header->groupStart = true;
+		header->tableGroup = false;
+	}
+	else if ( event->eventType == RTF_READEREVENT_GROUPCLOSE && event->groupDepth == 1 )
+	{
+		// Header ends after last table group
+		if ( header->tableGroup )
+			header->headerSize = event->eventOffset + 1;
+		header->tableGroup = false;
+	}
+	else if ( event->eventType == RTF_READEREVENT_CONTROLWORD && header->groupStart )
+	{
+		header->groupStart = false;
+		if ( ( event->eventSize == 7 && strncmp( event->eventData, "fonttbl", 7 ) == 0 ) ||
+			( event->eventSize == 8 && strncmp( event->eventData, "colortbl", 8 ) == 0 ) ||
+			( event->eventSize == 10 && strncmp( event->eventData, "stylesheet", 10 ) == 0 ) ||
+			( event->eventSize == 9 && strncmp( event->eventData, "listtable", 9 ) == 0 ) ||
+			( event->eventSize == 17 && strncmp( event->eventData, "listoverridetable", 17 ) == 0 ) )
+			header->tableGroup = true;
+	}
+	else if ( event->eventType == RTF_READEREVENT_CONTROLWORD && event->groupDepth == 1 )
+	{
+		// Document content starts with paragraph or section properties
+		if ( ( event->eventSize == 4 && strncmp( event->eventData, "pard", 4 ) == 0 ) ||
+			( event->eventSize == 5 && strncmp( event->eventData, "sectd", 5 ) == 0 ) ||
+			( event->eventSize == 3 && strncmp( event->eventData, "par", 3 ) == 0 ) )
+			return false;
+	}
+	else if ( event->eventType == RTF_READEREVENT_TEXT && event->groupDepth == 1 )
+	{
+		// Document content starts with text
+		return false;
+	}
+
+	return true;
+}
+
+
+// Gets RTF document header size
+size_t rtf_reader_header(const char* data, size_t size)
+{
+	RTF_READER_HEADER header;
+	header.headerSize = 0;
+	header.groupStart = false;
+	header.tableGroup = false;
+
+	RTF_READER reader;
+	rtf_reader_init( &reader, rtf_reader_headerevent, &header );
+	rtf_reader_parse( &reader, data, size, false );
+
+	// Return header size (0 if there are no header tables)
+	return header.headerSize;
+}
+
+
+// Gets RTF group depth change
+int rtf_reader_depth(const char* data, size_t size, size_t available, bool escaped, bool* binary)
+{
+	int depth = 0;
+	size_t position = ( escaped ? 1 : 0 );
+
+	while ( position < size )
+	{
+#ifdef RTF_READER_SSE2
+		if ( position+16 <= size )
+		{
+			// Count braces of 16 characters at once up to first backslash
+			__m128i chunk = _mm_loadu_si128( (const __m128i*)(data + position) );
+			int open = _mm_movemask_epi8( _mm_cmpeq_epi8( chunk, _mm_set1_epi8('{') ) );
+			int close = _mm_movemask_epi8( _mm_cmpeq_epi8( chunk, _mm_set1_epi8('}') ) );
+			int backslash = _mm_movemask_epi8( _mm_cmpeq_epi8( chunk, _mm_set1_epi8('\\') ) );
+			size_t count = 16;
+			if ( backslash != 0 )
+			{
+				unsigned long bit;
+				RTF_READER_FIRSTBIT( bit, backslash );
+				open &= ( 1 << bit ) - 1;
+				close &= ( 1 << bit ) - 1;
+				count = bit;
+			}
+			for ( ; open != 0; open &= open - 1 )
+				depth++;
+			for ( ; close != 0; close &= close - 1 )
+				depth--;
+			position += count;
+			if ( position >= size || data[position] != '\\' )
+				continue;
+		}
+#endif
+
+		// Count brace or skip escaped character
+		char c = data[position];
+		if ( c == '{' )
+			depth++;
+		else if ( c == '}' )
+			depth--;
+		else if ( c == '\\' )
+		{
+			// Binary data may contain unbalanced braces
+			if ( position+4 < available && strncmp( data + position + 1, "bin", 3 ) == 0 && data[position+4] >= '0' && data[position+4] <= '9' )
+				*binary = true;
+			position++;
+		}
+		position++;
+	}
+
+	// Return group depth change
+	return depth;
+}
+
+
+// Finds RTF split point at top-level group boundary
+size_t rtf_reader_split(const char* data, size_t size, int depth, bool escaped)
+{
+	size_t position = ( escaped ? 1 : 0 );
+
+	while ( position < size )
+	{
+		// Skip text to next special character
+		position += rtf_reader_scan( data + position, size - position );
+		if ( position >= size )
+			break;
+
+		char c = data[position];
+		if ( c == '{' )
+			depth++;
+		else if ( c == '}' )
+		{
+			// Split after top-level group
+			depth--;
+			if ( depth == 1 )
+				return position + 1;
+		}
+		else if ( c == '\\' )
+		{
+			// Split before top-level section break
+			if ( depth == 1 && position+5 < size && strncmp( data + position + 1, "sect", 4 ) == 0 &&
+				!( ( data[position+5] >= 'a' && data[position+5] <= 'z' ) || ( data[position+5] >= 'A' && data[position+5] <= 'Z' ) ) )
+				return position;
+			position++;
+		}
+		position++;
+	}
+
+	// Return data size if there is no split point
+	return size;
+}
+
+
+// Buffers RTF chunk event
+bool rtf_reader_buffer(RTF_READER_EVENT* event, void* param)
+{
+	RTF_READER_CHUNK* chunk = (RTF_READER_CHUNK*)param;
+
+	// Grow event buffer
+	if ( chunk->eventCount == chunk->eventCapacity )
+	{
+		size_t capacity = ( chunk->eventCapacity == 0 ? 65536 : 2*chunk->eventCapacity );
+		RTF_READER_EVENT* events = new RTF_READER_EVENT[capacity];
+		if ( chunk->eventCount > 0 )
+			memcpy( events, chunk->chunkEvents, chunk->eventCount*sizeof(RTF_READER_EVENT) );
+		delete []chunk->chunkEvents;
+		chunk->chunkEvents = events;
+		chunk->eventCapacity = capacity;
+	}
+
+	chunk->chunkEvents[chunk->eventCount++] = *event;
+	return true;
+}
+
+
+// Gets RTF chunk group depth change on worker thread
+DWORD WINAPI rtf_reader_prescan(LPVOID param)
+{
+	RTF_READER_CHUNK* chunk = (RTF_READER_CHUNK*)param;
+	RTF_TRACE_START(traceStart);
+	chunk->binaryData = false;
+	chunk->depthChange = rtf_reader_depth( chunk->chunkData, chunk->chunkSize, chunk->availableSize, chunk->chunkEscaped, &chunk->binaryData );
+	RTF_TRACE( rtf_trace_end( "reader prescan", &traceStart, (int)chunk->chunkSize ) );
+	rtf_trace_release();
+	return 0;
+}
+
+
+// Parses RTF chunk on worker thread
+DWORD WINAPI rtf_reader_worker(LPVOID param)
+{
+	RTF_READER_CHUNK* chunk = (RTF_READER_CHUNK*)param;
+	RTF_TRACE_START(traceStart);
+	chunk->eventCount = 0;
+	chunk->parsedSize = rtf_reader_parse( &chunk->chunkReader, chunk->chunkData, chunk->chunkSize, chunk->lastChunk );
+	RTF_TRACE( rtf_trace_end( "reader chunk", &traceStart, (int)chunk->chunkSize ) );
+	rtf_trace_release();
+	return 0;
+}
+
+
+// Runs RTF chunk jobs on worker threads
+void rtf_reader_run(LPTHREAD_START_ROUTINE job, RTF_READER_CHUNK* chunks, int count)
+{
+	HANDLE threads[RTF_READER_MAXTHREADS];
+	int i;
+	for ( i=0; i<count; i++ )
+		threads[i] = CreateThread( NULL, 0, job, &chunks[i], 0, NULL );
+	for ( i=0; i<count; i++ )
+	{
+		// Run job on calling thread if thread could not be created
+		if ( threads[i] == NULL )
+			job( &chunks[i] );
+	}
+	for ( i=0; i<count; i++ )
+	{
+		if ( threads[i] != NULL )
+		{
+			WaitForSingleObject( threads[i], INFINITE );
+			CloseHandle( threads[i] );
+		}
+	}
+}
+
+
+// Checks if RTF character is escaped by preceding backslashes
+bool rtf_reader_escaped(const char* data, size_t position)
+{
+	size_t count = 0;
+	while ( count < position && data[position-count-1] == '\\' )
+		count++;
+	return ( count % 2 == 1 );
+}
+
+
+// Reads RTF file on multiple threads
+int rtf_read_file_parallel(char* filename, RTF_READER_CALLBACK callback, void* param, int threads)
+{
+	// Set error flag
+	int error = RTF_SUCCESS;
+	int i;
+
+	// Get number of threads and view granularity
+	SYSTEM_INFO info;
+	GetSystemInfo( &info );
+	if ( threads <= 0 )
+		threads = info.dwNumberOfProcessors;
+	if ( threads > RTF_READER_MAXTHREADS )
+		threads = RTF_READER_MAXTHREADS;
+	if ( threads <= 1 )
+		return rtf_read_file( filename, callback, param );
+
+	// Open and map RTF file
+	HANDLE file = CreateFile( filename, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL );
+	if ( file == INVALID_HANDLE_VALUE )
+		return RTF_OPEN_ERROR;
+	DWORD sizeHigh = 0;
+	DWORD sizeLow = GetFileSize( file, &sizeHigh );
+	if ( ( sizeLow == 0xFFFFFFFF && GetLastError() != NO_ERROR ) || ( sizeLow == 0 && sizeHigh == 0 ) )
+	{
+		CloseHandle( file );
+		return ( sizeLow == 0 && sizeHigh == 0 ? RTF_SUCCESS : RTF_READER_ERROR );
+	}
+	HANDLE mapping = CreateFileMapping( file, NULL, PAGE_READONLY, 0, 0, NULL );
+	if ( mapping == NULL )
+	{
+		CloseHandle( file );
+		return RTF_READER_ERROR;
+	}
+
+	// Initialize RTF reader and chunks
+	RTF_READER reader;
+	rtf_reader_init( &reader, callback, param );
+	RTF_READER_CHUNK* chunks = new RTF_READER_CHUNK[threads];
+	for ( i=0; i<threads; i++ )
+	{
+		chunks[i].chunkEvents = NULL;
+		chunks[i].eventCount = 0;
+		chunks[i].eventCapacity = 0;
+	}
+	char* header = NULL;
+	size_t headerSize = 0;
+	bool sequential = false;
+	size_t viewSize = RTF_READER_CHUNKSIZE;
+
+	ULONGLONG offset = 0;
+	ULONGLONG size = ( (ULONGLONG)sizeHigh << 32 ) | sizeLow;
+	while ( offset < size && !reader.readerStopped )
+	{
+		// Map view of next batch (one chunk per thread, plus one chunk to find last split point)
+		ULONGLONG viewStart = offset - offset % info.dwAllocationGranularity;
+		ULONGLONG viewEnd = offset + ( sequential ? viewSize : (threads+1)*RTF_READER_CHUNKSIZE );
+		if ( viewEnd > size )
+			viewEnd = size;
+		const char* view = (const char*)MapViewOfFile( mapping, FILE_MAP_READ, (DWORD)(viewStart >> 32), (DWORD)viewStart, (size_t)(viewEnd - viewStart) );
+		if ( view == NULL )
+		{
+			error = RTF_READER_ERROR;
+			break;
+		}
+		const char* data = view + (size_t)(offset - viewStart);
+		size_t dataSize = (size_t)(viewEnd - offset);
+		bool last = ( viewEnd == size );
+		size_t parsed = 0;
+
+		if ( header == NULL )
+		{
+			// Parse document header and keep it for chunk readers
+			headerSize = rtf_reader_header( data, dataSize );
+			header = new char[headerSize+1];
+			memcpy( header, data, headerSize );
+			header[headerSize] = '\0';
+			parsed = rtf_reader_parse( &reader, data, headerSize, false );
+		}
+		else if ( sequential )
+		{
+			// Parse view on calling thread (view is doubled for token larger than view)
+			parsed = rtf_reader_parse( &reader, data, dataSize, last );
+			if ( parsed == 0 && !last )
+				viewSize *= 2;
+		}
+		else
+		{
+			// Get group depth change of chunks on worker threads
+			size_t batchSize = threads*RTF_READER_CHUNKSIZE;
+			if ( batchSize > dataSize )
+				batchSize = dataSize;
+			int count = 0;
+			for ( size_t start=0; start<batchSize; start+=RTF_READER_CHUNKSIZE )
+			{
+				RTF_READER_CHUNK* chunk = &chunks[count++];
+				chunk->chunkData = data + start;
+				chunk->chunkSize = ( batchSize - start < RTF_READER_CHUNKSIZE ? batchSize - start : RTF_READER_CHUNKSIZE );
+				chunk->availableSize = dataSize - start;
+				chunk->chunkEscaped = ( start > 0 ? rtf_reader_escaped( data, start ) : false );
+			}
+			rtf_reader_run( rtf_reader_prescan, chunks, count );
+
+			// Binary data is parsed sequentially from now on
+			for ( i=0; i<count; i++ )
+			{
+				if ( chunks[i].binaryData )
+					sequential = true;
+			}
+
+			if ( !sequential )
+			{
+				// Move chunk boundaries to split points
+				size_t boundaries[RTF_READER_MAXTHREADS+1];
+				int depths[RTF_READER_MAXTHREADS+1];
+				bool lastChunk = true;
+				int depth = reader.groupDepth;
+				boundaries[0] = 0;
+				depths[0] = reader.groupDepth;
+				for ( i=1; i<=count; i++ )
+				{
+					size_t start = chunks[i-1].chunkData - data + chunks[i-1].chunkSize;
+					depth += chunks[i-1].depthChange;
+					size_t limit = ( i < count ? batchSize : dataSize );
+					size_t split = limit;
+					if ( i < count || !last || batchSize < dataSize )
+						split = start + rtf_reader_split( data + start, limit - start, depth, rtf_reader_escaped( data, start ) );
+
+					if ( split < limit && split >= boundaries[i-1] )
+					{
+						// Next chunk starts at split point
+						boundaries[i] = split;
+						depths[i] = 1;
+					}
+					else if ( i < count )
+					{
+						// Chunk without split point is parsed by next chunk
+						boundaries[i] = boundaries[i-1];
+						depths[i] = depths[i-1];
+					}
+					else
+					{
+						// Last chunk ends at view end (unparsed data is kept for next batch)
+						boundaries[i] = dataSize;
+						lastChunk = last;
+					}
+				}
+
+				// Parse chunks on worker threads
+				for ( i=0; i<count; i++ )
+				{
+					RTF_READER_CHUNK* chunk = &chunks[i];
+					rtf_reader_init( &chunk->chunkReader, rtf_reader_buffer, chunk );
+					chunk->chunkReader.groupDepth = depths[i];
+					chunk->chunkReader.readerOffset = (size_t)offset + boundaries[i];
+					chunk->chunkReader.headerData = header;
+					chunk->chunkReader.headerSize = headerSize;
+					chunk->chunkData = data + boundaries[i];
+					chunk->chunkSize = boundaries[i+1] - boundaries[i];
+					chunk->lastChunk = ( i < count-1 ? true : lastChunk );
+				}
+				rtf_reader_run( rtf_reader_worker, chunks, count );
+
+				// Report chunk events in order
+				for ( i=0; i<count && !reader.readerStopped; i++ )
+				{
+					RTF_READER_CHUNK* chunk = &chunks[i];
+					for ( size_t j=0; j<chunk->eventCount; j++ )
+					{
+						if ( !callback( &chunk->chunkEvents[j], param ) )
+						{
+							reader.readerStopped = true;
+							break;
+						}
+					}
+					if ( chunk->chunkSize > 0 )
+						reader.groupDepth = chunk->chunkReader.groupDepth;
+				}
+				parsed = boundaries[count-1] + chunks[count-1].parsedSize;
+				reader.readerOffset = (size_t)offset + parsed;
+			}
+		}
+
+		UnmapViewOfFile( view );
+		offset += parsed;
+	}
+
+	// Free chunks and header
+	for ( i=0; i<threads; i++ )
+		delete []chunks[i].chunkEvents;
+	delete []chunks;
+	delete []header;
+
+	// Close RTF file
+	CloseHandle( mapping );
+	CloseHandle( file );
+
+	// Return error flag
+	return error;
+}
+
+
+// Initializes RTF text extractor
+void rtf_extract_init(RTF_EXTRACTOR* extractor, FILE* file)
+{
+	rtf_reader_init( &extractor->extractorReader, rtf_extract_event, extractor );
+	extractor->textFile = file;
+	extractor->textBuffer = new char[RTF_EXTRACTOR_BUFFERSIZE];
+	extractor->textSize = 0;
+	extractor->skipDepth = 0;
+	extractor->groupStart = false;
+	extractor->skipCount = 0;
+	extractor->highSurrogate = 0;
+	extractor->pendingData = NULL;
+	extractor->pendingSize = 0;
+	extractor->pendingCapacity = 0;
+	extractor->writeError = false;
+
+	// One character is skipped after \uN by default
+	for ( int i=0; i<RTF_EXTRACTOR_MAXDEPTH; i++ )
+		extractor->unicodeSkip[i] = 1;
+}
+
+
+// Extracts plain text from RTF reader event
+bool rtf_extract_event(RTF_READER_EVENT* event, void* param)
+{
+	RTF_EXTRACTOR* extractor = (RTF_EXTRACTOR*)param;
+	int depth = event->groupDepth;
+	if ( depth < 0 )
+		depth = 0;
+	if ( depth >= RTF_EXTRACTOR_MAXDEPTH )
+		depth = RTF_EXTRACTOR_MAXDEPTH - 1;
+
+	if ( event->eventType == RTF_READEREVENT_GROUPOPEN )
+	{
+		// Group inherits \ucN and may be destination
+		if ( depth > 0 )
+			extractor->unicodeSkip[depth] = extractor->unicodeSkip[depth-1];
+		extractor->groupStart = true;
+		extractor->skipCount = 0;
+		return true;
+	}
+	if ( event->eventType == RTF_READEREVENT_GROUPCLOSE )
+	{
+		// Destination group ends
+		if ( extractor->skipDepth > 0 && event->groupDepth < extractor->skipDepth )
+			extractor->skipDepth = 0;
+		extractor->groupStart = false;
+		extractor->skipCount = 0;
+		return true;
+	}
+
+	// Skip destination group content
+	if ( extractor->skipDepth > 0 )
+		return true;
+	bool groupStart = extractor->groupStart;
+	extractor->groupStart = false;
+
+	if ( event->eventType == RTF_READEREVENT_TEXT )
+	{
+		const char* text = event->eventData;
+		size_t size = event->eventSize;
+
+		// Skip \uN replacement characters
+		if ( extractor->skipCount > 0 )
+		{
+			size_t skip = ( (size_t)extractor->skipCount < size ? extractor->skipCount : size );
+			extractor->skipCount -= (int)skip;
+			text += skip;
+			size -= skip;
+		}
+
+		// Write ASCII text runs directly, other characters as UTF-8
+		size_t start = 0;
+		for ( size_t i=0; i<size; i++ )
+		{
+			if ( (unsigned char)text[i] >= 0x80 )
+			{
+				rtf_extract_write( extractor, text + start, i - start );
+				unsigned char c = (unsigned char)text[i];
+				rtf_extract_char( extractor, ( c < 0xA0 ? rtfCodePage1252[c-0x80] : c ) );
+				start = i + 1;
+			}
+		}
+		rtf_extract_write( extractor, text + start, size - start );
+	}
+	else if ( event->eventType == RTF_READEREVENT_HEXCHAR )
+	{
+		// Decode Windows-1252 character
+		if ( extractor->skipCount > 0 )
+			extractor->skipCount--;
+		else
+		{
+			int c = event->eventParameter;
+			rtf_extract_char( extractor, ( c >= 0x80 && c < 0xA0 ? rtfCodePage1252[c-0x80] : c ) );
+		}
+	}
+	else if ( event->eventType == RTF_READEREVENT_CONTROLSYMBOL )
+	{
+		char c = event->eventData[0];
+		if ( c == '*' && groupStart )
+		{
+			// Ignorable destination
+			extractor->skipDepth = event->groupDepth;
+		}
+		else if ( extractor->skipCount > 0 )
+			extractor->skipCount--;
+		else if ( c == '\\' || c == '{' || c == '}' )
+			rtf_extract_write( extractor, &c, 1 );
+		else if ( c == '~' )
+			rtf_extract_char( extractor, 0x00A0 );
+		else if ( c == '_' )
+			rtf_extract_char( extractor, 0x2011 );
+		else if ( c == '\r' || c == '\n' )
+			rtf_extract_write( extractor, "\n", 1 );
+	}
+	else if ( event->eventType == RTF_READEREVENT_CONTROLWORD )
+	{
+		const char* name = event->eventData;
+		size_t size = event->eventSize;
+
+		if ( groupStart )
+		{
+			// Destination group without plain text
+			for ( int i=0; rtfDestinations[i] != NULL; i++ )
+			{
+				if ( strlen(rtfDestinations[i]) == size && strncmp( name, rtfDestinations[i], size ) == 0 )
+				{
+					extractor->skipDepth = event->groupDepth;
+					return true;
+				}
+			}
+		}
+
+		if ( size == 1 && name[0] == 'u' && event->hasParameter )
+		{
+			// Unicode character (negative values are UTF-16 code units above 0x7FFF)
+			unsigned int code = (unsigned int)( event->eventParameter < 0 ? event->eventParameter + 65536 : event->eventParameter );
+			if ( code >= 0xD800 && code < 0xDC00 )
+				extractor->highSurrogate = code;
+			else if ( code >= 0xDC00 && code < 0xE000 )
+			{
+				if ( extractor->highSurrogate != 0 )
+					rtf_extract_char( extractor, 0x10000 + ( ( extractor->highSurrogate - 0xD800 ) << 10 ) + ( code - 0xDC00 ) );
+				extractor->highSurrogate = 0;
+			}
+			else
+				rtf_extract_char( extractor, code );
+			extractor->skipCount = extractor->unicodeSkip[depth];
+		}
+		else if ( size == 2 && strncmp( name, "uc", 2 ) == 0 )
+			extractor->unicodeSkip[depth] = event->eventParameter;
+		else if ( extractor->skipCount > 0 )
+			extractor->skipCount--;
+		else if ( ( size == 3 && ( strncmp( name, "par", 3 ) == 0 || strncmp( name, "row", 3 ) == 0 ) ) ||
+			( size == 4 && ( strncmp( name, "line", 4 ) == 0 || strncmp( name, "sect", 4 ) == 0 || strncmp( name, "page", 4 ) == 0 ) ) )
+			rtf_extract_write( extractor, "\n", 1 );
+		else if ( ( size == 3 && strncmp( name, "tab", 3 ) == 0 ) || ( size == 4 && strncmp( name, "cell", 4 ) == 0 ) )
+			rtf_extract_write( extractor, "\t", 1 );
+		else if ( size == 6 && strncmp( name, "emdash", 6 ) == 0 )
+			rtf_extract_char( extractor, 0x2014 );
+		else if ( size == 6 && strncmp( name, "endash", 6 ) == 0 )
+			rtf_extract_char( extractor, 0x2013 );
+		else if ( size == 6 && strncmp( name, "bullet", 6 ) == 0 )
+			rtf_extract_char( extractor, 0x2022 );
+		else if ( size == 6 && strncmp( name, "lquote", 6 ) == 0 )
+			rtf_extract_char( extractor, 0x2018 );
+		else if ( size == 6 && strncmp( name, "rquote", 6 ) == 0 )
+			rtf_extract_char( extractor, 0x2019 );
+		else if ( size == 9 && strncmp( name, "ldblquote", 9 ) == 0 )
+			rtf_extract_char( extractor, 0x201C );
+		else if ( size == 9 && strncmp( name, "rdblquote", 9 ) == 0 )
+			rtf_extract_char( extractor, 0x201D );
+	}
+	else if ( event->eventType == RTF_READEREVENT_BINARY )
+	{
+		// Binary data counts as one skipped character
+		if ( extractor->skipCount > 0 )
+			extractor->skipCount--;
+	}
+
+	return !extractor->writeError;
+}
+
+
+// Extracts plain text from streamed RTF data
+bool rtf_extract_data(RTF_EXTRACTOR* extractor, const char* data, size_t size, bool last)
+{
+	// Parse data directly if there is no incomplete token
+	if ( extractor->pendingSize == 0 )
+	{
+		size_t parsed = rtf_reader_parse( &extractor->extractorReader, data, size, last );
+		data += parsed;
+		size -= parsed;
+	}
+	else
+	{
+		// Complete pending token with new data
+		if ( extractor->pendingSize + size > extractor->pendingCapacity )
+		{
+			size_t capacity = 2*( extractor->pendingSize + size );
+			char* pending = new char[capacity];
+			memcpy( pending, extractor->pendingData, extractor->pendingSize );
+			delete []extractor->pendingData;
+			extractor->pendingData = pending;
+			extractor->pendingCapacity = capacity;
+		}
+		memcpy( extractor->pendingData + extractor->pendingSize, data, size );
+		extractor->pendingSize += size;
+		size_t parsed = rtf_reader_parse( &extractor->extractorReader, extractor->pendingData, extractor->pendingSize, last );
+		data = extractor->pendingData + parsed;
+		size = extractor->pendingSize - parsed;
+	}
+
+	// Keep incomplete token
+	if ( size > extractor->pendingCapacity )
+	{
+		char* pending = new char[2*size];
+		delete []extractor->pendingData;
+		extractor->pendingData = pending;
+		extractor->pendingCapacity = 2*size;
+	}
+	if ( size > 0 )
+		memmove( extractor->pendingData, data, size );
+	extractor->pendingSize = size;
+
+	return !extractor->writeError;
+}
+
+
+// Writes plain text
+void rtf_extract_write(RTF_EXTRACTOR* extractor, const char* text, size_t size)
+{
+	if ( extractor->textSize + size > RTF_EXTRACTOR_BUFFERSIZE )
+	{
+		rtf_extract_flush( extractor );
+
+		// Write large text directly
+		if ( size > RTF_EXTRACTOR_BUFFERSIZE )
+		{
+			if ( fwrite( text, 1, size, extractor->textFile ) < size )
+				extractor->writeError = true;
+			return;
+		}
+	}
+
+	memcpy( extractor->textBuffer + extractor->textSize, text, size );
+	extractor->textSize += size;
+}
+
+
+// Writes Unicode character as UTF-8
+void rtf_extract_char(RTF_EXTRACTOR* extractor, unsigned int code)
+{
+	char text[4];
+	size_t size;
+	if ( code < 0x80 )
+	{
+		text[0] = (char)code;
+		size = 1;
+	}
+	else if ( code < 0x800 )
+	{
+		text[0] = (char)( 0xC0 | ( code >> 6 ) );
+		text[1] = (char)( 0x80 | ( code & 0x3F ) );
+		size = 2;
+	}
+	else if ( code < 0x10000 )
+	{
+		text[0] = (char)( 0xE0 | ( code >> 12 ) );
+		text[1] = (char)( 0x80 | ( ( code >> 6 ) & 0x3F ) );
+		text[2] = (char)( 0x80 | ( code & 0x3F ) );
+		size = 3;
+	}
+	else
+	{
+		text[0] = (char)( 0xF0 | ( code >> 18 ) );
+		text[1] = (char)( 0x80 | ( ( code >> 12 ) & 0x3F ) );
+		text[2] = (char)( 0x80 | ( ( code >> 6 ) & 0x3F ) );
+		text[3] = (char)( 0x80 | ( code & 0x3F ) );
+		size = 4;
+	}
+	rtf_extract_write( extractor, text, size );
+}
+
+
+// Flushes plain text buffer
+bool rtf_extract_flush(RTF_EXTRACTOR* extractor)
+{
+	if ( extractor->textSize > 0 && fwrite( extractor->textBuffer, 1, extractor->textSize, extractor->textFile ) < extractor->textSize )
+		extractor->writeError = true;
+	extractor->textSize = 0;
+
+	return !extractor->writeError;
+}
+
+
+// Frees RTF text extractor
+void rtf_extract_free(RTF_EXTRACTOR* extractor)
+{
+	delete []extractor->textBuffer;
+	extractor->textBuffer = NULL;
+	delete []extractor->pendingData;
+	extractor->pendingData = NULL;
+	extractor->pendingSize = 0;
+	extractor->pendingCapacity = 0;
+}
+
+
+// Extracts plain text from RTF file
+int rtf_extract_text(char* filename, char* textname)
+{
+	// Set error flag
+	int error = RTF_SUCCESS;
+
+	// Create plain text file
+	FILE* file = fopen( textname, "wb" );
+	if ( file == NULL )
+		return RTF_TEXTFILE_ERROR;
+
+	// Extract plain text in blocks (memory use is bounded by reader and output buffers)
+	RTF_EXTRACTOR extractor;
+	rtf_extract_init( &extractor, file );
+	error = rtf_read_file( filename, rtf_extract_event, &extractor );
+	if ( !rtf_extract_flush( &extractor ) && error == RTF_SUCCESS )
+		error = RTF_TEXTFILE_ERROR;
+	rtf_extract_free( &extractor );
+
+	// Close plain text file
+	if ( fclose(file) && error == RTF_SUCCESS )
+		error = RTF_TEXTFILE_ERROR;
+
+	// Return error flag
+	return error;
+}
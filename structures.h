@@ -1,190 +1,726 @@
-// RTF document format structure
-struct RTF_DOCUMENT_FORMAT
-{
-	int viewKind;							// Sets document view mode
-	int viewScale;							// Sets document zoom level
-	int paperWidth;							// Sets document paper width (the default is 12240)
-	int paperHeight;						// Sets document paper height (the default is 15840)
-	int marginLeft;							// Left margin in twips (the default is 1800)
-	int marginRight;						// Right margin in twips (the default is 1800)
-	int marginTop;							// Top margin in twips (the default is 1440)
-	int marginBottom;						// Bottom margin in twips (the default is 1440)
-	bool facingPages;						// Facing pages (activates odd/even headers and gutters)
-	int gutterWidth;						// Gutter width in twips (the default is 0)
-	bool readOnly;							// User can't edit document
-};
-
-
-
-// RTF section format structure
-struct RTF_SECTION_FORMAT
-{
-	int sectionBreak;						// Sets section break type
-	bool newSection;						// New section
-	bool defaultSection;					// Default section formatting
-	int pageWidth;							// Sets new page width in twips
-	int pageHeight;							// Sets new page height in twips
-	int pageMarginLeft;						// Sets new page left margin in twips
-	int pageMarginRight;					// Sets new page right margin in twips
-	int pageMarginTop;						// Sets new page top margin in twips
-	int pageMarginBottom;					// Sets new page bottom margin in twips
-	int pageGutterWidth;					// Sets new page gutter width in twips
-	int pageHeaderOffset;					// Sets page header offset in twips (the default is 720)
-	int pageFooterOffset;					// Sets page footer offset in twips (the default is 720)
-	bool showPageNumber;					// Show page number
-	int pageNumberOffsetX;					// Sets page number right offset
-	int pageNumberOffsetY;					// Sets page number top offset
-	bool cols;								// Sets column section format
-	int colsNumber;							// Sets number of columns in section
-	int colsDistance;						// Sets distance between columns in twips
-	bool colsLineBetween;					// Sets line between columns
-};
-
-
-
-// RTF tab format structure
-struct RTF_TABS_FORMAT
-{
-	int tabPosition;						// Sets tab position in twips from left margin
-	int tabKind;							// Sets tab kind
-	int tabLead;							// Sets tab lead
-};
-
-
-
-// RTF bullets and numbering format structure
-struct RTF_NUMS_FORMAT
-{
-	int numsLevel;							// Sets paragraph numbered level (11 is bulleted paragraph)
-	int numsSpace;							// Sets paragraph text distance from bulleted char
-	char numsChar;							// Sets paragraph bullet char
-};
-
-
-
-// RTF borders format structure
-struct RTF_BORDERS_FORMAT
-{
-	int borderKind;							// Sets paragraph border kind
-	int borderType;							// Sets paragraph border type
-	int borderWidth;						// Sets paragraph border width in twips
-	int borderColor;						// Sets paragraph border color
-	int borderSpace;						// Sets border distance from paragraph
-};
-
-
-
-// RTF shading format structure
-struct RTF_SHADING_FORMAT
-{
-	int shadingIntensity;					// Sets paragraph shading intensity
-	int shadingType;						// Sets paragraph shading type
-	int shadingFillColor;					// Sets paragraph shading fill color
-	int shadingBkColor;						// Sets paragraph shading background color
-};
-
-
-
-// RTF character format structure
-struct RTF_CHARACTER_FORMAT
-{
-	int animatedCharacter;					// Sets animated text
-	bool boldCharacter;						// Sets text to bold
-	bool capitalCharacter;					// Sets text to capital
-	int backgroundColor;					// Sets text background color (the default is 0)
-	int foregroundColor;					// Sets text foreground color (the default is 0)
-	int scaleCharacter;						// Sets text scaling value (the default is 100)
-	bool embossCharacter;					// Sets text to embossed
-	int expandCharacter;					// Sets expansion or compression of the text
-	int fontNumber;							// Sets font number
-	int fontSize;							// Sets font size (the default is 24)
-	bool italicCharacter;					// Sets text to italic
-	bool engraveCharacter;					// Sets text to engrave
-	int kerningCharacter;					// Sets kerning of the text
-	bool outlineCharacter;					// Sets text to outline
-	bool smallcapitalCharacter;				// Sets text to small capital
-	bool shadowCharacter;					// Sets text shadow
-	bool strikeCharacter;					// Sets text to striketrough
-	bool doublestrikeCharacter;				// Sets text to double striketrough
-	bool subscriptCharacter;				// Sets text to subscript
-	bool superscriptCharacter;				// Sets text to superscript
-	int underlineCharacter;					// Sets text to underline
-};
-
-
-
-// RTF paragraph format structure
-struct RTF_PARAGRAPH_FORMAT
-{
-	int paragraphBreak;						// Sets paragraph break type
-	bool newParagraph;						// New paragraph
-	bool defaultParagraph;					// Default paragraph formatting
-	int paragraphAligment;					// Sets paragraph aligment
-	int firstLineIndent;					// Sets first line indent (the default is 0)
-	int leftIndent;							// Sets paragraph left indent (the default is 0)
-	int rightIndent;						// Sets paragraph right indent (the default is 0)
-	int spaceBefore;						// Sets space before paragraph (the default is 0)
-	int spaceAfter;							// Sets space after paragraph (the default is 0)
-	int lineSpacing;						// Sets line spacing in paragraph
-	char* paragraphText;					// Sets paragraph text
-	bool tabbedText;						// Sets paragraph tabbed text
-	bool tableText;							// Sets paragraph table text
-
-	bool paragraphTabs;						// Paragraph has tabs
-	struct RTF_TABS_FORMAT TABS;			// Paragraf RTF_TAB_FORMAT structure
-
-	bool paragraphNums;						// Paragraph is numbered (bulleted)
-	struct RTF_NUMS_FORMAT NUMS;			// Paragraph RTF_NUMS_FORMAT structure
-
-	bool paragraphBorders;					// Paragraph has borders
-	struct RTF_BORDERS_FORMAT BORDERS;		// Paragraph RTF_BORDERS_FORMAT structure
-
-	bool paragraphShading;					// Paragraph has shading
-	struct RTF_SHADING_FORMAT SHADING;		// Paragraph RTF_SHADING_FORMAT structure
-
-	struct RTF_CHARACTER_FORMAT CHARACTER;	// Paragraph RTF_CHARACTER_FORMAT structure
-};
-
-
-
-// RTF table border format structure
-struct RTF_TABLEBORDER_FORMAT
-{
-	bool border;							// Border exists
-	struct RTF_BORDERS_FORMAT BORDERS;		// RTF_BORDERS_FORMAT structure
-};
-
-
-
-// RTF table row format structure
-struct RTF_TABLEROW_FORMAT
-{
-	int rowAligment;						// Sets table row aligment
-	int rowHeight;							// Sets table row height (the default is 0)
-	int marginLeft;							// Sets default cell left margin
-	int marginRight;						// Sets default cell right margin
-	int marginTop;							// Sets default cell top margin
-	int marginBottom;						// Sets default cell bottom margin
-	int rowLeftMargin;						// Sets default row left margin
-};
-
-
-
-// RTF table cell format structure
-struct RTF_TABLECELL_FORMAT
-{
-	int textVerticalAligment;						// Sets text vertical aligment
-	int marginLeft;									// Sets cell left margin
-	int marginRight;								// Sets cell right margin
-	int marginTop;									// Sets cell top margin
-	int marginBottom;								// Sets cell bottom margin
-	int textDirection;								// Sets text direction
-
-	bool cellShading;								// Cell has shading
-	struct RTF_SHADING_FORMAT SHADING;				// Cell RTF_SHADING_FORMAT structure
-
-	struct RTF_TABLEBORDER_FORMAT borderLeft;		// Cell RTF_TABLEBORDER_FORMAT structure
-	struct RTF_TABLEBORDER_FORMAT borderRight;		// Cell RTF_TABLEBORDER_FORMAT structure
-	struct RTF_TABLEBORDER_FORMAT borderTop;		// Cell RTF_TABLEBORDER_FORMAT structure
-	struct RTF_TABLEBORDER_FORMAT borderBottom;		// Cell RTF_TABLEBORDER_FORMAT structure
-};
+// RTF document format structure
+struct RTF_DOCUMENT_FORMAT
+{
+	int viewKind;							// Sets document view mode
+	int viewScale;							// Sets document zoom level
+	int paperWidth;							// Sets document paper width (the default is 12240)
+	int paperHeight;						// Sets document paper height (the default is 15840)
+	int marginLeft;							// Left margin in twips (the default is 1800)
+	int marginRight;						// Right margin in twips (the default is 1800)
+	int marginTop;							// Top margin in twips (the default is 1440)
+	int marginBottom;						// Bottom margin in twips (the default is 1440)
+	bool facingPages;						// Facing pages (activates odd/even headers and gutters)
+	int gutterWidth;						// Gutter width in twips (the default is 0)
+	bool readOnly;							// User can't edit document
+};
+
+
+
+// RTF section format structure
+struct RTF_SECTION_FORMAT
+{
+	int sectionBreak;						// Sets section break type
+	bool newSection;						// New section
+	bool defaultSection;					// Default section formatting
+	int pageWidth;							// Sets new page width in twips
+	int pageHeight;							// Sets new page height in twips
+	int pageMarginLeft;						// Sets new page left margin in twips
+	int pageMarginRight;					// Sets new page right margin in twips
+	int pageMarginTop;						// Sets new page top margin in twips
+	int pageMarginBottom;					// Sets new page bottom margin in twips
+	int pageGutterWidth;					// Sets new page gutter width in twips
+	int pageHeaderOffset;					// Sets page header offset in twips (the default is 720)
+	int pageFooterOffset;					// Sets page footer offset in twips (the default is 720)
+	bool showPageNumber;					// Show page number
+	int pageNumberOffsetX;					// Sets page number right offset
+	int pageNumberOffsetY;					// Sets page number top offset
+	bool cols;								// Sets column section format
+	int colsNumber;							// Sets number of columns in section
+	int colsDistance;						// Sets distance between columns in twips
+	bool colsLineBetween;					// Sets line between columns
+};
+
+
+
+// RTF tab format structure
+struct RTF_TABS_FORMAT
+{
+	int tabPosition;						// Sets tab position in twips from left margin
+	int tabKind;							// Sets tab kind
+	int tabLead;							// Sets tab lead
+};
+
+
+
+// RTF bullets and numbering format structure
+struct RTF_NUMS_FORMAT
+{
+	int numsLevel;							// Sets paragraph numbered level (11 is bulleted paragraph)
+	int numsSpace;							// Sets paragraph text distance from bulleted char
+	char numsChar;							// Sets paragraph bullet char
+};
+
+
+
+// RTF borders format structure
+struct RTF_BORDERS_FORMAT
+{
+	int borderKind;							// Sets paragraph border kind
+	int borderType;							// Sets paragraph border type
+	int borderWidth;						// Sets paragraph border width in twips
+	int borderColor;						// Sets paragraph border color
+	int borderSpace;						// Sets border distance from paragraph
+};
+
+
+
+// RTF shading format structure
+struct RTF_SHADING_FORMAT
+{
+	int shadingIntensity;					// Sets paragraph shading intensity
+	int shadingType;						// Sets paragraph shading type
+	int shadingFillColor;					// Sets paragraph shading fill color
+	int shadingBkColor;						// Sets paragraph shading background color
+};
+
+
+
+// RTF character format structure
+struct RTF_CHARACTER_FORMAT
+{
+	int animatedCharacter;					// Sets animated text
+	bool boldCharacter;						// Sets text to bold
+	bool capitalCharacter;					// Sets text to capital
+	int backgroundColor;					// Sets text background color (the default is 0)
+	int foregroundColor;					// Sets text foreground color (the default is 0)
+	int scaleCharacter;						// Sets text scaling value (the default is 100)
+	bool embossCharacter;					// Sets text to embossed
+	int expandCharacter;					// Sets expansion or compression of the text
+	int fontNumber;							// Sets font number
+	int fontSize;							// Sets font size (the default is 24)
+	bool italicCharacter;					// Sets text to italic
+	bool engraveCharacter;					// Sets text to engrave
+	int kerningCharacter;					// Sets kerning of the text
+	bool outlineCharacter;					// Sets text to outline
+	bool smallcapitalCharacter;				// Sets text to small capital
+	bool shadowCharacter;					// Sets text shadow
+	bool strikeCharacter;					// Sets text to striketrough
+	bool doublestrikeCharacter;				// Sets text to double striketrough
+	bool subscriptCharacter;				// Sets text to subscript
+	bool superscriptCharacter;				// Sets text to superscript
+	int underlineCharacter;					// Sets text to underline
+};
+
+
+
+// RTF paragraph format structure
+struct RTF_PARAGRAPH_FORMAT
+{
+	int paragraphBreak;						// Sets paragraph break type
+	bool newParagraph;						// New paragraph
+	bool defaultParagraph;					// Default paragraph formatting
+	int paragraphAligment;					// Sets paragraph aligment
+	int firstLineIndent;					// Sets first line indent (the default is 0)
+	int leftIndent;							// Sets paragraph left indent (the default is 0)
+	int rightIndent;						// Sets paragraph right indent (the default is 0)
+	int spaceBefore;						// Sets space before paragraph (the default is 0)
+	int spaceAfter;							// Sets space after paragraph (the default is 0)
+	int lineSpacing;						// Sets line spacing in paragraph
+	char* paragraphText;					// Sets paragraph text
+	bool tabbedText;						// Sets paragraph tabbed text
+	bool tableText;							// Sets paragraph table text
+
+	bool paragraphTabs;						// Paragraph has tabs
+	struct RTF_TABS_FORMAT TABS;			// Paragraf RTF_TAB_FORMAT structure
+
+	bool paragraphNums;						// Paragraph is numbered (bulleted)
+	struct RTF_NUMS_FORMAT NUMS;			// Paragraph RTF_NUMS_FORMAT structure
+
+	bool paragraphBorders;					// Paragraph has borders
+	struct RTF_BORDERS_FORMAT BORDERS;		// Paragraph RTF_BORDERS_FORMAT structure
+
+	bool paragraphShading;					// Paragraph has shading
+	struct RTF_SHADING_FORMAT SHADING;		// Paragraph RTF_SHADING_FORMAT structure
+
+	struct RTF_CHARACTER_FORMAT CHARACTER;	// Paragraph RTF_CHARACTER_FORMAT structure
+};
+
+
+
+// RTF table border format structure
+struct RTF_TABLEBORDER_FORMAT
+{
+	bool border;							// Border exists
+	struct RTF_BORDERS_FORMAT BORDERS;		// RTF_BORDERS_FORMAT structure
+};
+
+
+
+// RTF table row format structure
+struct RTF_TABLEROW_FORMAT
+{
+	int rowAligment;						// Sets table row aligment
+	int rowHeight;							// Sets table row height (the default is 0)
+	int marginLeft;							// Sets default cell left margin
+	int marginRight;						// Sets default cell right margin
+	int marginTop;							// Sets default cell top margin
+	int marginBottom;						// Sets default cell bottom margin
+	int rowLeftMargin;						// Sets default row left margin
+};
+
+
+
+// RTF table cell format structure
+struct RTF_TABLECELL_FORMAT
+{
+	int textVerticalAligment;						// Sets text vertical aligment
+	int marginLeft;									// Sets cell left margin
+	int marginRight;								// Sets cell right margin
+	int marginTop;									// Sets cell top margin
+	int marginBottom;								// Sets cell bottom margin
+	int textDirection;								// Sets text direction
+
+	bool cellShading;								// Cell has shading
+	struct RTF_SHADING_FORMAT SHADING;				// Cell RTF_SHADING_FORMAT structure
+
+	struct RTF_TABLEBORDER_FORMAT borderLeft;		// Cell RTF_TABLEBORDER_FORMAT structure
+	struct RTF_TABLEBORDER_FORMAT borderRight;		// Cell RTF_TABLEBORDER_FORMAT structure
+	struct RTF_TABLEBORDER_FORMAT borderTop;		// Cell RTF_TABLEBORDER_FORMAT structure
+	struct RTF_TABLEBORDER_FORMAT borderBottom;		// Cell RTF_TABLEBORDER_FORMAT structure
+};
+
+
+
+// RTF template field structure
+struct RTF_TEMPLATE_FIELD
+{
+	char fieldName[64];								// Field name
+	int fieldType;									// Field type (sets escaping rules for field value)
+	int fieldIndex;									// Field value index (fields with same name share value)
+	size_t fieldOffset;								// Field offset in template constant data
+};
+
+
+
+// RTF template structure
+struct RTF_TEMPLATE
+{
+	char* templateData;								// Template constant data (all constant segments)
+	size_t dataSize;								// Template constant data size
+	size_t dataCapacity;							// Template constant data allocated size
+	struct RTF_TEMPLATE_FIELD* templateFields;		// Template field slots (sorted by offset)
+	int fieldCount;									// Number of template field slots
+	int fieldCapacity;								// Allocated number of template field slots
+	int valueCount;									// Number of distinct field values
+	char* renderBuffer;								// Rendered template instance (reused between instances)
+	size_t renderCapacity;							// Rendered template instance allocated size
+};
+
+
+
+// RTF hash table entry structure
+struct RTF_HASH_ENTRY
+{
+	unsigned int entryHash;							// Entry key hash
+	char* entryKey;									// Entry key (NULL is empty entry)
+	int entryValue;									// Entry value
+};
+
+
+
+// RTF arena block structure (block data follows structure)
+struct RTF_ARENA_BLOCK
+{
+	struct RTF_ARENA_BLOCK* nextBlock;				// Next block (blocks are kept for reuse)
+	size_t blockSize;								// Block data size
+};
+
+
+
+// RTF arena structure (bump allocator released at once)
+struct RTF_ARENA
+{
+	RTF_ARENA_BLOCK* firstBlock;					// First block (NULL if none)
+	RTF_ARENA_BLOCK* currentBlock;					// Block of next allocation (NULL if arena is released)
+	size_t currentUsed;								// Used size of current block (next blocks are unused)
+};
+
+
+
+// RTF arena mark structure
+struct RTF_ARENA_MARK
+{
+	RTF_ARENA_BLOCK* markBlock;						// Current block at mark
+	size_t markUsed;								// Used size of current block at mark
+};
+
+
+
+// RTF hash table structure
+struct RTF_HASH_TABLE
+{
+	struct RTF_HASH_ENTRY* tableEntries;			// Hash table entries (open addressing)
+	int tableSize;									// Number of hash table entries (power of two)
+	int entryCount;									// Number of used hash table entries
+	struct RTF_ARENA* keyArena;						// Arena of entry keys (NULL if keys are allocated on heap)
+};
+
+
+
+// RTF reader event structure
+struct RTF_READER_EVENT
+{
+	int eventType;									// Event type
+	const char* eventData;							// Event data (text run, control word name or symbol, binary data)
+	size_t eventSize;								// Event data size
+	bool hasParameter;								// Control word has numeric parameter
+	int eventParameter;								// Control word parameter, hexadecimal character value or binary data size
+	int groupDepth;									// Group depth after event
+	size_t eventOffset;								// Event offset in RTF stream
+	struct RTF_READER* eventReader;					// Reader that reported event
+};
+
+
+
+// RTF reader event callback (returns false to stop reading)
+typedef bool (*RTF_READER_CALLBACK)(struct RTF_READER_EVENT* event, void* param);
+
+
+
+// RTF reader structure
+struct RTF_READER
+{
+	RTF_READER_CALLBACK readerCallback;				// Event callback
+	void* readerParam;								// Event callback param
+	int groupDepth;									// Current group depth
+	size_t readerOffset;							// Offset of next parsed data in RTF stream
+	bool readerStopped;								// Reading is stopped by event callback
+	const char* headerData;							// Document header (font/color tables, stylesheet) in parallel reading
+	size_t headerSize;								// Document header size
+};
+
+
+
+// RTF reader header scan structure
+struct RTF_READER_HEADER
+{
+	size_t headerSize;								// Document header size
+	bool groupStart;								// Next control word names top-level group
+	bool tableGroup;								// Current top-level group is header table
+};
+
+
+
+// RTF reader chunk structure
+struct RTF_READER_CHUNK
+{
+	RTF_READER chunkReader;							// Chunk reader
+	const char* chunkData;							// Chunk data
+	size_t chunkSize;								// Chunk data size
+	size_t availableSize;							// Readable data size from chunk start
+	bool chunkEscaped;								// First chunk character is escaped by backslash
+	bool lastChunk;									// Chunk ends at split point or RTF stream end
+	int depthChange;								// Group depth change in chunk
+	bool binaryData;								// Chunk contains \bin control word
+	size_t parsedSize;								// Parsed chunk data size
+	RTF_READER_EVENT* chunkEvents;					// Buffered chunk events
+	size_t eventCount;								// Number of buffered chunk events
+	size_t eventCapacity;							// Buffered chunk events capacity
+};
+
+
+
+// RTF text extractor structure
+struct RTF_EXTRACTOR
+{
+	RTF_READER extractorReader;						// Reader of streamed RTF data
+	FILE* textFile;									// Plain text file
+	char* textBuffer;								// Plain text output buffer
+	size_t textSize;								// Plain text output buffer size
+	int skipDepth;									// Depth of skipped destination group (0 if none)
+	bool groupStart;								// Next control word names group
+	int unicodeSkip[RTF_EXTRACTOR_MAXDEPTH];		// Characters skipped after \uN per group depth
+	int skipCount;									// Characters left to skip after \uN
+	unsigned int highSurrogate;						// Pending UTF-16 high surrogate
+	char* pendingData;								// Incomplete token of streamed RTF data
+	size_t pendingSize;								// Incomplete token size
+	size_t pendingCapacity;							// Incomplete token capacity
+	bool writeError;								// Plain text could not be written
+};
+
+
+
+// RTF minifier control word structure
+struct RTF_MINIFY_WORD
+{
+	const char* wordName;							// Control word name
+	int wordProperty;								// Formatting property (or content, \pard, \plain)
+	int wordValue;									// Property value (or parameter, toggle)
+	int wordDefault;								// Property value if parameter is missing
+};
+
+
+
+// RTF minifier formatting state structure
+struct RTF_MINIFY_STATE
+{
+	int propertyValues[RTF_MINIFY_PROPERTIES];		// Formatting property values
+	bool paragraphKnown;							// Paragraph properties are known (after \pard)
+	bool characterKnown;							// Character properties are known (after \plain)
+	char paragraphExtras[RTF_MINIFY_EXTRASIZE];		// Other paragraph control words since \pard (tabs, borders, shading)
+};
+
+
+
+// RTF minifier structure
+struct RTF_MINIFIER
+{
+	FILE* outputFile;								// Minified RTF file
+	char* outputBuffer;								// Output buffer
+	size_t outputSize;								// Output buffer size
+	size_t outputTotal;								// Number of written bytes
+	bool writeError;								// Minified RTF could not be written
+	bool needSpace;									// Last control word needs delimiter before text
+	bool binaryPictures;							// Hexadecimal picture data is written as \bin
+	RTF_MINIFY_STATE defaultState;					// Formatting state after \pard and \plain
+	RTF_MINIFY_STATE* groupStates;					// Written formatting state per group depth
+	int stateCapacity;								// Group states capacity
+	int groupDepth;									// Current group depth
+	bool groupStart;								// Next token is first in group
+	RTF_MINIFY_STATE pendingState;					// Formatting state after pending control words
+	bool pendingWords;								// There are pending formatting control words
+	bool pendingTouched[RTF_MINIFY_PROPERTIES];		// Property is set by pending control words
+	size_t extrasStart;								// Paragraph extras length before pending control words
+	int verbatimDepth;								// Depth of group written unchanged (0 if none)
+	int pictureDepth;								// Depth of picture group with hexadecimal data (0 if none)
+	bool pictureSafe;								// Picture data can be written as \bin
+	char* pictureData;								// Buffered hexadecimal picture data
+	size_t pictureSize;								// Buffered picture data size
+	size_t pictureCapacity;							// Buffered picture data capacity
+};
+
+
+
+// RTF output size analyzer family structure
+struct RTF_ANALYZE_FAMILY
+{
+	char familyName[RTF_ANALYZE_NAMESIZE];			// Family name (control word, destination data, text or group braces)
+	ULONGLONG familyBytes;							// Output bytes of family tokens (delimiters and line breaks included)
+	ULONGLONG familyCount;							// Number of family tokens
+	ULONGLONG redundantBytes;						// Output bytes of tokens that set unchanged formatting value
+	ULONGLONG redundantCount;						// Number of tokens that set unchanged formatting value
+};
+
+
+
+// RTF output size analyzer group state structure
+struct RTF_ANALYZE_STATE
+{
+	int propertyValues[RTF_MINIFY_PROPERTIES];		// Formatting property values (RTF_ANALYZE_UNKNOWN if unknown)
+	int dataFamily;									// Family of destination group data (-1 outside destination group)
+};
+
+
+
+// RTF output size analyzer structure
+struct RTF_ANALYZER
+{
+	RTF_READER analyzerReader;						// Reader of streamed RTF data
+	RTF_HASH_TABLE familyHash;						// Family index by name
+	RTF_ANALYZE_FAMILY* analyzeFamilies;			// Control word families
+	int familyCount;								// Number of families
+	int familyCapacity;								// Families capacity
+	RTF_ANALYZE_STATE* groupStates;					// Formatting state per group depth
+	int stateCapacity;								// Group states capacity
+	int defaultFont;								// Font set by \plain (\deff)
+	bool groupStart;								// Next token is first in group
+	bool ignorableStart;							// Next control word names ignorable destination group
+	int tokenFamily;								// Family of last token (-1 if none)
+	int tokenType;									// Event type of last token
+	bool tokenRedundant;							// Last token sets unchanged formatting value
+	size_t tokenOffset;								// Last token offset in RTF stream
+	ULONGLONG totalSize;							// Analyzed RTF data size
+	char* pendingData;								// Incomplete token of streamed RTF data
+	size_t pendingSize;								// Incomplete token size
+	size_t pendingCapacity;							// Incomplete token capacity
+};
+
+
+
+// RTF merge control word structure
+struct RTF_MERGE_WORD
+{
+	const char* wordName;							// Control word name
+	int wordKind;									// Font or color number, or \plain
+};
+
+
+
+// RTF merge buffer structure
+struct RTF_MERGE_BUFFER
+{
+	char* bufferData;								// Buffer data
+	size_t bufferSize;								// Buffer data size
+	size_t bufferCapacity;							// Buffer capacity
+};
+
+
+
+// RTF merge structure
+struct RTF_MERGER
+{
+	RTF_HASH_TABLE fontHash;						// Merged font table entries
+	RTF_HASH_TABLE colorHash;						// Merged color table entries
+	RTF_MERGE_BUFFER fontTable;						// Merged font table group
+	RTF_MERGE_BUFFER colorTable;					// Merged color table group
+	RTF_HASH_TABLE listHash;						// Merged list table entries
+	RTF_HASH_TABLE overrideHash;					// Merged list override table entries
+	RTF_MERGE_BUFFER listTable;						// Merged list table group
+	RTF_MERGE_BUFFER overrideTable;					// Merged list override table group
+	int fontCount;									// Number of merged fonts
+	int colorCount;									// Number of merged colors
+	int listCount;									// Number of merged lists
+	int overrideCount;								// Number of merged list overrides
+	int defaultFont;								// Merged default font
+};
+
+
+
+// RTF merge document structure
+struct RTF_MERGE_DOCUMENT
+{
+	char* fileName;									// RTF file name
+	int documentIndex;								// Document position in merged RTF file
+	int documentError;								// Document error flag
+	RTF_MERGER* documentMerger;						// Merged font and color tables
+	size_t bodyStart;								// Document content start (after header tables)
+	int defaultFont;								// Document default font (\deffN)
+	char* fontTable;								// Document font table (until registered)
+	char* colorTable;								// Document color table (until registered)
+	char* listTable;								// Document list table (until registered)
+	char* overrideTable;							// Document list override table (until registered)
+	int* fontNumbers;								// Document font numbers
+	int* fontIndexes;								// Merged font indexes of document fonts
+	int fontCount;									// Number of document fonts
+	int* colorIndexes;								// Merged color indexes of document colors
+	int colorCount;									// Number of document colors
+	int* overrideNumbers;							// Document list override numbers (\lsN)
+	int* overrideIndexes;							// Merged list override numbers of document overrides
+	int overrideCount;								// Number of document list overrides
+	int plainFont;									// Merged font after \plain (-1 if merged default font)
+	int* fontMap;									// Document font number to merged font index
+	int fontMapSize;								// Number of font map entries
+	int* overrideMap;								// Document list override number to merged list override number
+	int overrideMapSize;							// Number of list override map entries
+	char* fileData;									// RTF file data
+	size_t fileSize;								// RTF file data size
+	RTF_MERGE_BUFFER documentOutput;				// Rewritten document
+	size_t copyPosition;							// File data not yet copied to output
+	int skipDepth;									// Depth of replaced group (0 if none)
+	bool groupStart;								// Next control word names top-level group
+	size_t groupPosition;							// Top-level group start
+	size_t wordEnd;									// Last control word end (before delimiter)
+	bool listsWritten;								// Merged list tables written (first document)
+};
+
+
+
+// RTF merge worker structure
+struct RTF_MERGE_WORKER
+{
+	RTF_MERGE_DOCUMENT* workerDocuments;			// First worker document
+	int documentCount;								// Number of batch documents from first worker document
+	int documentStep;								// Document step (number of workers)
+};
+
+
+
+// RTF section index entry structure
+struct RTF_INDEX_ENTRY
+{
+	ULONGLONG entryOffset;							// Entry byte offset in RTF document
+	int entryType;									// Entry type (section or table row)
+	int breakSize;									// Size of section break before entry offset
+	int sectionNumber;								// Section number (from 0)
+	int tableNumber;								// Number of tables started (with table of entry row)
+	int rowNumber;									// Number of table rows started (with entry row)
+	int paragraphNumber;							// Number of paragraphs started before entry
+	int formatSize;									// Size of section formatting after entry offset
+	bool keyedSection;								// Section has content key and hash
+	unsigned int sectionKey;						// Section content key hash
+	unsigned int sectionHash;						// Section content hash
+};
+
+
+
+// RTF section index file header structure
+struct RTF_INDEX_HEADER
+{
+	char indexMagic[8];								// Section index file signature
+	ULONGLONG bodyEnd;								// RTF document content end (before end part)
+	ULONGLONG documentSize;							// RTF document size
+	int entryCount;									// Number of index entries
+	int sectionCount;								// Number of sections
+	int tableCount;									// Number of tables
+	int rowCount;									// Number of table rows
+	int paragraphCount;								// Number of paragraphs
+};
+
+
+
+// RTF section index structure
+struct RTF_INDEX
+{
+	char indexName[1024];							// Section index file name
+	RTF_INDEX_ENTRY* indexEntries;					// Index entries
+	int entryCount;									// Number of index entries
+	int entryCapacity;								// Index entries capacity
+	ULONGLONG writtenSize;							// Number of RTF document bytes written
+	ULONGLONG rowEnd;								// RTF document offset after last table row
+	ULONGLONG bodyEnd;								// RTF document content end (before end part)
+	int sectionCount;								// Number of sections
+	int tableCount;									// Number of tables
+	int rowCount;									// Number of table rows
+	int paragraphCount;								// Number of paragraphs
+	int sectionEntry;								// Index entry of current section
+	int checkpointEntries;							// Index entries written to checkpoint entries file
+	int checkpointSection;							// Index entry of current section at last checkpoint
+};
+
+
+
+// RTF table of contents entry structure
+struct RTF_TOC_ENTRY
+{
+	RTF_TOC_ENTRY* nextEntry;						// Next entry (entries are allocated from document arena)
+	int entryLevel;									// Heading level (from 1)
+	int bookmarkNumber;								// Heading bookmark number (_TocN)
+	size_t textSize;								// Heading text size
+	char* entryText;								// Heading text
+};
+
+
+
+// RTF table of contents structure
+struct RTF_TOC
+{
+	bool tocReserved;								// Table of contents region is reserved
+	ULONGLONG tocOffset;							// Region offset in RTF document (in spooled body with deferred header)
+	size_t tocSize;									// Region size (0 with deferred header, contents are spliced into body)
+	RTF_TOC_ENTRY* firstEntry;						// First heading entry
+	RTF_TOC_ENTRY* lastEntry;						// Last heading entry
+	int entryCount;									// Number of heading entries
+};
+
+
+
+// RTF previous document structure
+struct RTF_PREVIOUS
+{
+	FILE* previousFile;								// Previous RTF document
+	RTF_INDEX_HEADER indexHeader;					// Previous section index header
+	RTF_INDEX_ENTRY* indexEntries;					// Previous section index entries
+	RTF_HASH_TABLE sectionHash;						// Keyed section entries by key hash
+	char* fontTable;								// Previous RTF document font table
+	char* colorTable;								// Previous RTF document color table
+	int copiedSections;								// Number of sections copied to current RTF document
+};
+
+
+
+// RTF writer checkpoint structure
+struct RTF_CHECKPOINT
+{
+	char checkpointMagic[8];						// Checkpoint file signature
+	char fileName[1024];							// RTF document file name
+	bool binaryFile;								// RTF document is binary mode file (opened for appending)
+	ULONGLONG fileOffset;							// RTF document size at checkpoint
+	RTF_DOCUMENT_FORMAT documentFormat;				// RTF document formatting params
+	RTF_SECTION_FORMAT sectionFormat;				// RTF section formatting params
+	RTF_PARAGRAPH_FORMAT paragraphFormat;			// RTF paragraph formatting params (without paragraph text)
+	RTF_TABLEROW_FORMAT rowFormat;					// RTF table row formatting params
+	RTF_TABLECELL_FORMAT cellFormat;				// RTF table cell formatting params
+	char fontTable[4096];							// RTF document font table
+	size_t colorTableLength;						// RTF document color table length (table follows structure)
+	int colorLevels;								// Quantized color levels per channel
+	RTF_NUMS_FORMAT lists[RTF_LIST_MAXCOUNT];		// RTF document list table
+	int listCount;									// Number of lists
+	bool indexed;									// RTF document is indexed
+	RTF_INDEX index;								// Section index state (entries are stored in entries file)
+	RTF_INDEX_ENTRY sectionEntry;					// Current section index entry (can change after checkpoint)
+};
+
+
+
+// RTF writer statistics structure
+struct RTF_STATS
+{
+	ULONGLONG documentCount;						// Number of RTF documents started
+	ULONGLONG bytesWritten;							// RTF data bytes written
+	ULONGLONG controlBytes;							// Control word bytes written (all except text and image data)
+	ULONGLONG textBytes;							// Paragraph text bytes written
+	ULONGLONG imageBytes;							// Image data bytes written
+	ULONGLONG writeCalls;							// RTF document file write calls
+	ULONGLONG flushCalls;							// RTF document file flush and close calls
+	ULONGLONG sectionCount;							// Number of sections
+	ULONGLONG paragraphCount;						// Number of paragraphs
+	ULONGLONG rowCount;								// Number of table rows
+	ULONGLONG cellCount;							// Number of table cells
+	ULONGLONG imageCount;							// Number of images
+	ULONGLONG cacheHits;							// Font and color lookups found in tables or color cache
+	ULONGLONG cacheMisses;							// Font and color lookups added to tables
+	ULONGLONG allocationCount;						// Number of writer allocations
+	ULONGLONG callCount[RTF_STATS_CALLS];			// Number of calls per entry point
+	ULONGLONG callTime[RTF_STATS_CALLS];			// Time spent per entry point (microseconds, nested calls included)
+};
+
+
+
+// RTF writer memory usage structure
+struct RTF_MEMORY_USAGE
+{
+	size_t memoryBudget;							// Memory budget (0 if unlimited)
+	size_t memoryUsed;								// Writer memory in use
+	size_t memoryPeak;								// Writer memory high-water mark
+	size_t subsystemUsed[RTF_MEMORY_SUBSYSTEMS];	// Memory in use per subsystem
+	size_t subsystemPeak[RTF_MEMORY_SUBSYSTEMS];	// Memory high-water mark per subsystem
+	ULONGLONG spillCount;							// Number of body spools moved to disk to stay within budget
+	ULONGLONG deniedCount;							// Number of optional allocations refused (color cache, images)
+	ULONGLONG refusedCount;							// Number of required allocations refused (RTF document fails with memory error)
+};
+
+
+
+// RTF trace event structure
+struct RTF_TRACE_EVENT
+{
+	const char* eventName;							// Event name (static string)
+	LONGLONG eventStart;							// Event start time (performance counter)
+	LONGLONG eventEnd;								// Event end time (performance counter)
+	DWORD threadId;									// Thread that recorded event
+	int eventValue;									// Event value (section number, number of rows, bytes)
+};
+
+
+
+// RTF trace buffer structure (ring of events written by one thread at a time)
+struct RTF_TRACE_BUFFER
+{
+	LONG bufferOwner;								// Thread that writes buffer (0 if buffer is free, guarded by trace lock)
+	volatile LONG eventCount;						// Number of events written (ring position)
+	RTF_TRACE_EVENT traceEvents[RTF_TRACE_BUFFERSIZE];	// Event ring
+};
+
+
+
+// RTF writer trace spans structure
+struct RTF_TRACE_SPANS
+{
+	LONGLONG sectionStart;							// Current section start time (0 if no section)
+	int sectionCount;								// Number of traced sections
+	LONGLONG tableStart;							// Current table start time (0 if no table)
+	LONGLONG rowEnd;								// Last table row end time
+	int rowCount;									// Number of rows in current table
+	ULONGLONG writeCount;							// Number of RTF data writes
+	ULONGLONG rowWrites;							// Number of RTF data writes at last table row end
+};
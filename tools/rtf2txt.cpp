@@ -0,0 +1,42 @@
+#include "../errors.h"
+#include "../globals.h"
+#include "../rtflib.h"
+
+
+
+// Extracts plain text (UTF-8) from RTF files for search indexing
+//
+// Usage: rtf2txt file.rtf [file.txt]
+//
+// Without text file argument, text is written next to RTF file with .txt extension.
+int main(int argc, char* argv[])
+{
+	if ( argc < 2 )
+	{
+		printf( "usage: rtf2txt file.rtf [file.txt]\n" );
+		return 1;
+	}
+
+	// Get plain text file name
+	char textname[1024];
+	if ( argc > 2 )
+		strcpy( textname, argv[2] );
+	else
+	{
+		strcpy( textname, argv[1] );
+		char* extension = strrchr( textname, '.' );
+		if ( extension != NULL && strchr( extension, '\\' ) == NULL && strchr( extension, '/' ) == NULL )
+			*extension = '\0';
+		strcat( textname, ".txt" );
+	}
+
+	// Extract plain text
+	int error = rtf_extract_text( argv[1], textname );
+	if ( error != RTF_SUCCESS )
+	{
+		printf( "rtf2txt: could not extract %s (error 0x%04X)\n", argv[1], error );
+		return 1;
+	}
+
+	return 0;
+}
@@ -0,0 +1,448 @@
+#include "../errors.h"
+#include "../globals.h"
+#include "../rtflib.h"
+#include <psapi.h>
+#include <new>
+#ifdef _DEBUG
+#include <crtdbg.h>
+#endif
+
+// Process memory counters are in psapi library
+#pragma comment( lib, "psapi.lib" )
+
+
+
+// Maximum number of call latency samples per workload (reservoir sampled after that)
+#define RTFBENCH_MAXSAMPLES					1048576
+
+
+
+// Benchmark workload structure
+struct RTF_BENCH_WORKLOAD
+{
+	char* workloadName;								// Workload name
+	int (*workloadWriter)(int scale);				// Writes workload documents (returns number of documents)
+};
+
+
+
+// Benchmark result structure
+struct RTF_BENCH_RESULT
+{
+	int documentCount;								// Number of documents written
+	ULONGLONG documentSize;							// Total size of documents written
+	double totalSeconds;							// Workload time in seconds
+	ULONGLONG callCount;							// Number of timed rtflib calls
+	double callLatency[5];							// Call latency percentiles (50, 90, 99, 99.9, 100) in microseconds
+	ULONGLONG allocationCount;						// Number of allocations
+	ULONGLONG allocationSize;						// Allocated bytes
+	ULONGLONG heapAllocationCount;					// Number of all CRT heap allocations (malloc, file buffers, debug CRT only)
+	size_t peakMemory;								// Process peak working set after workload
+	RTF_MEMORY_USAGE writerMemory;					// Writer memory high-water marks of workload
+	bool skipped;									// Workload could not be run
+};
+
+
+
+// Benchmark params
+char* rtfBenchFile = "rtfbench.rtf";
+char* rtfBenchImage = "Picture.jpg";
+char* rtfBenchText = "Lorem ipsum dolor sit amet, consectetur adipiscing elit, sed do eiusmod tempor incididunt ut labore et dolore magna aliqua.";
+ULONGLONG rtfBenchSize = 0;
+size_t rtfBenchBudget = 0;
+
+// Call latency samples (in performance counter ticks)
+LONGLONG* rtfBenchSamples = NULL;
+int rtfBenchSampleCount = 0;
+ULONGLONG rtfBenchCallCount = 0;
+unsigned int rtfBenchRandom = 1;
+LARGE_INTEGER rtfBenchCallStart;
+
+// Allocation counters
+ULONGLONG rtfBenchAllocations = 0;
+ULONGLONG rtfBenchAllocated = 0;
+ULONGLONG rtfBenchHeapAllocations = 0;
+bool rtfBenchCounting = false;
+
+
+
+#ifdef _DEBUG
+// Counts all CRT heap allocations made while workload is running (malloc and C runtime file buffers included)
+int rtfbench_allochook(int type, void* data, size_t size, int block, long request, const unsigned char* file, int line)
+{
+	if ( rtfBenchCounting && ( type == _HOOK_ALLOC || type == _HOOK_REALLOC ) )
+		rtfBenchHeapAllocations++;
+	return TRUE;
+}
+#endif
+
+
+// Counts writer allocations made while workload is running (rtflib writer is single threaded)
+void* operator new(size_t size)
+{
+	if ( rtfBenchCounting )
+	{
+		rtfBenchAllocations++;
+		rtfBenchAllocated += size;
+	}
+	void* p = malloc( size > 0 ? size : 1 );
+	if ( p == NULL )
+		throw std::bad_alloc();
+	return p;
+}
+
+
+void* operator new[](size_t size)
+{
+	return operator new(size);
+}
+
+
+void operator delete(void* p)
+{
+	free(p);
+}
+
+
+void operator delete[](void* p)
+{
+	free(p);
+}
+
+
+// Times rtflib call
+#define RTFBENCH_CALL(call)		{ QueryPerformanceCounter(&rtfBenchCallStart); call; rtfbench_sample(); }
+
+
+// Records call latency sample
+void rtfbench_sample()
+{
+	LARGE_INTEGER end;
+	QueryPerformanceCounter(&end);
+	LONGLONG ticks = end.QuadPart - rtfBenchCallStart.QuadPart;
+
+	// Keep uniform sample of all calls when sample buffer is full
+	rtfBenchCallCount++;
+	if ( rtfBenchSampleCount < RTFBENCH_MAXSAMPLES )
+		rtfBenchSamples[rtfBenchSampleCount++] = ticks;
+	else
+	{
+		rtfBenchRandom = rtfBenchRandom * 1103515245 + 12345;
+		ULONGLONG slot = ( (ULONGLONG)rtfBenchRandom << 16 ^ rtfBenchRandom >> 16 ) % rtfBenchCallCount;
+		if ( slot < RTFBENCH_MAXSAMPLES )
+			rtfBenchSamples[slot] = ticks;
+	}
+}
+
+
+// Compares latency samples
+int rtfbench_compare(const void* a, const void* b)
+{
+	LONGLONG x = *(const LONGLONG*)a, y = *(const LONGLONG*)b;
+	return ( x < y ? -1 : ( x > y ? 1 : 0 ) );
+}
+
+
+// Closes benchmark document and counts its size
+void rtfbench_close()
+{
+	RTFBENCH_CALL( rtf_close() );
+	FILE* file = fopen( rtfBenchFile, "rb" );
+	if ( file != NULL )
+	{
+		rtfBenchSize += rtf_file_size(file);
+		fclose(file);
+	}
+}
+
+
+// Writes paragraph-heavy document
+int rtfbench_paragraphs(int scale)
+{
+	RTFBENCH_CALL( rtf_open( rtfBenchFile, NULL, NULL ) );
+	for ( int i=0; i<200000*scale; i++ )
+		RTFBENCH_CALL( rtf_start_paragraph( rtfBenchText, true ) );
+	rtfbench_close();
+	return 1;
+}
+
+
+// Writes document with formatting changed on every paragraph
+int rtfbench_formatchurn(int scale)
+{
+	RTFBENCH_CALL( rtf_open( rtfBenchFile, NULL, NULL ) );
+	RTF_PARAGRAPH_FORMAT* pf = rtf_get_paragraphformat();
+	for ( int i=0; i<100000*scale; i++ )
+	{
+		if ( i % 1000 == 999 )
+		{
+			RTF_SECTION_FORMAT* sf = rtf_get_sectionformat();
+			sf->cols = ( i % 2000 == 999 );
+			sf->colsNumber = 2;
+			RTFBENCH_CALL( rtf_start_section() );
+		}
+		pf->paragraphAligment = i % 4;
+		pf->firstLineIndent = ( i % 3 ) * 360;
+		pf->spaceBefore = ( i % 5 ) * 60;
+		pf->paragraphBorders = ( i % 11 == 0 );
+		pf->paragraphShading = ( i % 13 == 0 );
+		pf->CHARACTER.boldCharacter = ( i % 2 == 0 );
+		pf->CHARACTER.italicCharacter = ( i % 3 == 0 );
+		pf->CHARACTER.underlineCharacter = ( i % 7 == 0 ? 1 : 0 );
+		pf->CHARACTER.foregroundColor = i % 15;
+		pf->CHARACTER.fontNumber = i % 7;
+		pf->CHARACTER.fontSize = 16 + ( i % 8 ) * 2;
+		RTFBENCH_CALL( rtf_start_paragraph( rtfBenchText, true ) );
+	}
+	pf->paragraphBorders = false;
+	pf->paragraphShading = false;
+	rtfbench_close();
+	return 1;
+}
+
+
+// Writes table rows
+void rtfbench_table(int rows, int cells)
+{
+	char text[64];
+	RTF_PARAGRAPH_FORMAT* pf = rtf_get_paragraphformat();
+	RTF_TABLECELL_FORMAT* cf = rtf_get_tablecellformat();
+	for ( int i=0; i<rows; i++ )
+	{
+		RTFBENCH_CALL( rtf_start_tablerow() );
+		for ( int j=0; j<cells; j++ )
+		{
+			cf->borderBottom.border = ( i % 2 == 0 );
+			RTFBENCH_CALL( rtf_start_tablecell( (j+1) * 9000 / cells ) );
+			pf->tableText = true;
+			sprintf( text, "%d.%d", i, j );
+			RTFBENCH_CALL( rtf_start_paragraph( text, false ) );
+			RTFBENCH_CALL( rtf_end_tablecell() );
+		}
+		RTFBENCH_CALL( rtf_end_tablerow() );
+	}
+	pf->tableText = false;
+	cf->borderBottom.border = false;
+}
+
+
+// Writes document with wide table
+int rtfbench_widetable(int scale)
+{
+	RTFBENCH_CALL( rtf_open( rtfBenchFile, NULL, NULL ) );
+	rtfbench_table( 2000*scale, 60 );
+	rtfbench_close();
+	return 1;
+}
+
+
+// Writes document with long table
+int rtfbench_longtable(int scale)
+{
+	RTFBENCH_CALL( rtf_open( rtfBenchFile, NULL, NULL ) );
+	rtfbench_table( 100000*scale, 4 );
+	rtfbench_close();
+	return 1;
+}
+
+
+// Writes image-heavy document
+int rtfbench_images(int scale)
+{
+	RTFBENCH_CALL( rtf_open( rtfBenchFile, NULL, NULL ) );
+	int error = RTF_SUCCESS;
+	for ( int i=0; i<200*scale && error == RTF_SUCCESS; i++ )
+	{
+		RTFBENCH_CALL( rtf_start_paragraph( "Image", true ) );
+		RTFBENCH_CALL( error = rtf_load_image( rtfBenchImage, 100, 100 ) );
+	}
+	rtfbench_close();
+	return ( error == RTF_SUCCESS ? 1 : 0 );
+}
+
+
+// Writes many small documents
+int rtfbench_smalldocs(int scale)
+{
+	int count = 20000*scale;
+	for ( int i=0; i<count; i++ )
+	{
+		RTFBENCH_CALL( rtf_open( rtfBenchFile, NULL, NULL ) );
+		for ( int j=0; j<10; j++ )
+			RTFBENCH_CALL( rtf_start_paragraph( rtfBenchText, true ) );
+		rtfbench_table( 3, 3 );
+		rtfbench_close();
+	}
+	return count;
+}
+
+
+// Benchmark workloads
+RTF_BENCH_WORKLOAD rtfBenchWorkloads[] =
+{
+	{ "paragraphs", rtfbench_paragraphs },
+	{ "formatchurn", rtfbench_formatchurn },
+	{ "widetable", rtfbench_widetable },
+	{ "longtable", rtfbench_longtable },
+	{ "images", rtfbench_images },
+	{ "smalldocs", rtfbench_smalldocs },
+};
+
+
+// Runs benchmark workload
+void rtfbench_run(RTF_BENCH_WORKLOAD* workload, int scale, RTF_BENCH_RESULT* result)
+{
+	memset( result, 0, sizeof(RTF_BENCH_RESULT) );
+	rtfBenchSize = 0;
+	rtfBenchSampleCount = 0;
+	rtfBenchCallCount = 0;
+	rtfBenchAllocations = 0;
+	rtfBenchAllocated = 0;
+	rtfBenchHeapAllocations = 0;
+	rtf_set_memorybudget( rtfBenchBudget );
+
+	// Run workload
+	LARGE_INTEGER start, end, frequency;
+	rtfBenchCounting = true;
+	QueryPerformanceCounter(&start);
+	result->documentCount = workload->workloadWriter(scale);
+	QueryPerformanceCounter(&end);
+	rtfBenchCounting = false;
+	QueryPerformanceFrequency(&frequency);
+
+	result->skipped = ( result->documentCount == 0 );
+	result->documentSize = rtfBenchSize;
+	result->totalSeconds = (double)(end.QuadPart - start.QuadPart) / (double)frequency.QuadPart;
+	result->callCount = rtfBenchCallCount;
+	result->allocationCount = rtfBenchAllocations;
+	result->allocationSize = rtfBenchAllocated;
+	result->heapAllocationCount = rtfBenchHeapAllocations;
+	rtf_get_memoryusage( &result->writerMemory );
+
+	// Call latency percentiles
+	static const double percentiles[5] = { 0.5, 0.9, 0.99, 0.999, 1.0 };
+	qsort( rtfBenchSamples, rtfBenchSampleCount, sizeof(LONGLONG), rtfbench_compare );
+	for ( int i=0; i<5 && rtfBenchSampleCount > 0; i++ )
+	{
+		int sample = (int)( percentiles[i] * (rtfBenchSampleCount - 1) + 0.5 );
+		result->callLatency[i] = rtfBenchSamples[sample] * 1e6 / (double)frequency.QuadPart;
+	}
+
+	// Process peak working set
+	PROCESS_MEMORY_COUNTERS memory;
+	memset( &memory, 0, sizeof(memory) );
+	memory.cb = sizeof(memory);
+	if ( GetProcessMemoryInfo( GetCurrentProcess(), &memory, sizeof(memory) ) )
+		result->peakMemory = memory.PeakWorkingSetSize;
+}
+
+
+// Writes benchmark result as JSON object
+void rtfbench_report(FILE* file, RTF_BENCH_WORKLOAD* workload, RTF_BENCH_RESULT* result, bool last)
+{
+	fprintf( file, "    {\"workload\": \"%s\", ", workload->workloadName );
+	if ( result->skipped )
+	{
+		fprintf( file, "\"skipped\": true}%s\n", last ? "" : "," );
+		return;
+	}
+	int documents = result->documentCount;
+	fprintf( file, "\"documents\": %d, \"bytes\": %.0f, \"seconds\": %.6f, ", documents, (double)(LONGLONG)result->documentSize, result->totalSeconds );
+	fprintf( file, "\"mb_per_s\": %.3f, \"documents_per_s\": %.3f, ", result->documentSize / result->totalSeconds / 1048576.0, documents / result->totalSeconds );
+	fprintf( file, "\"calls\": %.0f, \"latency_us\": {\"p50\": %.3f, \"p90\": %.3f, \"p99\": %.3f, \"p999\": %.3f, \"max\": %.3f}, ",
+		(double)(LONGLONG)result->callCount, result->callLatency[0], result->callLatency[1], result->callLatency[2], result->callLatency[3], result->callLatency[4] );
+	fprintf( file, "\"allocations_per_document\": %.1f, \"allocated_bytes_per_document\": %.0f, ",
+		(double)(LONGLONG)result->allocationCount / documents, (double)(LONGLONG)result->allocationSize / documents );
+#ifdef _DEBUG
+	fprintf( file, "\"heap_allocations_per_document\": %.1f, ", (double)(LONGLONG)result->heapAllocationCount / documents );
+#endif
+	fprintf( file, "\"writer_peak_bytes\": %.0f, \"writer_peak\": {", (double)result->writerMemory.memoryPeak );
+	for ( int i=0; i<RTF_MEMORY_SUBSYSTEMS; i++ )
+		fprintf( file, "%s\"%s\": %.0f", i > 0 ? ", " : "", rtf_get_memoryname(i), (double)result->writerMemory.subsystemPeak[i] );
+	fprintf( file, "}, \"spills\": %.0f, ", (double)(LONGLONG)result->writerMemory.spillCount );
+	fprintf( file, "\"peak_rss_bytes\": %.0f}%s\n", (double)result->peakMemory, last ? "" : "," );
+}
+
+
+// Measures rtflib writer throughput, call latency and memory use on synthetic workloads
+//
+// Usage: rtfbench [-s scale] [-w workload] [-i image.jpg] [-o result.json] [-m budget] [-z]
+//
+// Results are written as JSON (to standard output by default). Peak working set is cumulative
+// for the process, run single workload (-w) to measure its own peak. Writer memory peaks are
+// reported per workload, with -m the writer runs within given memory budget (bytes).
+//
+// With -z each workload is run twice and the second run must not allocate memory through operator
+// new (writer memory is reused in steady state), otherwise exit code is 1. C runtime heap use (malloc,
+// FILE buffers of fopen and tmpfile per document) is not part of this check, debug builds report it
+// as heap_allocations_per_document.
+int main(int argc, char* argv[])
+{
+	int scale = 1;
+	char* only = NULL;
+	char* output = NULL;
+	bool steady = false;
+	for ( int i=1; i<argc; i++ )
+	{
+		if ( strcmp( argv[i], "-z" ) == 0 )
+			steady = true;
+		else if ( i+1 >= argc )
+			break;
+		else if ( strcmp( argv[i], "-s" ) == 0 )
+			scale = atoi(argv[++i]);
+		else if ( strcmp( argv[i], "-w" ) == 0 )
+			only = argv[++i];
+		else if ( strcmp( argv[i], "-i" ) == 0 )
+			rtfBenchImage = argv[++i];
+		else if ( strcmp( argv[i], "-o" ) == 0 )
+			output = argv[++i];
+		else if ( strcmp( argv[i], "-m" ) == 0 )
+			rtfBenchBudget = (size_t)_atoi64(argv[++i]);
+	}
+	if ( scale < 1 )
+		scale = 1;
+#ifdef _DEBUG
+	_CrtSetAllocHook( rtfbench_allochook );
+#endif
+
+	FILE* file = stdout;
+	if ( output != NULL && ( file = fopen( output, "w" ) ) == NULL )
+	{
+		printf( "rtfbench: could not create %s\n", output );
+		return 1;
+	}
+
+	// Run workloads
+	int status = 0;
+	rtfBenchSamples = new LONGLONG[RTFBENCH_MAXSAMPLES];
+	int count = sizeof(rtfBenchWorkloads) / sizeof(RTF_BENCH_WORKLOAD);
+	fprintf( file, "{\n  \"benchmark\": \"rtfbench\",\n  \"scale\": %d,\n  \"results\": [\n", scale );
+	int last = count - 1;
+	while ( only != NULL && last >= 0 && strcmp( rtfBenchWorkloads[last].workloadName, only ) != 0 )
+		last--;
+	for ( int j=0; j<=last; j++ )
+	{
+		if ( only != NULL && strcmp( rtfBenchWorkloads[j].workloadName, only ) != 0 )
+			continue;
+		RTF_BENCH_RESULT result;
+		if ( steady )
+			rtfbench_run( &rtfBenchWorkloads[j], scale, &result );
+		rtfbench_run( &rtfBenchWorkloads[j], scale, &result );
+		rtfbench_report( file, &rtfBenchWorkloads[j], &result, j == last );
+		fflush(file);
+
+		// Steady state run must not allocate
+		if ( steady && !result.skipped && result.allocationCount > 0 )
+		{
+			fprintf( stderr, "rtfbench: %s made %.0f writer allocations (operator new) after warm-up\n", rtfBenchWorkloads[j].workloadName, (double)(LONGLONG)result.allocationCount );
+			status = 1;
+		}
+	}
+	fprintf( file, "  ]\n}\n" );
+	delete []rtfBenchSamples;
+
+	if ( file != stdout )
+		fclose(file);
+	remove( rtfBenchFile );
+	return status;
+}
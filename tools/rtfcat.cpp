@@ -0,0 +1,79 @@
+#include "../errors.h"
+#include "../globals.h"
+#include "../rtflib.h"
+
+
+
+// Merges RTF documents into one RTF document
+//
+// Usage: rtfcat [-t threads] out.rtf file.rtf ... | @list.txt
+//
+// List file contains one RTF file name per line.
+int main(int argc, char* argv[])
+{
+	int threads = 0;
+	int arg = 1;
+	if ( argc > 2 && strcmp( argv[1], "-t" ) == 0 )
+	{
+		threads = atoi( argv[2] );
+		arg += 2;
+	}
+	if ( argc - arg < 2 )
+	{
+		printf( "usage: rtfcat [-t threads] out.rtf file.rtf ... | @list.txt\n" );
+		return 1;
+	}
+	char* outname = argv[arg++];
+
+	// Collect RTF file names
+	int count = 0, capacity = argc;
+	char** filenames = new char*[capacity];
+	for ( ; arg<argc; arg++ )
+	{
+		if ( argv[arg][0] != '@' )
+		{
+			filenames[count++] = argv[arg];
+			continue;
+		}
+
+		// Read file names from list file
+		FILE* list = fopen( argv[arg] + 1, "r" );
+		if ( list == NULL )
+		{
+			printf( "rtfcat: could not open %s\n", argv[arg] + 1 );
+			return 1;
+		}
+		char line[1024];
+		while ( fgets( line, sizeof(line), list ) != NULL )
+		{
+			size_t length = strlen(line);
+			while ( length > 0 && ( line[length-1] == '\r' || line[length-1] == '\n' ) )
+				line[--length] = '\0';
+			if ( length == 0 )
+				continue;
+
+			if ( count == capacity )
+			{
+				char** names = new char*[2*capacity];
+				memcpy( names, filenames, count*sizeof(char*) );
+				delete []filenames;
+				filenames = names;
+				capacity *= 2;
+			}
+			filenames[count] = new char[length+1];
+			strcpy( filenames[count++], line );
+		}
+		fclose(list);
+	}
+
+	// Merge RTF documents
+	int error = rtf_merge( filenames, count, outname, threads );
+	if ( error != RTF_SUCCESS )
+	{
+		printf( "rtfcat: could not merge %d files (error 0x%04X)\n", count, error );
+		return 1;
+	}
+	printf( "%s: merged %d files\n", outname, count );
+
+	return 0;
+}
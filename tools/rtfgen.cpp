@@ -0,0 +1,47 @@
+#include "rtflayouts.h"
+
+
+
+// Generates specialized C++ headers for fixed document layouts
+//
+// Usage: rtfgen [output directory]
+//
+// Every layout from rtflayouts.cpp is recorded as RTF template and exported
+// as <layout>.h, holding constant byte arrays and <layout>_render() function.
+int main(int argc, char* argv[])
+{
+	char directory[1024] = ".";
+	if ( argc > 1 )
+		strcpy( directory, argv[1] );
+	int result = 0;
+
+	for ( int i=0; i<rtflayout_count(); i++ )
+	{
+		RTF_LAYOUT* layout = rtflayout_get(i);
+
+		// Copy font and color table (rtf_template_open modifies them)
+		char fonts[1024], colors[1024];
+		strcpy( fonts, layout->fontTable );
+		strcpy( colors, layout->colorTable );
+
+		// Record layout template
+		rtf_template_open( fonts, colors );
+		layout->layoutWriter( NULL );
+		RTF_TEMPLATE* tmpl = rtf_template_close();
+
+		// Export specialized header
+		char filename[1024];
+		sprintf( filename, "%s/%s.h", directory, layout->layoutName );
+		if ( rtf_template_export( tmpl, layout->layoutName, filename ) != RTF_SUCCESS )
+		{
+			printf( "rtfgen: could not write %s\n", filename );
+			result = 1;
+		}
+		else
+			printf( "rtfgen: %s (%d bytes, %d fields)\n", filename, (int)tmpl->dataSize, tmpl->fieldCount );
+
+		rtf_template_free(tmpl);
+	}
+
+	return result;
+}
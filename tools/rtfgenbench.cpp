@@ -0,0 +1,96 @@
+#include "rtflayouts.h"
+#include "letter.h"
+
+
+
+// Benchmark field values
+char* rtfBenchValues[] =
+{
+	"Zagreb",
+	"March 3, 2008",
+	"John Smith",
+	"Ilica 1\n10000 Zagreb\nCroatia",
+	"We are pleased to inform you that your account has been upgraded.\nPlease find the details below.",
+	"ETC Company LTD.",
+};
+
+
+
+// Gets elapsed time in seconds
+double rtfbench_seconds(LARGE_INTEGER* start, LARGE_INTEGER* end)
+{
+	LARGE_INTEGER frequency;
+	QueryPerformanceFrequency(&frequency);
+	return (double)(end->QuadPart - start->QuadPart) / (double)frequency.QuadPart;
+}
+
+
+// Prints benchmark result
+void rtfbench_report(char* path, int count, size_t size, double seconds)
+{
+	printf( "%-10s %10d documents %12.0f documents/s %10.1f MB/s\n", path, count, count/seconds, count*(double)size/seconds/1048576.0 );
+}
+
+
+// Compares generated "letter" layout against generic rtflib paths
+//
+// Usage: rtfgenbench [documents]
+//
+// letter.h is generated by rtfgen (tools.dsw builds rtfgen first, its post-build step writes letter.h).
+int main(int argc, char* argv[])
+{
+	int count = ( argc > 1 ? atoi(argv[1]) : 100000 );
+	RTF_LAYOUT* layout = rtflayout_get(0);
+	LARGE_INTEGER start, end;
+	char fonts[1024], colors[1024];
+
+	// Generic path: every document is written through rtflib API (into memory)
+	size_t genericSize = 0;
+	QueryPerformanceCounter(&start);
+	for ( int i=0; i<count; i++ )
+	{
+		strcpy( fonts, layout->fontTable );
+		strcpy( colors, layout->colorTable );
+		rtf_template_open( fonts, colors );
+		layout->layoutWriter( rtfBenchValues );
+		RTF_TEMPLATE* doc = rtf_template_close();
+		genericSize = doc->dataSize;
+		rtf_template_free(doc);
+	}
+	QueryPerformanceCounter(&end);
+	rtfbench_report( "generic", count, genericSize, rtfbench_seconds( &start, &end ) );
+
+	// Runtime template path
+	strcpy( fonts, layout->fontTable );
+	strcpy( colors, layout->colorTable );
+	rtf_template_open( fonts, colors );
+	layout->layoutWriter( NULL );
+	RTF_TEMPLATE* tmpl = rtf_template_close();
+	size_t templateSize = 0;
+	char* templateData = NULL;
+	QueryPerformanceCounter(&start);
+	for ( int j=0; j<count; j++ )
+		templateData = rtf_template_render_buffer( tmpl, rtfBenchValues, &templateSize );
+	QueryPerformanceCounter(&end);
+	rtfbench_report( "template", count, templateSize, rtfbench_seconds( &start, &end ) );
+
+	// Generated path
+	size_t generatedSize = 0;
+	char* generatedData = NULL;
+	QueryPerformanceCounter(&start);
+	for ( int k=0; k<count; k++ )
+		generatedData = letter_render( rtfBenchValues, &generatedSize );
+	QueryPerformanceCounter(&end);
+	rtfbench_report( "generated", count, generatedSize, rtfbench_seconds( &start, &end ) );
+
+	// All paths must produce same document
+	int result = 0;
+	if ( templateSize != genericSize || generatedSize != templateSize || memcmp( templateData, generatedData, templateSize ) != 0 )
+	{
+		printf( "rtfgenbench: generated document differs from generic one\n" );
+		result = 1;
+	}
+
+	rtf_template_free(tmpl);
+	return result;
+}
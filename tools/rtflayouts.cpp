@@ -0,0 +1,146 @@
+#include "rtflayouts.h"
+
+
+
+// Fixed document layouts
+RTF_LAYOUT rtfLayouts[] =
+{
+	{ "letter", "Times New Roman;Arial;", "0;0;0;255;0;0;192;192;192", rtflayout_letter },
+	{ "statement", "Arial;Courier New;", "0;0;0;0;0;128;230;230;230", rtflayout_statement },
+};
+
+
+
+// Writes layout field
+void rtflayout_field(char* name, int field_type, char** values, int index)
+{
+	// Insert template field
+	if ( values == NULL )
+	{
+		rtf_template_field( name, field_type );
+		return;
+	}
+
+	// Write escaped field value
+	if ( values[index] != NULL )
+	{
+		size_t size = strlen(values[index]);
+		char* text = new char[6*size+1];
+		size = rtf_escape_copy( text, values[index], size, field_type );
+		rtf_write_data( text, size );
+		delete []text;
+	}
+}
+
+
+// Writes letter layout
+void rtflayout_letter(char** values)
+{
+	// Format letter heading
+	RTF_PARAGRAPH_FORMAT* pf = rtf_get_paragraphformat();
+	pf->paragraphAligment = RTF_PARAGRAPHALIGN_RIGHT;
+	pf->CHARACTER.fontNumber = 1;
+	pf->CHARACTER.fontSize = 20;
+	rtf_start_paragraph( "", false );
+	rtflayout_field( "city", RTF_FIELDTYPE_TEXT, values, 0 );
+	rtf_start_paragraph( ", ", false );
+	rtflayout_field( "date", RTF_FIELDTYPE_TEXT, values, 1 );
+
+	// Format address
+	pf->paragraphAligment = RTF_PARAGRAPHALIGN_LEFT;
+	pf->spaceBefore = 720;
+	pf->CHARACTER.boldCharacter = true;
+	rtf_start_paragraph( "", true );
+	rtflayout_field( "name", RTF_FIELDTYPE_TEXT, values, 2 );
+	pf->spaceBefore = 0;
+	pf->CHARACTER.boldCharacter = false;
+	rtf_start_paragraph( "", true );
+	rtflayout_field( "address", RTF_FIELDTYPE_PARAGRAPHS, values, 3 );
+
+	// Format letter body
+	pf->spaceBefore = 360;
+	pf->paragraphAligment = RTF_PARAGRAPHALIGN_JUSTIFY;
+	pf->CHARACTER.fontNumber = 0;
+	pf->CHARACTER.fontSize = 24;
+	rtf_start_paragraph( "Dear ", true );
+	rtflayout_field( "name", RTF_FIELDTYPE_TEXT, values, 2 );
+	rtf_start_paragraph( ",", false );
+	pf->spaceBefore = 120;
+	rtf_start_paragraph( "", true );
+	rtflayout_field( "body", RTF_FIELDTYPE_PARAGRAPHS, values, 4 );
+
+	// Format signature
+	pf->spaceBefore = 720;
+	pf->paragraphAligment = RTF_PARAGRAPHALIGN_LEFT;
+	pf->CHARACTER.italicCharacter = true;
+	rtf_start_paragraph( "", true );
+	rtflayout_field( "signature", RTF_FIELDTYPE_TEXT, values, 5 );
+	pf->CHARACTER.italicCharacter = false;
+}
+
+
+// Writes statement layout
+void rtflayout_statement(char** values)
+{
+	// Format statement title
+	RTF_PARAGRAPH_FORMAT* pf = rtf_get_paragraphformat();
+	pf->paragraphAligment = RTF_PARAGRAPHALIGN_CENTER;
+	pf->spaceAfter = 240;
+	pf->CHARACTER.fontSize = 32;
+	pf->CHARACTER.boldCharacter = true;
+	pf->CHARACTER.foregroundColor = 1;
+	rtf_start_paragraph( "Account statement ", false );
+	rtflayout_field( "account", RTF_FIELDTYPE_TEXT, values, 0 );
+
+	// Format statement table
+	pf->paragraphAligment = RTF_PARAGRAPHALIGN_LEFT;
+	pf->spaceAfter = 0;
+	pf->CHARACTER.fontSize = 20;
+	pf->CHARACTER.boldCharacter = false;
+	pf->CHARACTER.foregroundColor = 0;
+	RTF_TABLECELL_FORMAT* cf = rtf_get_tablecellformat();
+	cf->cellShading = true;
+	cf->SHADING.shadingBkColor = 2;
+	rtf_start_tablerow();
+	rtf_start_tablecell(4000);
+	rtf_start_tablecell(8000);
+	pf->tableText = true;
+	rtf_start_paragraph( "Customer", false );
+	rtf_end_tablecell();
+	rtf_start_paragraph( "", false );
+	rtflayout_field( "customer", RTF_FIELDTYPE_TEXT, values, 1 );
+	rtf_end_tablecell();
+	rtf_end_tablerow();
+	rtf_start_tablerow();
+	cf->cellShading = false;
+	rtf_start_tablecell(4000);
+	rtf_start_tablecell(8000);
+	rtf_start_paragraph( "Balance", false );
+	rtf_end_tablecell();
+	pf->CHARACTER.fontNumber = 1;
+	rtf_start_paragraph( "", false );
+	rtflayout_field( "balance", RTF_FIELDTYPE_RAW, values, 2 );
+	rtf_end_tablecell();
+	rtf_end_tablerow();
+	pf->tableText = false;
+	pf->CHARACTER.fontNumber = 0;
+
+	// Format statement lines
+	pf->spaceBefore = 240;
+	rtf_start_paragraph( "", true );
+	rtflayout_field( "lines", RTF_FIELDTYPE_PARAGRAPHS, values, 3 );
+}
+
+
+// Gets number of layouts
+int rtflayout_count()
+{
+	return sizeof(rtfLayouts) / sizeof(RTF_LAYOUT);
+}
+
+
+// Gets layout
+RTF_LAYOUT* rtflayout_get(int index)
+{
+	return &rtfLayouts[index];
+}
@@ -0,0 +1,23 @@
+#include "../errors.h"
+#include "../globals.h"
+#include "../rtflib.h"
+
+
+
+// RTF layout structure
+struct RTF_LAYOUT
+{
+	char* layoutName;								// Layout name (used for generated header and function names)
+	char* fontTable;								// Layout font table
+	char* colorTable;								// Layout color table
+	void (*layoutWriter)(char** values);			// Writes layout (inserts template fields when values are NULL)
+};
+
+
+
+// RTF layouts interface
+void rtflayout_field(char* name, int field_type, char** values, int index);	// Writes layout field
+void rtflayout_letter(char** values);									// Writes letter layout
+void rtflayout_statement(char** values);								// Writes statement layout
+int rtflayout_count();													// Gets number of layouts
+RTF_LAYOUT* rtflayout_get(int index);									// Gets layout
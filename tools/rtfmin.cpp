@@ -0,0 +1,50 @@
+#include "../errors.h"
+#include "../globals.h"
+#include "../rtflib.h"
+
+
+
+// Gets file size
+long rtfmin_size(char* filename)
+{
+	struct _stat st;
+	if ( _stat( filename, &st ) != 0 )
+		return 0;
+	return st.st_size;
+}
+
+
+// Minifies RTF documents
+//
+// Usage: rtfmin [-hex] file.rtf out.rtf
+//
+// Picture data is written as \bin unless -hex is given.
+int main(int argc, char* argv[])
+{
+	bool binaryPictures = true;
+	int arg = 1;
+	if ( argc > 1 && strcmp( argv[1], "-hex" ) == 0 )
+	{
+		binaryPictures = false;
+		arg++;
+	}
+	if ( argc - arg < 2 )
+	{
+		printf( "usage: rtfmin [-hex] file.rtf out.rtf\n" );
+		return 1;
+	}
+
+	// Minify RTF document
+	int error = rtf_minify( argv[arg], argv[arg+1], binaryPictures );
+	if ( error != RTF_SUCCESS )
+	{
+		printf( "rtfmin: could not minify %s (error 0x%04X)\n", argv[arg], error );
+		return 1;
+	}
+
+	long before = rtfmin_size( argv[arg] );
+	long after = rtfmin_size( argv[arg+1] );
+	printf( "%s: %ld -> %ld bytes (%.1f%%)\n", argv[arg], before, after, ( before > 0 ? 100.0*after/before : 100.0 ) );
+
+	return 0;
+}
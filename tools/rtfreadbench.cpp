@@ -0,0 +1,135 @@
+#include "../errors.h"
+#include "../globals.h"
+#include "../rtflib.h"
+
+
+
+// Benchmark event counters
+struct RTF_READBENCH_COUNTERS
+{
+	size_t events[7];								// Number of events per event type
+	size_t textSize;								// Text size
+};
+
+
+
+// Counts RTF reader events
+bool rtfreadbench_event(RTF_READER_EVENT* event, void* param)
+{
+	RTF_READBENCH_COUNTERS* counters = (RTF_READBENCH_COUNTERS*)param;
+	counters->events[event->eventType]++;
+	if ( event->eventType == RTF_READEREVENT_TEXT )
+		counters->textSize += event->eventSize;
+	return true;
+}
+
+
+// Writes large benchmark document
+void rtfreadbench_write(char* filename, int paragraphs)
+{
+	rtf_open( filename, NULL, NULL );
+	RTF_PARAGRAPH_FORMAT* pf = rtf_get_paragraphformat();
+	for ( int i=0; i<paragraphs; i++ )
+	{
+		pf->CHARACTER.boldCharacter = ( i % 7 == 0 );
+		pf->CHARACTER.foregroundColor = i % 4;
+		rtf_start_paragraph( "Lorem ipsum dolor sit amet, consectetur adipiscing elit, sed do eiusmod tempor incididunt ut labore et dolore magna aliqua.", true );
+		if ( i % 100 == 0 )
+		{
+			rtf_start_tablerow();
+			rtf_start_tablecell(3000);
+			rtf_start_tablecell(6000);
+			pf->tableText = true;
+			rtf_start_paragraph( "Ledger entry", false );
+			rtf_end_tablecell();
+			rtf_start_paragraph( "1,234.56", false );
+			rtf_end_tablecell();
+			rtf_end_tablerow();
+			pf->tableText = false;
+		}
+	}
+	rtf_close();
+}
+
+
+// Gets elapsed time in seconds
+double rtfreadbench_seconds(LARGE_INTEGER* start, LARGE_INTEGER* end)
+{
+	LARGE_INTEGER frequency;
+	QueryPerformanceFrequency(&frequency);
+	return (double)(end->QuadPart - start->QuadPart) / (double)frequency.QuadPart;
+}
+
+
+// Measures RTF reader throughput
+//
+// Usage: rtfreadbench [file.rtf] [iterations]
+//
+// Without file argument, rtfreadbench.rtf (about 300 MB) is written first.
+int main(int argc, char* argv[])
+{
+	char filename[1024] = "rtfreadbench.rtf";
+	int iterations = ( argc > 2 ? atoi(argv[2]) : 5 );
+	if ( argc > 1 )
+		strcpy( filename, argv[1] );
+	else
+		rtfreadbench_write( filename, 1000000 );
+
+	// Load whole file in memory
+	FILE* file = fopen( filename, "rb" );
+	if ( file == NULL )
+	{
+		printf( "rtfreadbench: could not open %s\n", filename );
+		return 1;
+	}
+	fseek( file, 0, SEEK_END );
+	size_t size = ftell(file);
+	fseek( file, 0, SEEK_SET );
+	char* data = new char[size];
+	size = fread( data, 1, size, file );
+	fclose(file);
+
+	// Tokenize in-memory document
+	RTF_READBENCH_COUNTERS counters;
+	LARGE_INTEGER start, end;
+	double best = 0;
+	for ( int i=0; i<iterations; i++ )
+	{
+		memset( &counters, 0, sizeof(counters) );
+		RTF_READER reader;
+		rtf_reader_init( &reader, rtfreadbench_event, &counters );
+		QueryPerformanceCounter(&start);
+		rtf_reader_parse( &reader, data, size, true );
+		QueryPerformanceCounter(&end);
+		double seconds = rtfreadbench_seconds( &start, &end );
+		if ( best == 0 || seconds < best )
+			best = seconds;
+	}
+	printf( "memory    %12u bytes %8.3f GB/s\n", (unsigned)size, size/best/1e9 );
+	printf( "          %12u words %12u symbols %12u groups %12u text runs (%u bytes)\n",
+		(unsigned)counters.events[RTF_READEREVENT_CONTROLWORD], (unsigned)counters.events[RTF_READEREVENT_CONTROLSYMBOL],
+		(unsigned)counters.events[RTF_READEREVENT_GROUPOPEN], (unsigned)counters.events[RTF_READEREVENT_TEXT], (unsigned)counters.textSize );
+	delete []data;
+
+	// Tokenize streamed document
+	memset( &counters, 0, sizeof(counters) );
+	QueryPerformanceCounter(&start);
+	rtf_read_file( filename, rtfreadbench_event, &counters );
+	QueryPerformanceCounter(&end);
+	printf( "file      %12u bytes %8.3f GB/s\n", (unsigned)size, size/rtfreadbench_seconds( &start, &end )/1e9 );
+
+	// Tokenize mapped document on all processors
+	memset( &counters, 0, sizeof(counters) );
+	QueryPerformanceCounter(&start);
+	rtf_read_file_parallel( filename, rtfreadbench_event, &counters, 0 );
+	QueryPerformanceCounter(&end);
+	printf( "parallel  %12u bytes %8.3f GB/s\n", (unsigned)size, size/rtfreadbench_seconds( &start, &end )/1e9 );
+
+	// Extract plain text
+	QueryPerformanceCounter(&start);
+	rtf_extract_text( filename, "rtfreadbench.txt" );
+	QueryPerformanceCounter(&end);
+	printf( "extract   %12u bytes %8.3f GB/s\n", (unsigned)size, size/rtfreadbench_seconds( &start, &end )/1e9 );
+
+	return 0;
+}
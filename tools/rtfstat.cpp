@@ -0,0 +1,31 @@
+#include "../errors.h"
+#include "../globals.h"
+#include "../rtflib.h"
+
+
+
+// Reports where the bytes of RTF files go
+//
+// Usage: rtfstat file.rtf [report.txt]
+//
+// Output bytes are attributed to control word families (\fs, \cf, \b0, \clbrdr*), destination
+// data (\pict data, \fonttbl data), text and group braces, and ranked by size. Control words that
+// set a formatting value that is already in effect are counted as redundant.
+int main(int argc, char* argv[])
+{
+	if ( argc < 2 )
+	{
+		printf( "usage: rtfstat file.rtf [report.txt]\n" );
+		return 1;
+	}
+
+	// Analyze RTF document (report is written to standard output without report file argument)
+	int error = rtf_analyze_file( argv[1], ( argc > 2 ? argv[2] : NULL ) );
+	if ( error != RTF_SUCCESS )
+	{
+		printf( "rtfstat: could not analyze %s (error 0x%04X)\n", argv[1], error );
+		return 1;
+	}
+
+	return 0;
+}